@@ -88,61 +88,53 @@ int main(int argc, char **argv)
         const char *localename = prod.get_lcnumeric();
         QLocale::setDefault(QLocale(localename));
 
-        int currentFrame = 0;
-        int rangeStart = 0;
-        int rangeEnd = 0;
-        QString frame;
-        while (!chunks.isEmpty()) {
-            if (rangeEnd == 0) {
-                // We are not processing a range
-                frame = chunks.first();
+        // Expand the chunk list, ranges of consecutive chunks are written "first-last"
+        QList<int> frames;
+        for (const QString &chunk : std::as_const(chunks)) {
+            if (!chunk.contains(QLatin1Char('-'))) {
+                frames << chunk.toInt();
+                continue;
             }
-            if (rangeEnd > 0) {
-                // We are processing a range
-                currentFrame += chunkSize + 1;
-                frame = QString::number(currentFrame);
-                if (currentFrame >= rangeEnd) {
-                    // End of range
-                    rangeStart = 0;
-                    rangeEnd = 0;
-                    // Range is processed, remove from stack
-                    chunks.removeFirst();
-                }
-            } else if (frame.contains(QLatin1Char('-'))) {
-                rangeStart = frame.section(QLatin1Char('-'), 0, 0).toInt();
-                rangeEnd = frame.section(QLatin1Char('-'), 1, 1).toInt();
-                currentFrame = rangeStart;
-                frame = QString::number(currentFrame);
-            } else {
-                // Frame will be processed, remove from stack
-                chunks.removeFirst();
+            const int rangeStart = chunk.section(QLatin1Char('-'), 0, 0).toInt();
+            const int rangeEnd = chunk.section(QLatin1Char('-'), 1, 1).toInt();
+            for (int currentFrame = rangeStart; currentFrame <= rangeEnd; currentFrame += chunkSize + 1) {
+                frames << currentFrame;
             }
-            fprintf(stderr, "START:%d \n", frame.toInt());
-            QString fileName = QStringLiteral("%1.%2").arg(frame, extension);
+        }
+        // Use the same cut for all chunks: the producer graph stays connected, decoders keep
+        // their state and consecutive chunks continue where the previous one stopped.
+        // The avformat consumer opens its muxer and encoder when it starts, so each chunk file
+        // is still encoded from scratch; only the consumer configuration is shared.
+        QScopedPointer<Mlt::Producer> playlst(prod.cut(0, chunkSize));
+        Mlt::Consumer cons(profile, "avformat");
+        for (const QString &param : std::as_const(consumerParams)) {
+            if (param.contains(QLatin1Char('='))) {
+                cons.set(param.section(QLatin1Char('='), 0, 0).toUtf8().constData(), param.section(QLatin1Char('='), 1).toUtf8().constData());
+            }
+        }
+        if (!cons.is_valid()) {
+            fprintf(stderr, " = =  = INVALID CONSUMER\n\n");
+            return 1;
+        }
+        cons.set("terminate_on_pause", 1);
+        cons.connect(*playlst);
+        for (int currentFrame : std::as_const(frames)) {
+            fprintf(stderr, "START:%d \n", currentFrame);
+            QString fileName = QStringLiteral("%1.%2").arg(currentFrame).arg(extension);
             if (baseFolder.exists(fileName)) {
                 // Don't overwrite an existing file
-                fprintf(stderr, "DONE:%d \n", frame.toInt());
+                fprintf(stderr, "DONE:%d \n", currentFrame);
                 continue;
             }
-            QScopedPointer<Mlt::Producer> playlst(prod.cut(frame.toInt(), frame.toInt() + chunkSize));
-            QScopedPointer<Mlt::Consumer> cons(
-                new Mlt::Consumer(profile, QStringLiteral("avformat:%1").arg(baseFolder.absoluteFilePath(fileName)).toUtf8().constData()));
-            for (const QString &param : std::as_const(consumerParams)) {
-                if (param.contains(QLatin1Char('='))) {
-                    cons->set(param.section(QLatin1Char('='), 0, 0).toUtf8().constData(), param.section(QLatin1Char('='), 1).toUtf8().constData());
-                }
-            }
-            if (!cons->is_valid()) {
-                fprintf(stderr, " = =  = INVALID CONSUMER\n\n");
-                return 1;
-            }
-            cons->set("terminate_on_pause", 1);
-            cons->connect(*playlst);
-            playlst.reset();
-            cons->run();
-            cons->stop();
-            cons->purge();
-            fprintf(stderr, "DONE:%d \n", frame.toInt());
+            playlst->set_in_and_out(currentFrame, currentFrame + chunkSize);
+            playlst->seek(0);
+            // The cut was paused at the end of the previous chunk
+            playlst->set_speed(1.);
+            cons.set("target", baseFolder.absoluteFilePath(fileName).toUtf8().constData());
+            cons.run();
+            cons.stop();
+            cons.purge();
+            fprintf(stderr, "DONE:%d \n", currentFrame);
         }
         // Mlt::Factory::close();
         fprintf(stderr, "+ + + RENDERING FINISHED + + + \n");
@@ -16,6 +16,7 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QLineF>
+#include <QMutexLocker>
 #include <QSize>
 #include <mlt++/Mlt.h>
 #include <utility>
@@ -99,15 +100,15 @@ bool KeyframeModel::addKeyframe(GenTime pos, KeyframeType::KeyframeEnum type, QV
     QWriteLocker locker(&m_lock);
     Fun local_undo = []() { return true; };
     Fun local_redo = []() { return true; };
-    if (m_keyframeList.count(pos) > 0) {
+    if (m_keyframeList.count(TickTime(pos)) > 0) {
         qDebug() << "already there";
-        if (std::pair<KeyframeType::KeyframeEnum, QVariant>({type, value}) == m_keyframeList.at(pos)) {
+        if (std::pair<KeyframeType::KeyframeEnum, QVariant>({type, value}) == m_keyframeList.at(TickTime(pos))) {
             qDebug() << "nothing to do";
             return true; // nothing to do
         }
         // In this case we simply change the type and value
-        KeyframeType::KeyframeEnum oldType = m_keyframeList[pos].first;
-        QVariant oldValue = m_keyframeList[pos].second;
+        KeyframeType::KeyframeEnum oldType = m_keyframeList[TickTime(pos)].first;
+        QVariant oldValue = m_keyframeList[TickTime(pos)].second;
         local_undo = updateKeyframe_lambda(pos, oldType, oldValue, notify);
         local_redo = updateKeyframe_lambda(pos, type, value, notify);
         if (local_redo()) {
@@ -141,7 +142,7 @@ bool KeyframeModel::addKeyframe(GenTime pos, KeyframeType::KeyframeEnum type, QV
     QWriteLocker locker(&m_lock);
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
-    bool update = (m_keyframeList.count(pos) > 0);
+    bool update = (m_keyframeList.count(TickTime(pos)) > 0);
     bool res = addKeyframe(pos, type, std::move(value), true, undo, redo);
     if (res) {
         PUSH_UNDO(undo, redo, update ? i18n("Change keyframe type") : i18n("Add keyframe"));
@@ -155,12 +156,12 @@ bool KeyframeModel::removeKeyframe(GenTime pos, Fun &undo, Fun &redo, bool notif
     qDebug() << "before" << getAnimProperty();
     QWriteLocker locker(&m_lock);
     if (!allowedToFail) {
-        Q_ASSERT(m_keyframeList.count(pos) > 0);
-    } else if (m_keyframeList.count(pos) == 0) {
+        Q_ASSERT(m_keyframeList.count(TickTime(pos)) > 0);
+    } else if (m_keyframeList.count(TickTime(pos)) == 0) {
         return true;
     }
-    KeyframeType::KeyframeEnum oldType = m_keyframeList[pos].first;
-    QVariant oldValue = m_keyframeList[pos].second;
+    KeyframeType::KeyframeEnum oldType = m_keyframeList[TickTime(pos)].first;
+    QVariant oldValue = m_keyframeList[TickTime(pos)].second;
     Fun select_undo = []() { return true; };
     Fun select_redo = []() { return true; };
     if (updateSelection) {
@@ -207,9 +208,9 @@ bool KeyframeModel::removeKeyframe(GenTime pos, Fun &undo, Fun &redo, bool notif
 bool KeyframeModel::duplicateKeyframe(GenTime srcPos, GenTime dstPos, Fun &undo, Fun &redo)
 {
     QWriteLocker locker(&m_lock);
-    Q_ASSERT(m_keyframeList.count(srcPos) > 0);
-    KeyframeType::KeyframeEnum oldType = m_keyframeList[srcPos].first;
-    QVariant oldValue = m_keyframeList[srcPos].second;
+    Q_ASSERT(m_keyframeList.count(TickTime(srcPos)) > 0);
+    KeyframeType::KeyframeEnum oldType = m_keyframeList[TickTime(srcPos)].first;
+    QVariant oldValue = m_keyframeList[TickTime(srcPos)].second;
     Fun local_redo = addKeyframe_lambda(dstPos, oldType, oldValue, true);
     Fun local_undo = deleteKeyframe_lambda(dstPos, true);
     if (local_redo()) {
@@ -231,7 +232,7 @@ bool KeyframeModel::removeKeyframe(GenTime pos)
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
 
-    if (m_keyframeList.count(pos) > 0 && m_keyframeList.find(pos) == m_keyframeList.begin()) {
+    if (m_keyframeList.count(TickTime(pos)) > 0 && m_keyframeList.find(TickTime(pos)) == m_keyframeList.begin()) {
         return false; // initial point must stay
     }
 
@@ -268,7 +269,7 @@ bool KeyframeModel::moveKeyframe(GenTime oldPos, GenTime pos, const QVariant &ne
             // We have several selected keyframes, move them all
             double offset = 0.;
             if (newVal.isValid() && newVal.typeId() == QMetaType::Double) {
-                int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(oldPos)));
+                int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(TickTime(oldPos))));
                 double oldVal = data(index(row), NormalizedValueRole).toDouble();
                 offset = newVal.toDouble() - oldVal;
             }
@@ -313,7 +314,7 @@ bool KeyframeModel::moveKeyframe(GenTime oldPos, GenTime pos, const QVariant &ne
                 } else {
                     if (!qFuzzyIsNull(offset)) {
                         // Calculate new value
-                        int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(p)));
+                        int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(TickTime(p))));
                         double newVal2 = qBound(0., data(index(row), NormalizedValueRole).toDouble() + offset, 1.);
                         res = res && moveOneKeyframe(p, p + delta, newVal2, undo, redo, updateView);
                     } else {
@@ -350,8 +351,8 @@ bool KeyframeModel::moveOneKeyframe(GenTime oldPos, GenTime pos, QVariant newVal
     qDebug() << "starting to move keyframe" << oldPos.frames(pCore->getCurrentFps()) << pos.frames(pCore->getCurrentFps());
     QWriteLocker locker(&m_lock);
     if (!allowedToFail) {
-        Q_ASSERT(m_keyframeList.count(oldPos) > 0);
-    } else if (m_keyframeList.count(oldPos) == 0) {
+        Q_ASSERT(m_keyframeList.count(TickTime(oldPos)) > 0);
+    } else if (m_keyframeList.count(TickTime(oldPos)) == 0) {
         return true;
     }
     if (oldPos == pos) {
@@ -371,8 +372,8 @@ bool KeyframeModel::moveOneKeyframe(GenTime oldPos, GenTime pos, QVariant newVal
         qDebug() << "==== MOVE REJECTED!!";
         return false;
     }
-    KeyframeType::KeyframeEnum oldType = m_keyframeList[oldPos].first;
-    QVariant oldValue = m_keyframeList[oldPos].second;
+    KeyframeType::KeyframeEnum oldType = m_keyframeList[TickTime(oldPos)].first;
+    QVariant oldValue = m_keyframeList[TickTime(oldPos)].second;
     Fun local_undo = []() { return true; };
     Fun local_redo = []() { return true; };
     qDebug() << getAnimProperty();
@@ -417,15 +418,15 @@ bool KeyframeModel::offsetKeyframes(int oldPos, int pos, bool logUndo)
 {
     if (oldPos == pos) return true;
     GenTime oldFrame(oldPos, pCore->getCurrentFps());
-    Q_ASSERT(m_keyframeList.count(oldFrame) > 0);
+    Q_ASSERT(m_keyframeList.count(TickTime(oldFrame)) > 0);
     GenTime diff(pos - oldPos, pCore->getCurrentFps());
     QWriteLocker locker(&m_lock);
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
     QList<GenTime> times;
     for (const auto &m : m_keyframeList) {
-        if (m.first < oldFrame) continue;
-        times << m.first;
+        if (m.first < TickTime(oldFrame)) continue;
+        times << GenTime(m.first);
     }
     bool res = true;
     for (const auto &t : std::as_const(times)) {
@@ -447,7 +448,7 @@ bool KeyframeModel::moveKeyframe(int oldPos, int pos, QVariant newVal)
 bool KeyframeModel::moveKeyframe(GenTime oldPos, GenTime pos, QVariant newVal, bool logUndo)
 {
     QWriteLocker locker(&m_lock);
-    Q_ASSERT(m_keyframeList.count(oldPos) > 0);
+    Q_ASSERT(m_keyframeList.count(TickTime(oldPos)) > 0);
     if (oldPos == pos) return true;
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
@@ -461,8 +462,8 @@ bool KeyframeModel::moveKeyframe(GenTime oldPos, GenTime pos, QVariant newVal, b
 bool KeyframeModel::directUpdateKeyframe(GenTime pos, QVariant value, bool notify)
 {
     QWriteLocker locker(&m_lock);
-    Q_ASSERT(m_keyframeList.count(pos) > 0);
-    KeyframeType::KeyframeEnum type = m_keyframeList[pos].first;
+    Q_ASSERT(m_keyframeList.count(TickTime(pos)) > 0);
+    KeyframeType::KeyframeEnum type = m_keyframeList[TickTime(pos)].first;
     auto operation = updateKeyframe_lambda(pos, type, std::move(value), notify);
     return operation();
 }
@@ -470,9 +471,9 @@ bool KeyframeModel::directUpdateKeyframe(GenTime pos, QVariant value, bool notif
 bool KeyframeModel::updateKeyframe(GenTime pos, const QVariant &value, Fun &undo, Fun &redo, bool update)
 {
     QWriteLocker locker(&m_lock);
-    Q_ASSERT(m_keyframeList.count(pos) > 0);
-    KeyframeType::KeyframeEnum type = m_keyframeList[pos].first;
-    QVariant oldValue = m_keyframeList[pos].second;
+    Q_ASSERT(m_keyframeList.count(TickTime(pos)) > 0);
+    KeyframeType::KeyframeEnum type = m_keyframeList[TickTime(pos)].first;
+    QVariant oldValue = m_keyframeList[TickTime(pos)].second;
     // Check if keyframe is different
     if (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel) {
         if (qFuzzyCompare(oldValue.toDouble(), value.toDouble())) return true;
@@ -518,7 +519,7 @@ bool KeyframeModel::updateKeyframe(int pos, double newVal)
 bool KeyframeModel::updateKeyframe(GenTime pos, QVariant value)
 {
     QWriteLocker locker(&m_lock);
-    Q_ASSERT(m_keyframeList.count(pos) > 0);
+    Q_ASSERT(m_keyframeList.count(TickTime(pos)) > 0);
 
     Fun undo = []() { return true; };
     Fun redo = []() { return true; };
@@ -568,10 +569,10 @@ KeyframeType::KeyframeEnum convertFromMltType(mlt_keyframe_type type)
 bool KeyframeModel::updateKeyframeType(GenTime pos, int type, Fun &undo, Fun &redo)
 {
     QWriteLocker locker(&m_lock);
-    Q_ASSERT(m_keyframeList.count(pos) > 0);
-    KeyframeType::KeyframeEnum oldType = m_keyframeList[pos].first;
+    Q_ASSERT(m_keyframeList.count(TickTime(pos)) > 0);
+    KeyframeType::KeyframeEnum oldType = m_keyframeList[TickTime(pos)].first;
     KeyframeType::KeyframeEnum newType = convertFromMltType(mlt_keyframe_type(type));
-    QVariant value = m_keyframeList[pos].second;
+    QVariant value = m_keyframeList[TickTime(pos)].second;
     // Check if keyframe is different
     if (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel) {
         if (oldType == newType) return true;
@@ -589,10 +590,11 @@ Fun KeyframeModel::updateKeyframe_lambda(GenTime pos, KeyframeType::KeyframeEnum
 {
     QWriteLocker locker(&m_lock);
     return [this, pos, type, value, notify]() {
-        Q_ASSERT(m_keyframeList.count(pos) > 0);
-        int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(pos)));
-        m_keyframeList[pos].first = type;
-        m_keyframeList[pos].second = value;
+        Q_ASSERT(m_keyframeList.count(TickTime(pos)) > 0);
+        int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(TickTime(pos))));
+        m_keyframeList[TickTime(pos)].first = type;
+        m_keyframeList[TickTime(pos)].second = value;
+        m_revision.ref();
         if (notify) Q_EMIT dataChanged(index(row), index(row), {ValueRole, NormalizedValueRole, TypeRole});
         return true;
     };
@@ -603,16 +605,17 @@ Fun KeyframeModel::addKeyframe_lambda(GenTime pos, KeyframeType::KeyframeEnum ty
     QWriteLocker locker(&m_lock);
     return [this, notify, pos, type, value]() {
         qDebug() << "add lambda" << pos.frames(pCore->getCurrentFps()) << value << notify;
-        Q_ASSERT(m_keyframeList.count(pos) == 0);
+        Q_ASSERT(m_keyframeList.count(TickTime(pos)) == 0);
         // We determine the row of the newly added marker
-        auto insertionIt = m_keyframeList.lower_bound(pos);
+        auto insertionIt = m_keyframeList.lower_bound(TickTime(pos));
         int insertionRow = static_cast<int>(m_keyframeList.size());
         if (insertionIt != m_keyframeList.end()) {
             insertionRow = static_cast<int>(std::distance(m_keyframeList.begin(), insertionIt));
         }
         if (notify) beginInsertRows(QModelIndex(), insertionRow, insertionRow);
-        m_keyframeList[pos].first = type;
-        m_keyframeList[pos].second = value;
+        m_keyframeList[TickTime(pos)].first = type;
+        m_keyframeList[TickTime(pos)].second = value;
+        m_revision.ref();
         if (notify) endInsertRows();
         return true;
     };
@@ -624,11 +627,12 @@ Fun KeyframeModel::deleteKeyframe_lambda(GenTime pos, bool notify)
     return [this, pos, notify]() {
         qDebug() << "delete lambda" << pos.frames(pCore->getCurrentFps()) << notify;
         qDebug() << "before" << getAnimProperty();
-        Q_ASSERT(m_keyframeList.count(pos) > 0);
+        Q_ASSERT(m_keyframeList.count(TickTime(pos)) > 0);
         // Q_ASSERT(pos != GenTime()); // cannot delete initial point
-        int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(pos)));
+        int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(TickTime(pos))));
         if (notify) beginRemoveRows(QModelIndex(), row, row);
-        m_keyframeList.erase(pos);
+        m_keyframeList.erase(TickTime(pos));
+        m_revision.ref();
         if (notify) endRemoveRows();
         qDebug() << "after" << getAnimProperty();
         return true;
@@ -751,30 +755,30 @@ bool KeyframeModel::singleKeyframe() const
 Keyframe KeyframeModel::getKeyframe(const GenTime &pos, bool *ok) const
 {
     READ_LOCK();
-    if (m_keyframeList.count(pos) == 0) {
+    if (m_keyframeList.count(TickTime(pos)) == 0) {
         // return empty marker
         *ok = false;
         return {GenTime(), KeyframeType::Linear};
     }
     *ok = true;
-    return {pos, m_keyframeList.at(pos).first};
+    return {pos, m_keyframeList.at(TickTime(pos)).first};
 }
 
 Keyframe KeyframeModel::getNextKeyframe(const GenTime &pos, bool *ok) const
 {
-    auto it = m_keyframeList.upper_bound(pos);
+    auto it = m_keyframeList.upper_bound(TickTime(pos));
     if (it == m_keyframeList.end()) {
         // return empty marker
         *ok = false;
         return {GenTime(), KeyframeType::Linear};
     }
     *ok = true;
-    return {(*it).first, (*it).second.first};
+    return {GenTime((*it).first), (*it).second.first};
 }
 
 Keyframe KeyframeModel::getPrevKeyframe(const GenTime &pos, bool *ok) const
 {
-    auto it = m_keyframeList.lower_bound(pos);
+    auto it = m_keyframeList.lower_bound(TickTime(pos));
     if (it == m_keyframeList.begin()) {
         // return empty marker
         *ok = false;
@@ -782,12 +786,12 @@ Keyframe KeyframeModel::getPrevKeyframe(const GenTime &pos, bool *ok) const
     }
     --it;
     *ok = true;
-    return {(*it).first, (*it).second.first};
+    return {GenTime((*it).first), (*it).second.first};
 }
 
 Keyframe KeyframeModel::getClosestKeyframe(const GenTime &pos, bool *ok) const
 {
-    if (m_keyframeList.count(pos) > 0) {
+    if (m_keyframeList.count(TickTime(pos)) > 0) {
         return getKeyframe(pos, ok);
     }
     bool ok1, ok2;
@@ -816,7 +820,7 @@ bool KeyframeModel::hasKeyframe(int frame) const
 bool KeyframeModel::hasKeyframe(const GenTime &pos) const
 {
     READ_LOCK();
-    return m_keyframeList.count(pos) > 0;
+    return m_keyframeList.count(TickTime(pos)) > 0;
 }
 
 bool KeyframeModel::removeAllKeyframes(Fun &undo, Fun &redo)
@@ -1126,6 +1130,7 @@ void KeyframeModel::parseRotoProperty(const QString &prop)
     } else {
         // Empty doc, clear all keyframes
         m_keyframeList.clear();
+        m_revision.ref();
     }
 }
 
@@ -1178,15 +1183,16 @@ QVariant KeyframeModel::getNormalizedValue(double newVal) const
 
 QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
 {
-    if (m_keyframeList.count(pos) > 0) {
-        return m_keyframeList.at(pos).second;
+    READ_LOCK();
+    if (m_keyframeList.count(TickTime(pos)) > 0) {
+        return m_keyframeList.at(TickTime(pos)).second;
     }
     if (m_keyframeList.size() == 0) {
         return QVariant();
     }
     if (m_paramType == ParamType::Roto_spline) {
         // interpolate
-        auto next = m_keyframeList.upper_bound(pos);
+        auto next = m_keyframeList.upper_bound(TickTime(pos));
         if (next == m_keyframeList.cbegin()) {
             return (m_keyframeList.cbegin())->second.second;
         }
@@ -1226,39 +1232,91 @@ QVariant KeyframeModel::getInterpolatedValue(const GenTime &pos) const
         }
         return vlist;
     }
-    Mlt::Properties mlt_prop;
-    QString animData;
-    int out = 0;
-    bool useOpacity = false;
-    if (auto ptr = m_model.lock()) {
-        ptr->passProperties(mlt_prop);
-        out = ptr->data(m_index, AssetParameterModel::ParentDurationRole).toInt();
-        useOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
-        animData = ptr->data(m_index, AssetParameterModel::ValueRole).toString();
+    QMutexLocker lock(&m_animationMutex);
+    Mlt::Properties *animation = parsedAnimation();
+    if (animation == nullptr) {
+        return QVariant();
+    }
+    return animationValue(*animation, pos.frames(pCore->getCurrentFps()));
+}
+
+QVector<QVariant> KeyframeModel::getInterpolatedValues(const QVector<int> &frames) const
+{
+    READ_LOCK();
+    QVector<QVariant> values;
+    values.reserve(frames.size());
+    const double fps = pCore->getCurrentFps();
+    if (m_paramType == ParamType::Roto_spline || m_keyframeList.empty()) {
+        for (int frame : frames) {
+            values << getInterpolatedValue(GenTime(frame, fps));
+        }
+        return values;
+    }
+    QMutexLocker lock(&m_animationMutex);
+    Mlt::Properties *animation = parsedAnimation();
+    for (int frame : frames) {
+        auto kf = m_keyframeList.find(TickTime::fromFrames(frame, fps));
+        if (kf != m_keyframeList.end()) {
+            values << kf->second.second;
+        } else if (animation != nullptr) {
+            values << animationValue(*animation, frame);
+        } else {
+            values << QVariant();
+        }
+    }
+    return values;
+}
+
+Mlt::Properties *KeyframeModel::parsedAnimation() const
+{
+    auto ptr = m_model.lock();
+    if (!ptr) {
+        return nullptr;
+    }
+    // The duration is needed for keyframes positioned from the end, it changes without keyframe modification when the item is resized
+    const int out = ptr->data(m_index, AssetParameterModel::ParentDurationRole).toInt();
+    const double fps = pCore->getCurrentFps();
+    mlt_profile profile = pCore->getProjectProfile().get_profile();
+    const int revision = m_revision.loadAcquire();
+    // The parameter can also be written directly to the asset model (undo, tasks), so compare its value too
+    const QString animData = ptr->data(m_index, AssetParameterModel::ValueRole).toString();
+    if (m_animationRevision == revision && animData == m_animationData && out == m_animationDuration && qFuzzyCompare(fps, m_animationFps) &&
+        profile == m_animationProfile) {
+        return m_animation.get();
+    }
+    m_animationRevision = revision;
+    m_animationData = animData;
+    m_animationDuration = out;
+    m_animationFps = fps;
+    m_animationProfile = profile;
+    if (animData.isEmpty()) {
+        m_animation.reset();
+        return nullptr;
     }
+    m_animationOpacity = ptr->data(m_index, AssetParameterModel::OpacityRole).toBool();
+    m_animation = std::make_unique<Mlt::Properties>();
+    ptr->passProperties(*m_animation);
+    m_animation->set("key", animData.toUtf8().constData());
+    // This is a fake query to force the animation to be parsed, later queries without length reuse it
+    (void)m_animation->anim_get_double("key", 0, out);
+    return m_animation.get();
+}
 
-    if (!animData.isEmpty() && (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel)) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        return QVariant(mlt_prop.anim_get_double("key", pos.frames(pCore->getCurrentFps())));
+QVariant KeyframeModel::animationValue(Mlt::Properties &animation, int frame) const
+{
+    if (m_paramType == ParamType::KeyframeParam || m_paramType == ParamType::ColorWheel) {
+        return QVariant(animation.anim_get_double("key", frame));
     }
-    if (!animData.isEmpty() && m_paramType == ParamType::AnimatedRect) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        mlt_rect rect = mlt_prop.anim_get_rect("key", pos.frames(pCore->getCurrentFps()));
+    if (m_paramType == ParamType::AnimatedRect) {
+        mlt_rect rect = animation.anim_get_rect("key", frame);
         QString res = QStringLiteral("%1 %2 %3 %4").arg(int(rect.x)).arg(int(rect.y)).arg(int(rect.w)).arg(int(rect.h));
-        if (useOpacity) {
+        if (m_animationOpacity) {
             res.append(QStringLiteral(" %1").arg(QString::number(rect.o, 'f')));
         }
         return QVariant(res);
     }
-    if (!animData.isEmpty() && m_paramType == ParamType::Color) {
-        mlt_prop.set("key", animData.toUtf8().constData());
-        // This is a fake query to force the animation to be parsed
-        (void)mlt_prop.anim_get_double("key", 0, out);
-        mlt_color mltColor = mlt_prop.anim_get_color("key", pos.frames(pCore->getCurrentFps()));
+    if (m_paramType == ParamType::Color) {
+        mlt_color mltColor = animation.anim_get_color("key", frame);
         QColor color(mltColor.r, mltColor.g, mltColor.b, mltColor.a);
         return QVariant(QColorUtils::colorToString(color, true));
     }
@@ -1273,6 +1331,8 @@ void KeyframeModel::sendModification()
         if (AssetParameterModel::isAnimated(m_paramType)) {
             m_lastData = getAnimProperty();
             ptr->setParameter(name, m_lastData, false, m_index);
+            // The animation may have been parsed from the previous parameter value since the keyframes changed
+            m_revision.ref();
         } else {
             Q_ASSERT(false); // Not implemented, TODO
         }
@@ -1341,6 +1401,7 @@ void KeyframeModel::refresh(int in, int out)
         }
     }
     m_lastData = animData;
+    m_revision.ref();
 }
 
 void KeyframeModel::reset()
@@ -1378,6 +1439,7 @@ void KeyframeModel::reset()
         }
     }
     m_lastData = animData;
+    m_revision.ref();
 }
 
 QList<QPoint> KeyframeModel::getRanges(const QString &animData, const std::shared_ptr<AssetParameterModel> &model)
@@ -1531,7 +1593,7 @@ QList<GenTime> KeyframeModel::getKeyframePos() const
 {
     QList<GenTime> all_pos;
     for (const auto &m : m_keyframeList) {
-        all_pos.push_back(m.first);
+        all_pos.push_back(GenTime(m.first));
     }
     return all_pos;
 }
@@ -1543,8 +1605,8 @@ bool KeyframeModel::removeNextKeyframes(GenTime pos, Fun &undo, Fun &redo)
     Fun local_undo = []() { return true; };
     Fun local_redo = []() { return true; };
     for (const auto &m : m_keyframeList) {
-        if (m.first >= pos && m.first != m_keyframeList.begin()->first) {
-            all_pos.push_back(m.first);
+        if (m.first >= TickTime(pos) && m.first != m_keyframeList.begin()->first) {
+            all_pos.push_back(GenTime(m.first));
         }
     }
     if (all_pos.empty()) {
@@ -1564,7 +1626,7 @@ bool KeyframeModel::removeNextKeyframes(GenTime pos, Fun &undo, Fun &redo)
         ptr->m_selectedKeyframes = selection;
     }
     // we trigger only one global remove/insertrow event
-    int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(all_pos.front())));
+    int row = static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(TickTime(all_pos.front()))));
     Fun update_redo_start = [this, row, kfrCount]() {
         beginRemoveRows(QModelIndex(), row, kfrCount - 1);
         return true;
@@ -1673,10 +1735,10 @@ void KeyframeModel::setActiveKeyframe(int ix)
 
 int KeyframeModel::getIndexForPos(const GenTime pos) const
 {
-    if (m_keyframeList.count(pos) == 0) {
+    if (m_keyframeList.count(TickTime(pos)) == 0) {
         return -1;
     }
-    return static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(pos)));
+    return static_cast<int>(std::distance(m_keyframeList.begin(), m_keyframeList.find(TickTime(pos))));
 }
 
 int KeyframeModel::keyframesCount() const
@@ -9,8 +9,11 @@
 #include "definitions.h"
 #include "undohelper.hpp"
 #include "utils/gentime.h"
+#include "utils/ticktime.h"
 
 #include <QAbstractListModel>
+#include <QAtomicInt>
+#include <QMutex>
 #include <QReadWriteLock>
 #include <QtGlobal>
 
@@ -146,6 +149,8 @@ public:
     /** @brief Return the interpolated value at given pos */
     QVariant getInterpolatedValue(int pos) const;
     QVariant getInterpolatedValue(const GenTime &pos) const;
+    /** @brief Return the interpolated values at the given @p frames, looking up the parsed animation only once */
+    QVector<QVariant> getInterpolatedValues(const QVector<int> &frames) const;
     QVariant updateInterpolated(const QVariant &interpValue, double val);
     /** @brief Return the real value from a normalized one */
     QVariant getNormalizedValue(double newVal) const;
@@ -204,6 +209,12 @@ protected:
     void parseAnimProperty(const QString &prop, int in = -1, int out = -1);
     void parseRotoProperty(const QString &prop);
 
+    /** @brief Returns the MLT animation of the parameter value, parsed again only if the keyframes, the duration or the profile changed.
+        Called with m_animationMutex locked */
+    Mlt::Properties *parsedAnimation() const;
+    /** @brief Evaluate the parsed animation at @p frame. Called with m_animationMutex locked */
+    QVariant animationValue(Mlt::Properties &animation, int frame) const;
+
 protected:
     std::weak_ptr<AssetParameterModel> m_model;
     std::weak_ptr<DocUndoStack> m_undoStack;
@@ -214,8 +225,21 @@ private:
     ParamType m_paramType;
     /** @brief This is a lock that ensures safety in case of concurrent access */
     mutable QReadWriteLock m_lock;
-
-    std::map<GenTime, std::pair<KeyframeType::KeyframeEnum, QVariant>> m_keyframeList;
+    /** @brief Incremented on every change of the keyframes or of the parameter value */
+    QAtomicInt m_revision;
+    /** @brief Animation parsed from the parameter value, reused by getInterpolatedValue until m_revision or the value changes */
+    mutable std::unique_ptr<Mlt::Properties> m_animation;
+    mutable int m_animationRevision{-1};
+    mutable QString m_animationData;
+    mutable int m_animationDuration{0};
+    mutable double m_animationFps{0.};
+    mutable mlt_profile m_animationProfile{nullptr};
+    mutable bool m_animationOpacity{false};
+    /** @brief MLT animations are not safe to query from several threads */
+    mutable QMutex m_animationMutex;
+
+    /** @brief Keyframes sorted by position, keyed on the exact ticks of their GenTime position */
+    std::map<TickTime, std::pair<KeyframeType::KeyframeEnum, QVariant>> m_keyframeList;
     bool moveOneKeyframe(GenTime oldPos, GenTime pos, QVariant newVal, Fun &undo, Fun &redo, bool updateView = true, bool allowedToFail = false);
 
 Q_SIGNALS:
@@ -126,6 +126,10 @@ public:
        @param pos is the position where we interpolate
        @param index is the index of the queried parameter. */
     QVariant getInterpolatedValue(const GenTime &pos, const QPersistentModelIndex &index) const;
+    /** @brief Return the interpolated values of a parameter at several frames.
+       @param frames are the positions where we interpolate
+       @param index is the index of the queried parameter. */
+    QVector<QVariant> getInterpolatedValues(const QVector<int> &frames, const QPersistentModelIndex &index) const;
 
     /** @brief Load keyframes from the current parameter value. */
     void refresh();
@@ -82,8 +82,10 @@ void KeyframeMonitorHelper::refreshParams(int pos)
             continue;
         }
         KeyframeModel *kfr = keyframes->getKeyModel(ix);
+        const double fps = pCore->getCurrentFps();
+        // Query the rect at the current position and at all keyframes at once
+        QVector<int> frames = {pos};
         bool ok;
-        rectAtPosData = kfr->getInterpolatedValue(pos).toString();
         Keyframe kf = kfr->getNextKeyframe(GenTime(-1), &ok);
         while (ok) {
             if (kf.second == KeyframeType::Curve) {
@@ -91,13 +93,17 @@ void KeyframeMonitorHelper::refreshParams(int pos)
             } else {
                 types << 0;
             }
-            QString rectData = kfr->getInterpolatedValue(kf.first).toString();
-            QStringList data = rectData.split(QLatin1Char(' '));
+            frames << kf.first.frames(fps);
+            kf = kfr->getNextKeyframe(kf.first, &ok);
+        }
+        const QVector<QVariant> values = kfr->getInterpolatedValues(frames);
+        rectAtPosData = values.constFirst().toString();
+        for (int i = 1; i < values.size(); ++i) {
+            QStringList data = values.at(i).toString().split(QLatin1Char(' '));
             if (data.size() > 3) {
                 QRectF r(data.at(0).toInt(), data.at(1).toInt(), data.at(2).toInt(), data.at(3).toInt());
                 points.append(QVariant(r.center()));
             }
-            kf = kfr->getNextKeyframe(kf.first, &ok);
         }
         break;
     }
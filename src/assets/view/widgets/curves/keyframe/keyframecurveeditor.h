@@ -96,5 +96,6 @@ private:
     double valueFromCanvasPos(double ypos);
     void updateKeyframeData(double val);
     int seekPosOnCanvas(double xpos);
-    const QPointF getPointFromModel(int framePos, int offset);
+    /** @brief Returns the position on the canvas of the interpolated @p value at @p framePos */
+    const QPointF getPointFromValue(const QVariant &value, int framePos, int offset);
 };
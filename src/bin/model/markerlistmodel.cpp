@@ -177,12 +177,16 @@ const QString MarkerListModel::categoriesToJSon() const
     return QString::fromUtf8(json.toJson());
 }
 
+TickTime MarkerListModel::positionKey(const GenTime &pos)
+{
+    // Snapped to the frame, unlike TickTime(pos): the key depends on the project fps
+    const double fps = pCore->getCurrentFps();
+    return TickTime::fromFrames(pos.frames(fps), fps);
+}
+
 int MarkerListModel::markerIdAtFrame(int pos) const
 {
-    if (m_markerPositions.contains(pos)) {
-        return m_markerPositions.value(pos);
-    }
-    return -1;
+    return m_markerPositions.value(TickTime::fromFrames(pos, pCore->getCurrentFps()), -1);
 }
 
 bool MarkerListModel::hasMarker(GenTime pos) const
@@ -357,10 +361,7 @@ int MarkerListModel::getIdFromPos(const GenTime &pos) const
 
 int MarkerListModel::getIdFromPos(int frame) const
 {
-    if (m_markerPositions.contains(frame)) {
-        return m_markerPositions.value(frame);
-    }
-    return -1;
+    return m_markerPositions.value(TickTime::fromFrames(frame, pCore->getCurrentFps()), -1);
 }
 
 bool MarkerListModel::moveMarker(int mid, GenTime pos)
@@ -372,10 +373,9 @@ bool MarkerListModel::moveMarker(int mid, GenTime pos)
         return false;
     }
     int row = getRowfromId(mid);
-    int oldPos = m_markerList.at(mid).time().frames(pCore->getCurrentFps());
+    m_markerPositions.remove(positionKey(m_markerList.at(mid).time()));
     m_markerList[mid].setTime(pos);
-    m_markerPositions.remove(oldPos);
-    m_markerPositions.insert(pos.frames(pCore->getCurrentFps()), mid);
+    m_markerPositions.insert(positionKey(pos), mid);
     Q_EMIT dataChanged(index(row), index(row), {FrameRole});
     return true;
 }
@@ -391,9 +391,9 @@ void MarkerListModel::moveMarkersWithoutUndo(const QVector<int> &markersId, int
     for (auto mid : markersId) {
         Q_ASSERT(m_markerList.count(mid) > 0);
         GenTime t = m_markerList.at(mid).time();
-        m_markerPositions.remove(t.frames(pCore->getCurrentFps()));
+        m_markerPositions.remove(positionKey(t));
         t += GenTime(offset, pCore->getCurrentFps());
-        m_markerPositions.insert(t.frames(pCore->getCurrentFps()), mid);
+        m_markerPositions.insert(positionKey(t), mid);
         m_markerList[mid].setTime(t);
         if (!updateView) {
             continue;
@@ -465,7 +465,7 @@ Fun MarkerListModel::addMarker_lambda(GenTime pos, const QString &comment, int t
         int insertionRow = static_cast<int>(m_markerList.size());
         beginInsertRows(QModelIndex(), insertionRow, insertionRow);
         m_markerList[mid] = CommentedTime(pos, comment, type);
-        m_markerPositions.insert(pos.frames(pCore->getCurrentFps()), mid);
+        m_markerPositions.insert(positionKey(pos), mid);
         endInsertRows();
         addSnapPoint(pos);
         return true;
@@ -481,7 +481,7 @@ Fun MarkerListModel::deleteMarker_lambda(GenTime pos)
         int row = getRowfromId(mid);
         beginRemoveRows(QModelIndex(), row, row);
         m_markerList.erase(mid);
-        m_markerPositions.remove(pos.frames(pCore->getCurrentFps()));
+        m_markerPositions.remove(positionKey(pos));
         endRemoveRows();
         removeSnapPoint(pos);
         return true;
@@ -625,7 +625,7 @@ int MarkerListModel::getMarkerPos(int mid) const
 {
     READ_LOCK();
     Q_ASSERT(m_markerList.count(mid) > 0);
-    return m_markerPositions.key(mid);
+    return m_markerPositions.key(mid).frames(pCore->getCurrentFps());
 }
 
 QVector<int> MarkerListModel::getMarkersIdInRange(int start, int end) const
@@ -633,14 +633,14 @@ QVector<int> MarkerListModel::getMarkersIdInRange(int start, int end) const
     READ_LOCK();
     // First find marker ids in range
     QVector<int> markers;
-    QMap<int, int>::const_iterator i = m_markerPositions.constBegin();
+    const double fps = pCore->getCurrentFps();
+    const TickTime endTime = TickTime::fromFrames(end, fps);
+    QMap<TickTime, int>::const_iterator i = m_markerPositions.lowerBound(TickTime::fromFrames(start, fps));
     while (i != m_markerPositions.constEnd()) {
-        if (end > -1 && i.key() > end) {
+        if (end > -1 && i.key() > endTime) {
             break;
         }
-        if (i.key() >= start) {
-            markers << i.value();
-        }
+        markers << i.value();
         ++i;
     }
     return markers;
@@ -649,29 +649,34 @@ QVector<int> MarkerListModel::getMarkersIdInRange(int start, int end) const
 std::vector<int> MarkerListModel::getSnapPoints() const
 {
     READ_LOCK();
-    const QList<int> positions = m_markerPositions.keys();
-    std::vector<int> markers(positions.cbegin(), positions.cend());
+    const double fps = pCore->getCurrentFps();
+    std::vector<int> markers;
+    markers.reserve(size_t(m_markerPositions.size()));
+    for (auto i = m_markerPositions.constBegin(); i != m_markerPositions.constEnd(); ++i) {
+        markers.push_back(i.key().frames(fps));
+    }
     return markers;
 }
 
 bool MarkerListModel::hasMarker(int frame) const
 {
     READ_LOCK();
-    return m_markerPositions.contains(frame);
+    return m_markerPositions.contains(TickTime::fromFrames(frame, pCore->getCurrentFps()));
 }
 
 void MarkerListModel::registerSnapModel(const std::weak_ptr<SnapInterface> &snapModel)
 {
-    READ_LOCK();
+    QWriteLocker locker(&m_lock);
     // make sure ptr is valid
     if (auto ptr = snapModel.lock()) {
         // ptr is valid, we store it
         m_registeredSnaps.push_back(snapModel);
 
         // we now add the already existing markers to the snap
-        QMap<int, int>::const_iterator i = m_markerPositions.constBegin();
+        const double fps = pCore->getCurrentFps();
+        QMap<TickTime, int>::const_iterator i = m_markerPositions.constBegin();
         while (i != m_markerPositions.constEnd()) {
-            ptr->addPoint(i.key());
+            ptr->addPoint(i.key().frames(fps));
             ++i;
         }
     } else {
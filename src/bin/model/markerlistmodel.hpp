@@ -8,6 +8,7 @@
 #include "definitions.h"
 #include "undohelper.hpp"
 #include "utils/gentime.h"
+#include "utils/ticktime.h"
 
 #include <QAbstractListModel>
 #include <QReadWriteLock>
@@ -213,12 +214,16 @@ private:
     mutable QReadWriteLock m_lock;
 
     std::map<int, CommentedTime> m_markerList;
-    /** @brief A list of {marker frame,marker id}, useful to quickly find a marker */
-    QMap<int, int> m_markerPositions;
+    /** @brief A list of {marker time,marker id}, useful to quickly find a marker.
+     *  Keyed on the exact ticks of the frame containing the marker, see positionKey */
+    QMap<TickTime, int> m_markerPositions;
 
     std::vector<std::weak_ptr<SnapInterface>> m_registeredSnaps;
     int getRowfromId(int mid) const;
     int getIdFromPos(const GenTime &pos) const;
+    /** @brief The key of a marker time in m_markerPositions: the tick of its frame, so that markers
+     *  that are not on a frame boundary (imported from seconds) are still found by frame */
+    static TickTime positionKey(const GenTime &pos);
     int getIdFromPos(int frame) const;
 
 Q_SIGNALS:
@@ -45,7 +45,15 @@ SubtitleModel::SubtitleModel(std::shared_ptr<TimelineItemModel> timeline, const
         m_subtitleFilter->set("internal_added", 237);
     }
     setup();
-    connect(this, &SubtitleModel::modelChanged, [this]() { jsontoSubtitle(toJson()); });
+    // Bursts of edits only rewrite the working file once
+    m_workFileTimer.setSingleShot(true);
+    m_workFileTimer.setInterval(200);
+    connect(&m_workFileTimer, &QTimer::timeout, this, [this]() {
+        if (flushWorkFile()) {
+            pCore->refreshProjectMonitorOnce();
+        }
+    });
+    connect(this, &SubtitleModel::modelChanged, this, &SubtitleModel::scheduleWorkFileUpdate);
 
     const QUuid timelineUuid = timeline->uuid();
     int id = pCore->currentDoc()->getSequenceProperty(timelineUuid, QStringLiteral("kdenlive:activeSubtitleIndex"), QStringLiteral("0")).toInt();
@@ -116,6 +124,23 @@ const QString SubtitleModel::getForceStyle() const
     return style;
 }
 
+std::pair<int, TickTime> SubtitleModel::subtitleKey(int layer, GenTime start)
+{
+    // Snapped to the frame, unlike TickTime(start): the key depends on the project fps
+    const double fps = pCore->getCurrentFps();
+    return {layer, TickTime::fromFrames(start.frames(fps), fps)};
+}
+
+std::pair<int, TickTime> SubtitleModel::subtitleKey(const std::pair<int, GenTime> &start)
+{
+    return subtitleKey(start.first, start.second);
+}
+
+std::pair<int, GenTime> SubtitleModel::subtitleStart(const std::pair<int, TickTime> &key)
+{
+    return {key.first, GenTime(key.second)};
+}
+
 void SubtitleModel::setup()
 {
     // We connect the signals of the abstractitemmodel to a more generic one.
@@ -473,10 +498,10 @@ bool SubtitleModel::addSubtitle(int id, std::pair<int, GenTime> start, const Sub
         return false;
     }
     // Don't allow 2 subtitles at same start pos
-    if (m_subtitleList.count(start) > 0) {
+    if (m_subtitleList.count(subtitleKey(start)) > 0) {
         qDebug() << "already present in model"
-                 << "string :" << m_subtitleList[start].text() << " start time " << start.second.frames(pCore->getCurrentFps())
-                 << "end time : " << m_subtitleList[start].endTime().frames(pCore->getCurrentFps());
+                 << "string :" << m_subtitleList[subtitleKey(start)].text() << " start time " << start.second.frames(pCore->getCurrentFps())
+                 << "end time : " << m_subtitleList[subtitleKey(start)].endTime().frames(pCore->getCurrentFps());
         return false;
     }
     if (start.first > m_maxLayer) {
@@ -490,7 +515,7 @@ bool SubtitleModel::addSubtitle(int id, std::pair<int, GenTime> start, const Sub
     registerSubtitle(id, start, temporary);
     int row = getSubtitleIndex(id);
     beginInsertRows(QModelIndex(), row, row);
-    m_subtitleList[start] = event;
+    m_subtitleList[subtitleKey(start)] = event;
     endInsertRows();
     addSnapPoint(start.second);
     addSnapPoint(event.endTime()); // {layer, end}
@@ -536,7 +561,7 @@ QVariant SubtitleModel::data(const QModelIndex &index, int role) const
     case Qt::DisplayRole:
     case Qt::EditRole:
     case SubtitleRole:
-        return m_subtitleList.at(subInfo.second).text();
+        return m_subtitleList.at(subtitleKey(subInfo.second)).text();
     case IdRole:
         return subInfo.first;
     case LayerRole:
@@ -544,25 +569,25 @@ QVariant SubtitleModel::data(const QModelIndex &index, int role) const
     case StartPosRole:
         return subInfo.second.second.seconds();
     case EndPosRole:
-        return m_subtitleList.at(subInfo.second).endTime().seconds();
+        return m_subtitleList.at(subtitleKey(subInfo.second)).endTime().seconds();
     case StartFrameRole:
         return subInfo.second.second.frames(pCore->getCurrentFps());
     case EndFrameRole:
-        return m_subtitleList.at(subInfo.second).endTime().frames(pCore->getCurrentFps());
+        return m_subtitleList.at(subtitleKey(subInfo.second)).endTime().frames(pCore->getCurrentFps());
     case StyleNameRole:
-        return m_subtitleList.at(subInfo.second).styleName();
+        return m_subtitleList.at(subtitleKey(subInfo.second)).styleName();
     case NameRole:
-        return m_subtitleList.at(subInfo.second).name();
+        return m_subtitleList.at(subtitleKey(subInfo.second)).name();
     case MarginLRole:
-        return m_subtitleList.at(subInfo.second).marginL();
+        return m_subtitleList.at(subtitleKey(subInfo.second)).marginL();
     case MarginRRole:
-        return m_subtitleList.at(subInfo.second).marginR();
+        return m_subtitleList.at(subtitleKey(subInfo.second)).marginR();
     case MarginVRole:
-        return m_subtitleList.at(subInfo.second).marginV();
+        return m_subtitleList.at(subtitleKey(subInfo.second)).marginV();
     case EffectRole:
-        return m_subtitleList.at(subInfo.second).effect();
+        return m_subtitleList.at(subtitleKey(subInfo.second)).effect();
     case IsDialogueRole:
-        return m_subtitleList.at(subInfo.second).isDialogue();
+        return m_subtitleList.at(subtitleKey(subInfo.second)).isDialogue();
     case SelectedRole:
         return m_selected.contains(subInfo.first);
     case FakeStartFrameRole:
@@ -583,7 +608,7 @@ const QList<std::pair<std::pair<int, GenTime>, SubtitleEvent>> SubtitleModel::ge
 {
     QList<std::pair<std::pair<int, GenTime>, SubtitleEvent>> allSubtitles;
     for (const auto &subtitles : m_subtitleList) {
-        allSubtitles << subtitles;
+        allSubtitles << std::make_pair(subtitleStart(subtitles.first), subtitles.second);
     }
     return allSubtitles;
 }
@@ -591,7 +616,7 @@ const QList<std::pair<std::pair<int, GenTime>, SubtitleEvent>> SubtitleModel::ge
 SubtitleEvent SubtitleModel::getSubtitle(int layer, GenTime startpos) const
 {
     for (const auto &subtitles : m_subtitleList) {
-        if (subtitles.first == std::make_pair(layer, startpos)) {
+        if (subtitles.first == subtitleKey(layer, startpos)) {
             return subtitles.second;
         }
     }
@@ -604,7 +629,7 @@ QString SubtitleModel::getText(int id) const
         return QString();
     }
     std::pair<int, GenTime> start = m_allSubtitles.at(id);
-    return m_subtitleList.at(start).text();
+    return m_subtitleList.at(subtitleKey(start)).text();
 }
 
 bool SubtitleModel::setText(int id, const QString &text)
@@ -613,9 +638,9 @@ bool SubtitleModel::setText(int id, const QString &text)
         return false;
     }
     std::pair<int, GenTime> start = m_allSubtitles.at(id);
-    GenTime end = m_subtitleList.at(start).endTime();
-    QString oldText = m_subtitleList.at(start).text();
-    m_subtitleList[start].setText(text);
+    GenTime end = m_subtitleList.at(subtitleKey(start)).endTime();
+    QString oldText = m_subtitleList.at(subtitleKey(start)).text();
+    m_subtitleList[subtitleKey(start)].setText(text);
     Fun local_redo = [this, start, id, end, text]() {
         editSubtitle(id, text);
         QPair<int, int> range = {start.second.frames(pCore->getCurrentFps()), end.frames(pCore->getCurrentFps())};
@@ -645,12 +670,12 @@ std::unordered_set<int> SubtitleModel::getItemsInRange(int layer, int startFrame
     std::unordered_set<int> matching;
     for (const auto &subtitles : m_subtitleList) {
         // if layer is -1, we check all layers
-        if ((endFrame > -1 && subtitles.first.second > endTime) || (layer != -1 && subtitles.first.first != layer)) {
+        if ((endFrame > -1 && GenTime(subtitles.first.second) > endTime) || (layer != -1 && subtitles.first.first != layer)) {
             // Outside range
             continue;
         }
-        if (subtitles.first.second >= startTime || subtitles.second.endTime() > startTime) {
-            int sid = getIdForStartPos(layer, subtitles.first.second);
+        if (GenTime(subtitles.first.second) >= startTime || subtitles.second.endTime() > startTime) {
+            int sid = getIdForStartPos(layer, GenTime(subtitles.first.second));
             if (sid > -1) {
                 matching.emplace(sid);
             } else {
@@ -680,13 +705,13 @@ int SubtitleModel::cutSubtitle(int layer, int position, Fun &undo, Fun &redo)
     GenTime pos(position, pCore->getCurrentFps());
     GenTime start = GenTime(-1);
     for (const auto &subtitles : m_subtitleList) {
-        if (subtitles.first.second <= pos && subtitles.second.endTime() > pos) {
-            start = subtitles.first.second;
+        if (GenTime(subtitles.first.second) <= pos && subtitles.second.endTime() > pos) {
+            start = GenTime(subtitles.first.second);
             break;
         }
     }
     if (start >= GenTime()) {
-        const SubtitleEvent originalEvent = m_subtitleList.at({layer, start});
+        const SubtitleEvent originalEvent = m_subtitleList.at(subtitleKey(layer, start));
         QString originalText = originalEvent.text();
         QString leftText, rightText;
 
@@ -781,11 +806,11 @@ void SubtitleModel::removeSnapPoint(GenTime startpos)
 void SubtitleModel::editEndPos(int layer, GenTime startPos, GenTime newEndPos, bool refreshModel)
 {
     qDebug() << "Changing the sub end timings in model";
-    if (m_subtitleList.count({layer, startPos}) <= 0) {
+    if (m_subtitleList.count(subtitleKey(layer, startPos)) <= 0) {
         // is not present in model only
         return;
     }
-    m_subtitleList[{layer, startPos}].setEndTime(newEndPos);
+    m_subtitleList[subtitleKey(layer, startPos)].setEndTime(newEndPos);
     // Trigger update of the qml view
     int id = getIdForStartPos(layer, startPos);
     int row = getSubtitleIndex(id);
@@ -793,7 +818,7 @@ void SubtitleModel::editEndPos(int layer, GenTime startPos, GenTime newEndPos, b
     if (refreshModel) {
         Q_EMIT modelChanged();
     }
-    qDebug() << startPos.frames(pCore->getCurrentFps()) << m_subtitleList[{layer, startPos}].endTime().frames(pCore->getCurrentFps());
+    qDebug() << startPos.frames(pCore->getCurrentFps()) << m_subtitleList[subtitleKey(layer, startPos)].endTime().frames(pCore->getCurrentFps());
 }
 
 void SubtitleModel::switchGrab(int sid)
@@ -843,13 +868,13 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
     }
     Q_ASSERT(m_allSubtitles.find(id) != m_allSubtitles.end());
     std::pair<int, GenTime> startPos = m_allSubtitles.at(id);
-    GenTime endPos = m_subtitleList.at(startPos).endTime();
+    GenTime endPos = m_subtitleList.at(subtitleKey(startPos)).endTime();
     Fun operation = []() { return true; };
     Fun reverse = []() { return true; };
     if (right) {
         GenTime newEndPos = startPos.second + GenTime(size, pCore->getCurrentFps());
         operation = [this, id, startPos, endPos, newEndPos, logUndo]() {
-            m_subtitleList[startPos].setEndTime(newEndPos);
+            m_subtitleList[subtitleKey(startPos)].setEndTime(newEndPos);
             removeSnapPoint(endPos);
             addSnapPoint(newEndPos);
             // Trigger update of the qml view
@@ -869,7 +894,7 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
             return true;
         };
         reverse = [this, id, startPos, endPos, newEndPos, logUndo]() {
-            m_subtitleList[startPos].setEndTime(endPos);
+            m_subtitleList[subtitleKey(startPos)].setEndTime(endPos);
             removeSnapPoint(newEndPos);
             addSnapPoint(endPos);
             // Trigger update of the qml view
@@ -890,15 +915,15 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
         };
     } else {
         std::pair<int, GenTime> newStartPos = {startPos.first, endPos - GenTime(size, pCore->getCurrentFps())};
-        if (m_subtitleList.count(newStartPos) > 0) {
+        if (m_subtitleList.count(subtitleKey(newStartPos)) > 0) {
             // There already is another subtitle at this position, abort
             return false;
         }
-        const SubtitleEvent event = m_subtitleList.at(startPos);
+        const SubtitleEvent event = m_subtitleList.at(subtitleKey(startPos));
         operation = [this, id, startPos, newStartPos, event, logUndo]() {
             m_allSubtitles[id] = newStartPos;
-            m_subtitleList.erase(startPos);
-            m_subtitleList[newStartPos] = event;
+            m_subtitleList.erase(subtitleKey(startPos));
+            m_subtitleList[subtitleKey(newStartPos)] = event;
             // Trigger update of the qml view
             removeSnapPoint(startPos.second);
             addSnapPoint(newStartPos.second);
@@ -919,8 +944,8 @@ bool SubtitleModel::requestResize(int id, int size, bool right, Fun &undo, Fun &
         };
         reverse = [this, id, startPos, newStartPos, event, logUndo]() {
             m_allSubtitles[id] = startPos;
-            m_subtitleList.erase(newStartPos);
-            m_subtitleList[startPos] = event;
+            m_subtitleList.erase(subtitleKey(newStartPos));
+            m_subtitleList[subtitleKey(startPos)] = event;
             removeSnapPoint(newStartPos.second);
             addSnapPoint(startPos.second);
             // Trigger update of the qml view
@@ -955,13 +980,13 @@ bool SubtitleModel::editSubtitle(int id, const QString &newSubtitleText)
         return false;
     }
     std::pair<int, GenTime> start = m_allSubtitles.at(id);
-    if (m_subtitleList.count(start) <= 0) {
+    if (m_subtitleList.count(subtitleKey(start)) <= 0) {
         qDebug() << "No Subtitle at pos in model";
         return false;
     }
 
     qDebug() << "Editing existing subtitle in model";
-    m_subtitleList[start].setText(newSubtitleText);
+    m_subtitleList[subtitleKey(start)].setText(newSubtitleText);
     int row = getSubtitleIndex(id);
     // TODO
 
@@ -981,20 +1006,20 @@ bool SubtitleModel::removeSubtitle(int id, bool temporary, bool updateFilter)
         return false;
     }
     std::pair<int, GenTime> start = m_allSubtitles.at(id);
-    if (m_subtitleList.count(start) <= 0) {
+    if (m_subtitleList.count(subtitleKey(start)) <= 0) {
         qDebug() << "No Subtitle at pos in model";
         return false;
     }
-    GenTime end = m_subtitleList.at(start).endTime();
+    GenTime end = m_subtitleList.at(subtitleKey(start)).endTime();
     int row = getSubtitleIndex(id);
     deregisterSubtitle(id, temporary);
     beginRemoveRows(QModelIndex(), row, row);
     bool lastSub = false;
-    if (start == m_subtitleList.rbegin()->first) {
+    if (m_subtitleList.rbegin()->first == subtitleKey(start)) {
         // Check if this is the last subtitle
         lastSub = true;
     }
-    m_subtitleList.erase(start);
+    m_subtitleList.erase(subtitleKey(start));
     endRemoveRows();
     removeSnapPoint(start.second);
     removeSnapPoint(end);
@@ -1037,12 +1062,12 @@ bool SubtitleModel::moveSubtitle(int subId, int newLayer, GenTime newPos, bool u
     }
     int oldLayer = getLayerForId(subId);
     GenTime oldPos = getStartPosForId(subId);
-    if (m_subtitleList.count({oldLayer, oldPos}) <= 0 || m_subtitleList.count({newLayer, newPos}) > 0) {
+    if (m_subtitleList.count(subtitleKey(oldLayer, oldPos)) <= 0 || m_subtitleList.count(subtitleKey(newLayer, newPos)) > 0) {
         // is not present in model, or already another one at new position
         qDebug() << "==== MOVE FAILED";
         return false;
     }
-    const SubtitleEvent event = m_subtitleList[{oldLayer, oldPos}];
+    const SubtitleEvent event = m_subtitleList[subtitleKey(oldLayer, oldPos)];
     removeSnapPoint(oldPos);
     removeSnapPoint(event.endTime());
     GenTime duration = event.endTime() - oldPos;
@@ -1052,9 +1077,9 @@ bool SubtitleModel::moveSubtitle(int subId, int newLayer, GenTime newPos, bool u
         setMaxLayer(newLayer);
     }
     m_allSubtitles[id] = {newLayer, newPos};
-    m_subtitleList.erase({oldLayer, oldPos});
-    m_subtitleList[{newLayer, newPos}] = event;
-    m_subtitleList[{newLayer, newPos}].setEndTime(endPos);
+    m_subtitleList.erase(subtitleKey(oldLayer, oldPos));
+    m_subtitleList[subtitleKey(newLayer, newPos)] = event;
+    m_subtitleList[subtitleKey(newLayer, newPos)].setEndTime(endPos);
     addSnapPoint(newPos);
     addSnapPoint(endPos);
     setActiveSubLayer(newLayer);
@@ -1072,7 +1097,7 @@ bool SubtitleModel::moveSubtitle(int subId, int newLayer, GenTime newPos, bool u
     if (updateModel) {
         // Trigger update of the subtitle file
         Q_EMIT modelChanged();
-        if (newPos == m_subtitleList.rbegin()->first.second) {
+        if (newPos == GenTime(m_subtitleList.rbegin()->first.second)) {
             // Check if this is the last subtitle
             m_timeline->updateDuration();
         }
@@ -1111,12 +1136,10 @@ int SubtitleModel::getPreviousSub(int id) const
 {
     GenTime start = getStartPosForId(id);
     int layer = getLayerForId(id);
-    int row = static_cast<int>(std::distance(m_subtitleList.begin(), m_subtitleList.find({layer, start})));
-    if (row > 0) {
-        row--;
-        auto it = m_subtitleList.begin();
-        std::advance(it, row);
-        const GenTime res = it->first.second;
+    auto it = m_subtitleList.find(subtitleKey(layer, start));
+    if (it != m_subtitleList.begin() && it != m_subtitleList.end()) {
+        --it;
+        const GenTime res(it->first.second);
         return getIdForStartPos(layer, res);
     }
     return -1;
@@ -1126,12 +1149,10 @@ int SubtitleModel::getNextSub(int id) const
 {
     GenTime start = getStartPosForId(id);
     int layer = getLayerForId(id);
-    int row = static_cast<int>(std::distance(m_subtitleList.begin(), m_subtitleList.find({layer, start})));
-    if (row < static_cast<int>(m_subtitleList.size()) - 1) {
-        row++;
-        auto it = m_subtitleList.begin();
-        std::advance(it, row);
-        const GenTime res = it->first.second;
+    auto it = m_subtitleList.find(subtitleKey(layer, start));
+    if (it != m_subtitleList.end() && std::next(it) != m_subtitleList.end()) {
+        ++it;
+        const GenTime res(it->first.second);
         return getIdForStartPos(layer, res);
     }
     return -1;
@@ -1145,7 +1166,7 @@ void SubtitleModel::subtitleFileFromZone(int in, int out, const QString &outFile
     GenTime zoneOut(out, fps);
     for (const auto &subtitle : m_subtitleList) {
         int layer = subtitle.first.first;
-        GenTime inTime = subtitle.first.second;
+        GenTime inTime(subtitle.first.second);
         GenTime outTime = subtitle.second.endTime();
         if (outTime < zoneIn) {
             // Outside zone
@@ -1180,7 +1201,7 @@ const QJsonArray SubtitleModel::toJson()
         QJsonObject currentSubtitle;
         currentSubtitle.insert(QLatin1String("layer"), QJsonValue(subtitle.first.first));
         currentSubtitle.insert(QLatin1String("startPos"), QJsonValue(subtitle.first.second.seconds()));
-        currentSubtitle.insert(QLatin1String("dialogue"), QJsonValue(subtitle.second.toString(subtitle.first.first, subtitle.first.second)));
+        currentSubtitle.insert(QLatin1String("dialogue"), QJsonValue(subtitle.second.toString(subtitle.first.first, GenTime(subtitle.first.second))));
         list.push_back(currentSubtitle);
     }
     return list;
@@ -1188,6 +1209,7 @@ const QJsonArray SubtitleModel::toJson()
 
 void SubtitleModel::copySubtitle(const QString &path, int ix, bool checkOverwrite, bool updateFilter)
 {
+    flushWorkFile();
     QFile srcFile(pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false));
     if (srcFile.exists()) {
         QFile prev(path);
@@ -1216,22 +1238,105 @@ void SubtitleModel::restoreTmpFile(int ix)
     m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
 }
 
-void SubtitleModel::jsontoSubtitle(const QJsonArray &data)
+void SubtitleModel::scheduleWorkFileUpdate()
 {
     int ix = pCore->currentDoc()->getSequenceProperty(m_timeline->uuid(), QStringLiteral("kdenlive:activeSubtitleIndex"), QStringLiteral("0")).toInt();
-    QString outFile = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false);
+    m_pendingWorkFile = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false);
+    m_workFileTimer.start();
+}
+
+bool SubtitleModel::flushWorkFile()
+{
+    m_workFileTimer.stop();
+    if (m_pendingWorkFile.isEmpty() || !m_timeline) {
+        return false;
+    }
+    const QString outFile = m_pendingWorkFile;
+    m_pendingWorkFile.clear();
     QString masterFile = m_subtitleFilter->get("av.filename");
     if (masterFile.isEmpty()) {
         m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
     }
-    int line = saveSubtitleData(data, outFile);
-    qDebug() << "Saving subtitle filter: " << outFile;
+    int line = writeWorkFile(outFile);
     if (line > 0) {
         m_subtitleFilter->set("av.filename", outFile.toUtf8().constData());
         m_timeline->tractor()->attach(*m_subtitleFilter.get());
     } else {
         m_timeline->tractor()->detach(*m_subtitleFilter.get());
     }
+    return true;
+}
+
+void SubtitleModel::cancelWorkFileUpdate()
+{
+    m_workFileTimer.stop();
+    m_pendingWorkFile.clear();
+}
+
+void SubtitleModel::writeAssHeader(QTextStream &out)
+{
+    out << QStringLiteral("[Script Info]\n; Script generated by Kdenlive %1\n").arg(KDENLIVE_VERSION);
+    for (const auto &entry : std::as_const(m_scriptInfo)) {
+        out << entry.first + ": " + entry.second + '\n';
+    }
+    out << '\n';
+
+    out << "[Kdenlive Extradata]\n";
+    out << "MaxLayer: " + QString::number(getMaxLayer()) + '\n';
+    QString defaultStyles;
+    for (const auto &style : std::as_const(m_defaultStyles)) {
+        defaultStyles += style + ',';
+    }
+    defaultStyles.chop(1);
+    out << "DefaultStyles: " + defaultStyles + '\n';
+
+    out << '\n';
+
+    out << QStringLiteral("[V4+ Styles]\nFormat: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, OutlineColour, BackColour, Bold, "
+                          "Italic, Underline, StrikeOut, "
+                          "ScaleX, ScaleY, Spacing, Angle, BorderStyle, Outline, Shadow, Alignment, MarginL, MarginR, MarginV, Encoding\n");
+    for (const auto &entry : std::as_const(m_subtitleStyles)) {
+        out << entry.second.toString(entry.first) << '\n';
+    }
+    out << '\n';
+
+    if (!fontSection.isEmpty()) out << fontSection << '\n';
+
+    out << QStringLiteral("[Events]\nFormat: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n");
+}
+
+int SubtitleModel::writeWorkFile(const QString &outFile)
+{
+    QReadLocker locker(&m_lock);
+    if (m_subtitleList.empty()) {
+        return 0;
+    }
+    QFile outF(outFile);
+    if (!outF.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write subtitle file" << outFile;
+        return 0;
+    }
+    // Events are written straight from the model, without going through their json representation
+    bool assFormat = outFile.endsWith(".ass");
+    QTextStream out(&outF);
+    if (assFormat) {
+        writeAssHeader(out);
+    }
+    int line = 0;
+    for (const auto &subtitle : m_subtitleList) {
+        line++;
+        if (assFormat) {
+            QString dialogue = subtitle.second.toString(subtitle.first.first, GenTime(subtitle.first.second));
+            dialogue.replace(QLatin1Char('\n'), QStringLiteral("\\N"));
+            out << dialogue << '\n';
+        } else {
+            QString startTimeStringSRT = SubtitleEvent::timeToString(GenTime(subtitle.first.second), 1);
+            QString endTimeStringSRT = SubtitleEvent::timeToString(subtitle.second.endTime(), 1);
+            out << line << "\n" << startTimeStringSRT << " --> " << endTimeStringSRT << "\n" << subtitle.second.text() << "\n" << '\n';
+        }
+    }
+    outF.close();
+    return line;
 }
 
 int SubtitleModel::saveSubtitleData(const QJsonArray &list, const QString &outFile)
@@ -1251,34 +1356,7 @@ int SubtitleModel::saveSubtitleData(const QJsonArray &list, const QString &outFi
     if (outF.open(QIODevice::WriteOnly)) {
         QTextStream out(&outF);
         if (assFormat) {
-            out << QStringLiteral("[Script Info]\n; Script generated by Kdenlive %1\n").arg(KDENLIVE_VERSION);
-            for (const auto &entry : std::as_const(m_scriptInfo)) {
-                out << entry.first + ": " + entry.second + '\n';
-            }
-            out << '\n';
-
-            out << "[Kdenlive Extradata]\n";
-            out << "MaxLayer: " + QString::number(getMaxLayer()) + '\n';
-            QString defaultStyles;
-            for (const auto &style : std::as_const(m_defaultStyles)) {
-                defaultStyles += style + ',';
-            }
-            defaultStyles.chop(1);
-            out << "DefaultStyles: " + defaultStyles + '\n';
-
-            out << '\n';
-
-            out << QStringLiteral("[V4+ Styles]\nFormat: Name, Fontname, Fontsize, PrimaryColour, SecondaryColour, OutlineColour, BackColour, Bold, "
-                                  "Italic, Underline, StrikeOut, "
-                                  "ScaleX, ScaleY, Spacing, Angle, BorderStyle, Outline, Shadow, Alignment, MarginL, MarginR, MarginV, Encoding\n");
-            for (const auto &entry : std::as_const(m_subtitleStyles)) {
-                out << entry.second.toString(entry.first) << '\n';
-            }
-            out << '\n';
-
-            if (!fontSection.isEmpty()) out << fontSection << '\n';
-
-            out << QStringLiteral("[Events]\nFormat: Layer, Start, End, Style, Name, MarginL, MarginR, MarginV, Effect, Text\n");
+            writeAssHeader(out);
         }
         for (const auto &entry : std::as_const(list)) {
             if (!entry.isObject()) {
@@ -1333,7 +1411,7 @@ int SubtitleModel::getRowForId(int id) const
 int SubtitleModel::getSubtitlePlaytime(int id) const
 {
     std::pair<int, GenTime> startPos = m_allSubtitles.at(id);
-    return m_subtitleList.at(startPos).endTime().frames(pCore->getCurrentFps()) - startPos.second.frames(pCore->getCurrentFps());
+    return m_subtitleList.at(subtitleKey(startPos)).endTime().frames(pCore->getCurrentFps()) - startPos.second.frames(pCore->getCurrentFps());
 }
 
 GenTime SubtitleModel::getSubtitlePosition(int sid) const
@@ -1351,13 +1429,13 @@ int SubtitleModel::getSubtitleFakePosition(int sid) const
 int SubtitleModel::getSubtitleEnd(int id) const
 {
     std::pair<int, GenTime> startPos = m_allSubtitles.at(id);
-    return m_subtitleList.at(startPos).endTime().frames(pCore->getCurrentFps());
+    return m_subtitleList.at(subtitleKey(startPos)).endTime().frames(pCore->getCurrentFps());
 }
 
 QPair<int, int> SubtitleModel::getInOut(int sid) const
 {
     std::pair<int, GenTime> startPos = m_allSubtitles.at(sid);
-    return {startPos.second.frames(pCore->getCurrentFps()), m_subtitleList.at(startPos).endTime().frames(pCore->getCurrentFps())};
+    return {startPos.second.frames(pCore->getCurrentFps()), m_subtitleList.at(subtitleKey(startPos)).endTime().frames(pCore->getCurrentFps())};
 }
 
 void SubtitleModel::setSelected(int id, bool select)
@@ -1472,12 +1550,12 @@ void SubtitleModel::allSnaps(std::vector<int> &snaps)
 QDomElement SubtitleModel::toXml(int sid, QDomDocument &document)
 {
     std::pair<int, GenTime> startPos = m_allSubtitles.at(sid);
-    GenTime endPos = m_subtitleList.at(startPos).endTime();
+    GenTime endPos = m_subtitleList.at(subtitleKey(startPos)).endTime();
     QDomElement container = document.createElement(QStringLiteral("subtitle"));
     container.setAttribute(QStringLiteral("layer"), startPos.first);
     container.setAttribute(QStringLiteral("in"), startPos.second.frames(pCore->getCurrentFps()));
     container.setAttribute(QStringLiteral("out"), endPos.frames(pCore->getCurrentFps()));
-    container.setAttribute(QStringLiteral("event_text"), m_subtitleList.at(startPos).toString(startPos.first, startPos.second));
+    container.setAttribute(QStringLiteral("event_text"), m_subtitleList.at(subtitleKey(startPos)).toString(startPos.first, startPos.second));
     return container;
 }
 
@@ -1487,7 +1565,7 @@ bool SubtitleModel::isBlankAt(int layer, int pos) const
     for (const auto &subtitles : m_subtitleList) {
         // if layer is -1, we check all layers
         if (layer == -1 || subtitles.first.first == layer) {
-            if (subtitles.first.second > matchPos) {
+            if (GenTime(subtitles.first.second) > matchPos) {
                 continue;
             }
             if (subtitles.second.endTime() > matchPos) {
@@ -1505,8 +1583,8 @@ int SubtitleModel::getBlankEnd(int layer, int pos) const
     GenTime min;
     for (const auto &subtitles : m_subtitleList) {
         // if layer is -1, we check all layers
-        if ((layer == -1 || subtitles.first.first == layer) && subtitles.first.second > matchPos && (min == GenTime() || subtitles.first.second < min)) {
-            min = subtitles.first.second;
+        if ((layer == -1 || subtitles.first.first == layer) && GenTime(subtitles.first.second) > matchPos && (min == GenTime() || GenTime(subtitles.first.second) < min)) {
+            min = GenTime(subtitles.first.second);
             found = true;
         }
     }
@@ -1729,16 +1807,16 @@ int SubtitleModel::getMaxLayer() const
 
 void SubtitleModel::requestDeleteLayer(int layer)
 {
-    std::map<std::pair<int, GenTime>, SubtitleEvent> oldSubtitles;
+    std::map<std::pair<int, TickTime>, SubtitleEvent> oldSubtitles;
     for (auto it = m_subtitleList.begin(); it != m_subtitleList.end(); ++it) {
         if (it->first.first == layer) {
             oldSubtitles[it->first] = it->second;
         }
     }
 
-    std::map<std::pair<int, GenTime>, int> oldIds;
+    std::map<std::pair<int, TickTime>, int> oldIds;
     for (const auto &sub : oldSubtitles) {
-        oldIds[sub.first] = getIdForStartPos(sub.first.first, sub.first.second);
+        oldIds[sub.first] = getIdForStartPos(sub.first.first, GenTime(sub.first.second));
     }
 
     Fun redo = [this, layer]() {
@@ -1750,7 +1828,7 @@ void SubtitleModel::requestDeleteLayer(int layer)
         createLayer(layer);
         // Re-add all subtitles
         for (const auto &sub : oldSubtitles) {
-            addSubtitle(oldIds.at(sub.first), sub.first, sub.second);
+            addSubtitle(oldIds.at(sub.first), subtitleStart(sub.first), sub.second);
         }
         Q_EMIT modelChanged();
         return true;
@@ -1780,7 +1858,7 @@ void SubtitleModel::requestCreateLayer(int copiedLayer, int position)
         auto subs = m_subtitleList;
         for (const auto &sub : subs) {
             if (sub.first.first == copiedLayer) {
-                addSubtitle({position, sub.first.second}, sub.second, undo, redo);
+                addSubtitle({position, GenTime(sub.first.second)}, sub.second, undo, redo);
             }
         }
     }
@@ -1899,7 +1977,8 @@ int SubtitleModel::createNewSubtitle(const QString subtitleName, int id)
     const QString newPath = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), maxIx, true);
     m_subtitlesList.insert({maxIx, newName}, newPath);
     if (id >= 0) {
-        // Duplicate existing subtitle
+        // Duplicate existing subtitle, including its pending changes
+        flushWorkFile();
         QString source = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), id, false);
         if (!QFile::exists(source)) {
             source = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), id, true);
@@ -1928,6 +2007,10 @@ bool SubtitleModel::deleteSubtitle(int ix)
         // Delete subtitle files
         const QString workPath = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), matchingItem.first, false);
         const QString finalPath = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), matchingItem.first, true);
+        if (m_pendingWorkFile == workPath) {
+            // Don't write the deleted file back
+            cancelWorkFileUpdate();
+        }
         QFile::remove(workPath);
         QFile::remove(finalPath);
         // Remove entry from our subtitles list
@@ -1972,6 +2055,8 @@ void SubtitleModel::activateSubtitle(int ix)
     // QStringLiteral("0")).toInt(); if (currentIx == ix) {
     //     return;
     // }
+    // Save pending changes of the previous subtitle before switching
+    flushWorkFile();
     const QString workPath = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, false);
     const QString finalPath = pCore->currentDoc()->subTitlePath(m_timeline->uuid(), ix, true);
     if (!QFile::exists(workPath) && QFile::exists(finalPath)) {
@@ -2010,6 +2095,7 @@ void SubtitleModel::registerSubtitle(int id, std::pair<int, GenTime> startpos, b
 {
     Q_ASSERT(m_allSubtitles.count(id) == 0);
     m_allSubtitles.emplace(id, startpos);
+    m_subtitleRows.insert(id);
     if (!temporary) {
         m_timeline->m_groups->createGroupItem(id);
     }
@@ -2022,6 +2108,7 @@ void SubtitleModel::deregisterSubtitle(int id, bool temporary)
         m_timeline->requestClearSelection(true);
     }
     m_allSubtitles.erase(id);
+    m_subtitleRows.remove(id);
     if (!temporary) {
         m_timeline->m_groups->destructGroupItem(id);
     }
@@ -2029,7 +2116,8 @@ void SubtitleModel::deregisterSubtitle(int id, bool temporary)
 
 int SubtitleModel::positionForIndex(int id) const
 {
-    return int(std::distance(m_allSubtitles.begin(), m_allSubtitles.find(id)));
+    const int row = m_subtitleRows.row(id);
+    return row < 0 ? m_subtitleRows.size() : row;
 }
 
 bool SubtitleModel::hasSubtitle(int id) const
@@ -2049,21 +2137,16 @@ GenTime SubtitleModel::getPosition(int id) const
 
 int SubtitleModel::getSubtitleIndex(int subId) const
 {
-    if (m_allSubtitles.count(subId) == 0) {
-        return -1;
-    }
-    auto it = m_allSubtitles.find(subId);
-    return int(std::distance(m_allSubtitles.begin(), it));
+    return m_subtitleRows.row(subId);
 }
 
 std::pair<int, std::pair<int, GenTime>> SubtitleModel::getSubtitleIdFromIndex(int index) const
 {
-    if (index >= static_cast<int>(m_allSubtitles.size())) {
+    const int id = m_subtitleRows.at(index);
+    if (id < 0) {
         return {-1, {-1, GenTime()}};
     }
-    auto it = m_allSubtitles.begin();
-    std::advance(it, index);
-    return {it->first, it->second};
+    return {id, m_allSubtitles.at(id)};
 }
 
 int SubtitleModel::getSubtitleIdByPosition(int layer, int pos)
@@ -2125,7 +2208,7 @@ std::unordered_set<int> SubtitleModel::getAllSubIds() const
 bool SubtitleModel::getIsDialogue(int id) const
 {
     if (m_allSubtitles.find(id) == m_allSubtitles.end()) return false;
-    return m_subtitleList.at(m_allSubtitles.at(id)).isDialogue();
+    return m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).isDialogue();
 }
 
 void SubtitleModel::setIsDialogue(int id, bool isDialogue, bool refreshModel)
@@ -2136,7 +2219,7 @@ void SubtitleModel::setIsDialogue(int id, bool isDialogue, bool refreshModel)
         return;
     }
     Fun local_redo = [this, id, isDialogue, refreshModel]() {
-        m_subtitleList.at(m_allSubtitles.at(id)).setIsDialogue(isDialogue);
+        m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).setIsDialogue(isDialogue);
         int row = getSubtitleIndex(id);
         Q_EMIT dataChanged(index(row), index(row), {IsDialogueRole});
         if (refreshModel) Q_EMIT modelChanged();
@@ -2144,7 +2227,7 @@ void SubtitleModel::setIsDialogue(int id, bool isDialogue, bool refreshModel)
         return true;
     };
     Fun local_undo = [this, id, oldIsDialogue, refreshModel]() {
-        m_subtitleList.at(m_allSubtitles.at(id)).setIsDialogue(oldIsDialogue);
+        m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).setIsDialogue(oldIsDialogue);
         int row = getSubtitleIndex(id);
         Q_EMIT dataChanged(index(row), index(row), {IsDialogueRole});
         if (refreshModel) Q_EMIT modelChanged();
@@ -2158,12 +2241,12 @@ void SubtitleModel::setIsDialogue(int id, bool isDialogue, bool refreshModel)
 QString SubtitleModel::getStyleName(int id) const
 {
     if (m_allSubtitles.find(id) == m_allSubtitles.end()) return QString();
-    return m_subtitleList.at(m_allSubtitles.at(id)).styleName();
+    return m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).styleName();
 }
 
 void SubtitleModel::setStyleName(const int id, const QString &style, bool refreshModel)
 {
-    auto sub = m_subtitleList.find(m_allSubtitles.at(id));
+    auto sub = m_subtitleList.find(subtitleKey(m_allSubtitles.at(id)));
     if (sub == m_subtitleList.end() || style == sub->second.styleName()) {
         return;
     }
@@ -2194,7 +2277,7 @@ void SubtitleModel::setStyleName(const int id, const QString &style, bool refres
 QString SubtitleModel::getName(int id) const
 {
     if (m_allSubtitles.find(id) == m_allSubtitles.end()) return QString();
-    return m_subtitleList.at(m_allSubtitles.at(id)).name();
+    return m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).name();
 }
 
 void SubtitleModel::setName(int id, const QString &name, bool refreshModel)
@@ -2205,14 +2288,14 @@ void SubtitleModel::setName(int id, const QString &name, bool refreshModel)
         return;
     }
     Fun local_redo = [this, id, name, refreshModel]() {
-        m_subtitleList.at(m_allSubtitles.at(id)).setName(name);
+        m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).setName(name);
         int row = getSubtitleIndex(id);
         Q_EMIT dataChanged(index(row), index(row), {NameRole});
         if (refreshModel) Q_EMIT modelChanged();
         return true;
     };
     Fun local_undo = [this, id, oldName, refreshModel]() {
-        m_subtitleList.at(m_allSubtitles.at(id)).setName(oldName);
+        m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).setName(oldName);
         int row = getSubtitleIndex(id);
         Q_EMIT dataChanged(index(row), index(row), {NameRole});
         if (refreshModel) Q_EMIT modelChanged();
@@ -2225,7 +2308,7 @@ void SubtitleModel::setName(int id, const QString &name, bool refreshModel)
 int SubtitleModel::getMarginL(int id) const
 {
     if (m_allSubtitles.find(id) == m_allSubtitles.end()) return 0;
-    return m_subtitleList.at(m_allSubtitles.at(id)).marginL();
+    return m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).marginL();
 }
 
 void SubtitleModel::setMarginL(int id, int marginL, bool refreshModel)
@@ -2236,7 +2319,7 @@ void SubtitleModel::setMarginL(int id, int marginL, bool refreshModel)
         return;
     }
     Fun local_redo = [this, id, marginL, refreshModel]() {
-        m_subtitleList.at(m_allSubtitles.at(id)).setMarginL(marginL);
+        m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).setMarginL(marginL);
         int row = getSubtitleIndex(id);
         Q_EMIT dataChanged(index(row), index(row), {MarginLRole});
         if (refreshModel) Q_EMIT modelChanged();
@@ -2244,7 +2327,7 @@ void SubtitleModel::setMarginL(int id, int marginL, bool refreshModel)
         return true;
     };
     Fun local_undo = [this, id, oldMarginL, refreshModel]() {
-        m_subtitleList.at(m_allSubtitles.at(id)).setMarginL(oldMarginL);
+        m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).setMarginL(oldMarginL);
         int row = getSubtitleIndex(id);
         Q_EMIT dataChanged(index(row), index(row), {MarginLRole});
         if (refreshModel) Q_EMIT modelChanged();
@@ -2258,7 +2341,7 @@ void SubtitleModel::setMarginL(int id, int marginL, bool refreshModel)
 int SubtitleModel::getMarginR(int id) const
 {
     if (m_allSubtitles.find(id) == m_allSubtitles.end()) return 0;
-    return m_subtitleList.at(m_allSubtitles.at(id)).marginR();
+    return m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).marginR();
 }
 
 void SubtitleModel::setMarginR(int id, int marginR, bool refreshModel)
@@ -2269,7 +2352,7 @@ void SubtitleModel::setMarginR(int id, int marginR, bool refreshModel)
         return;
     }
     Fun local_redo = [this, id, marginR, refreshModel]() {
-        m_subtitleList.at(m_allSubtitles.at(id)).setMarginR(marginR);
+        m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).setMarginR(marginR);
         int row = getSubtitleIndex(id);
         Q_EMIT dataChanged(index(row), index(row), {MarginRRole});
         if (refreshModel) Q_EMIT modelChanged();
@@ -2277,7 +2360,7 @@ void SubtitleModel::setMarginR(int id, int marginR, bool refreshModel)
         return true;
     };
     Fun local_undo = [this, id, oldMarginR, refreshModel]() {
-        m_subtitleList.at(m_allSubtitles.at(id)).setMarginR(oldMarginR);
+        m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).setMarginR(oldMarginR);
         int row = getSubtitleIndex(id);
         Q_EMIT dataChanged(index(row), index(row), {MarginRRole});
         if (refreshModel) Q_EMIT modelChanged();
@@ -2291,7 +2374,7 @@ void SubtitleModel::setMarginR(int id, int marginR, bool refreshModel)
 int SubtitleModel::getMarginV(int id) const
 {
     if (m_allSubtitles.find(id) == m_allSubtitles.end()) return 0;
-    return m_subtitleList.at(m_allSubtitles.at(id)).marginV();
+    return m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).marginV();
 }
 
 void SubtitleModel::setMarginV(int id, int marginV, bool refreshModel)
@@ -2302,7 +2385,7 @@ void SubtitleModel::setMarginV(int id, int marginV, bool refreshModel)
         return;
     }
     Fun local_redo = [this, id, marginV, refreshModel]() {
-        m_subtitleList.at(m_allSubtitles.at(id)).setMarginV(marginV);
+        m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).setMarginV(marginV);
         int row = getSubtitleIndex(id);
         Q_EMIT dataChanged(index(row), index(row), {MarginVRole});
         if (refreshModel) Q_EMIT modelChanged();
@@ -2310,7 +2393,7 @@ void SubtitleModel::setMarginV(int id, int marginV, bool refreshModel)
         return true;
     };
     Fun local_undo = [this, id, oldMarginV, refreshModel]() {
-        m_subtitleList.at(m_allSubtitles.at(id)).setMarginV(oldMarginV);
+        m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).setMarginV(oldMarginV);
         int row = getSubtitleIndex(id);
         Q_EMIT dataChanged(index(row), index(row), {MarginVRole});
         if (refreshModel) Q_EMIT modelChanged();
@@ -2324,7 +2407,7 @@ void SubtitleModel::setMarginV(int id, int marginV, bool refreshModel)
 QString SubtitleModel::getEffects(int id) const
 {
     if (m_allSubtitles.find(id) == m_allSubtitles.end()) return QString();
-    return m_subtitleList.at(m_allSubtitles.at(id)).effect();
+    return m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).effect();
 }
 
 void SubtitleModel::setEffects(int id, const QString &effects, bool refreshModel)
@@ -2335,7 +2418,7 @@ void SubtitleModel::setEffects(int id, const QString &effects, bool refreshModel
         return;
     }
     Fun local_redo = [this, id, effects, refreshModel]() {
-        m_subtitleList.at(m_allSubtitles.at(id)).setEffect(effects);
+        m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).setEffect(effects);
         int row = getSubtitleIndex(id);
         Q_EMIT dataChanged(index(row), index(row), {EffectRole});
         if (refreshModel) Q_EMIT modelChanged();
@@ -2343,7 +2426,7 @@ void SubtitleModel::setEffects(int id, const QString &effects, bool refreshModel
         return true;
     };
     Fun local_undo = [this, id, oldEffects, refreshModel]() {
-        m_subtitleList.at(m_allSubtitles.at(id)).setEffect(oldEffects);
+        m_subtitleList.at(subtitleKey(m_allSubtitles.at(id))).setEffect(oldEffects);
         int row = getSubtitleIndex(id);
         Q_EMIT dataChanged(index(row), index(row), {EffectRole});
         if (refreshModel) Q_EMIT modelChanged();
@@ -9,9 +9,12 @@
 #include "definitions.h"
 #include "undohelper.hpp"
 #include "utils/gentime.h"
+#include "utils/rowindex.hpp"
+#include "utils/ticktime.h"
 
 #include <QAbstractListModel>
 #include <QReadWriteLock>
+#include <QTimer>
 
 #include <array>
 #include <map>
@@ -24,6 +27,7 @@ class DocUndoStack;
 class SnapInterface;
 class AssetParameterModel;
 class TimelineItemModel;
+class QTextStream;
 
 /** @class SubtitleModel
     @brief This class is the model for a list of subtitles.
@@ -288,8 +292,11 @@ public Q_SLOTS:
     /** @brief Function that parses through a subtitle file */
     void parseSubtitle(const QString &workPath);
 
-    /** @brief Import model to a temporary subtitle file to which the Subtitle effect is applied*/
-    void jsontoSubtitle(const QJsonArray &data);
+    /** @brief Write pending changes to the working subtitle file to which the Subtitle effect is applied.
+     *  @return true if the file was rewritten */
+    bool flushWorkFile();
+    /** @brief Drop a pending update of the working subtitle file, called before deleting it */
+    void cancelWorkFileUpdate();
     /** @brief Update a subtitle text*/
     bool setText(int id, const QString &text);
 
@@ -297,13 +304,15 @@ private:
     std::shared_ptr<TimelineItemModel> m_timeline;
     std::weak_ptr<DocUndoStack> m_undoStack;
     /** @brief A list of subtitles as: layer, start time, events */
-    std::map<std::pair<int, GenTime>, SubtitleEvent> m_subtitleList;
+    std::map<std::pair<int, TickTime>, SubtitleEvent> m_subtitleList;
     /** @brief A list of all available subtitle files for this timeline
      *  in the form: ({id, name}, path) where id for a subtitle never changes
      */
     QMap<std::pair<int, QString>, QString> m_subtitlesList;
     /** @brief A list of subtitles as: item id, layer, start time */
     std::map<int, std::pair<int, GenTime>> m_allSubtitles;
+    /** @brief Rows of the subtitles in the model, mirroring the ids of m_allSubtitles */
+    RowIndex m_subtitleRows;
     /** @brief The max layer in the subtitle model */
     int m_maxLayer{0};
     /** @brief Default styles for subtitle layers */
@@ -325,6 +334,10 @@ private:
     std::vector<std::weak_ptr<SnapInterface>> m_regSnaps;
     mutable QReadWriteLock m_lock;
     std::unique_ptr<Mlt::Filter> m_subtitleFilter;
+    /** @brief Debounces the updates of the working subtitle file */
+    QTimer m_workFileTimer;
+    /** @brief Working file waiting for an update, empty if it is up to date */
+    QString m_pendingWorkFile;
     QVector<int> m_selected;
     QVector<int> m_grabbedIds;
     int m_activeSubLayer{0};
@@ -342,10 +355,22 @@ protected:
     void removeSnapPoint(GenTime startpos);
     /** @brief Connect changes in model with signal */
     void setup();
+    /** @brief Mark the working subtitle file as outdated, it is rewritten once edits pause */
+    void scheduleWorkFileUpdate();
+    /** @brief Write the subtitle events to a file, returns the number of events written */
+    int writeWorkFile(const QString &outFile);
+    void writeAssHeader(QTextStream &out);
     void registerSubtitle(int id, std::pair<int, GenTime> startpos, bool temporary = false);
     void deregisterSubtitle(int id, bool temporary = false);
     /** @brief Returns the index for a subtitle's id (it's position in the list
      */
     int positionForIndex(int id) const;
+    /** @brief The key of a subtitle in m_subtitleList, from its layer and start time.
+     *  The start is snapped to the tick of its frame, so that two subtitles cannot start in the same frame
+     *  and a start time slightly off because of rounding still finds its subtitle */
+    static std::pair<int, TickTime> subtitleKey(int layer, GenTime start);
+    static std::pair<int, TickTime> subtitleKey(const std::pair<int, GenTime> &start);
+    /** @brief The layer and start time of a subtitle from its key in m_subtitleList */
+    static std::pair<int, GenTime> subtitleStart(const std::pair<int, TickTime> &key);
 };
 Q_DECLARE_METATYPE(SubtitleModel *)
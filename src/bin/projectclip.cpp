@@ -1637,21 +1637,27 @@ const QString ProjectClip::hashForThumbs()
     return clipHash;
 }
 
-const QByteArray ProjectClip::getFolderHash(const QDir &dir, QString fileName)
+const QString ProjectClip::folderHashData(const QDir &dir)
 {
     QStringList files = dir.entryList(QDir::Files);
-    fileName.append(files.join(QLatin1Char(',')));
+    QString data = files.join(QLatin1Char(','));
     // Include file hash info in case we have several folders with same file names (can happen for image sequences)
     if (!files.isEmpty()) {
         QPair<QByteArray, qint64> hashData = calculateHash(dir.absoluteFilePath(files.first()));
-        fileName.append(hashData.first);
-        fileName.append(QString::number(hashData.second));
+        data.append(hashData.first);
+        data.append(QString::number(hashData.second));
         if (files.size() > 1) {
             hashData = calculateHash(dir.absoluteFilePath(files.at(files.size() / 2)));
-            fileName.append(hashData.first);
-            fileName.append(QString::number(hashData.second));
+            data.append(hashData.first);
+            data.append(QString::number(hashData.second));
         }
     }
+    return data;
+}
+
+const QByteArray ProjectClip::getFolderHash(const QDir &dir, QString fileName)
+{
+    fileName.append(folderHashData(dir));
     QByteArray fileData = fileName.toUtf8();
     return QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
 }
@@ -2138,6 +2144,8 @@ void ProjectClip::discardAudioThumb()
     const QList<int> streams = m_audioInfo->streams().keys();
     // Delete audio thumbnail data
     for (const int &st : streams) {
+        // Release the levels first, they may be memory mapped from the cache file
+        m_masterProducer->set(QStringLiteral("_kdenlive:audio%1").arg(st).toUtf8().constData(), static_cast<void *>(nullptr), 0);
         audioThumbPath = getAudioThumbPath(st);
         if (!audioThumbPath.isEmpty()) {
             QFile::remove(audioThumbPath);
@@ -2768,11 +2776,11 @@ int16_t ProjectClip::getAudioMax(const int streamIdx) const
     return std::numeric_limits<int16_t>::max();
 }
 
-QVector<int16_t> ProjectClip::audioFrameCache(const int streamIdx) const
+AudioLevelsPyramid ProjectClip::audioFrameCache(const int streamIdx) const
 {
     const QString key = QStringLiteral("_kdenlive:audio%1").arg(streamIdx);
     if (m_masterProducer->get_data(key.toUtf8().constData())) {
-        const auto audioData = *static_cast<QVector<int16_t> *>(m_masterProducer->get_data(key.toUtf8().constData()));
+        const auto audioData = *static_cast<AudioLevelsPyramid *>(m_masterProducer->get_data(key.toUtf8().constData()));
         return audioData;
     }
     qWarning() << "Audio levels not found for bin" << m_binId;
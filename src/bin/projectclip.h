@@ -10,6 +10,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include "abstractprojectitem.h"
 #include "definitions.h"
+#include "jobs/audiolevels/audiolevelspyramid.h"
 #include "mltcontroller/clipcontroller.h"
 #include "timeline2/model/timelinemodel.hpp"
 
@@ -247,7 +248,7 @@ public:
 
     /** @brief Return audio cache for a stream
      */
-    QVector<int16_t> audioFrameCache(int streamIdx) const;
+    AudioLevelsPyramid audioFrameCache(int streamIdx) const;
     /** @brief Return FFmpeg's audio stream index for an MLT audio stream index
      */
     int getAudioStreamFfmpegIndex(int mltStream);
@@ -267,6 +268,8 @@ public:
     QStringList getAudioStreamEffect(int streamIndex) const override;
     /** @brief Calculate the folder's hash (based on the files it contains). */
     static const QByteArray getFolderHash(const QDir &dir, QString fileName);
+    /** @brief The part of the folder's hash data that does not depend on the file name, see getFolderHash(). */
+    static const QString folderHashData(const QDir &dir);
     /** @brief Check if the clip is included in timeline and reset its occurrences on producer reload. */
     void updateTimelineOnReload();
     /** @brief Get the timecode of the first frame (record time)
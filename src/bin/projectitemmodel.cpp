@@ -513,7 +513,7 @@ const QVector<MaskInfo> ProjectItemModel::getClipMasks(const QString &binId) con
     return {};
 }
 
-const QVector<int16_t> ProjectItemModel::getAudioLevelsByBinID(const QString &binId, int stream)
+const AudioLevelsPyramid ProjectItemModel::getAudioLevelsByBinID(const QString &binId, int stream)
 {
     READ_LOCK();
     auto search = m_allClipItems.find(binId.toInt());
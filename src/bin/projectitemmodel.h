@@ -12,6 +12,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "abstractmodel/abstracttreemodel.hpp"
 #include "bin/abstractprojectitem.h"
 #include "definitions.h"
+#include "jobs/audiolevels/audiolevelspyramid.h"
 #include "undohelper.hpp"
 #include <QDomElement>
 #include <QFileInfo>
@@ -67,7 +68,7 @@ public:
     /** @brief Returns existing masks for a clip */
     const QVector<MaskInfo> getClipMasks(const QString &binId) const;
     /** @brief Returns audio levels for a clip from its id */
-    const QVector<int16_t> getAudioLevelsByBinID(const QString &binId, int stream);
+    const AudioLevelsPyramid getAudioLevelsByBinID(const QString &binId, int stream);
     int16_t getAudioMaxLevel(const QString &binId, int stream);
 
     /** @brief Returns a list of clips using the given url */
@@ -30,6 +30,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "timeline2/model/timelineitemmodel.hpp"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
+#include "utils/cachemanager.hpp"
 #include <mlt++/MltRepository.h>
 
 #include <KIO/OpenFileManagerWindowJob>
@@ -1243,6 +1244,8 @@ void Core::addActionToCollection(const QString &name, QAction *action)
 void Core::clean()
 {
     m_self.reset();
+    // Save the cache index once no task can write to the cache anymore
+    CacheManager::shutdown();
 }
 
 void Core::startMediaCapture(const QUuid &uuid, int tid, bool checkAudio, bool checkVideo)
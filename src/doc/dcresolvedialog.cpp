@@ -63,6 +63,7 @@ DCResolveDialog::DCResolveDialog(std::vector<DocumentChecker::DocumentResource>
     connect(m_model.get(), &DocumentCheckerTreeModel::searchDone, this, [&]() {
         setEnableChangeItems(true);
         progressBox->hide();
+        checkStatus();
         infoLabel->setText(i18n("Recursive search: done in %1 s", QString::number(m_searchTimer.elapsed() / 1000., 'f', 2)));
         infoLabel->setMessageType(KMessageWidget::MessageType::Positive);
         infoLabel->animatedShow();
@@ -240,7 +241,6 @@ void DCResolveDialog::slotRecursiveSearch()
         return;
     }
     m_model->slotSearchRecursively(newpath);
-    checkStatus();
 }
 
 void DCResolveDialog::checkStatus()
@@ -9,13 +9,13 @@
 #include "dcresolvedialog.h"
 #include "effects/effectsrepository.hpp"
 #include "kdenlivesettings.h"
+#include "mediasearchindex.h"
 #include "titler/titlewidget.h"
 #include "transitions/transitionsrepository.hpp"
 #include "xml/xml.hpp"
 
 #include <KLocalizedString>
 
-#include <QCryptographicHash>
 #include <QStandardPaths>
 
 QDebug operator<<(QDebug qd, const DocumentChecker::DocumentResource &item)
@@ -1179,148 +1179,29 @@ QString DocumentChecker::fixLumaPath(const QString &file)
     return QString();
 }
 
-QString DocumentChecker::searchLuma(const QDir &dir, const QString &file)
+QString DocumentChecker::searchLuma(const MediaSearchIndex &index, const QString &file)
 {
     // Try in user's chosen folder
     QString result = fixLumaPath(file);
-    return result.isEmpty() ? searchPathRecursively(dir, QFileInfo(file).fileName()) : result;
+    return result.isEmpty() ? searchPathRecursively(index, QFileInfo(file).fileName()) : result;
 }
 
-QString DocumentChecker::searchPathRecursively(const QDir &dir, const QString &fileName, ClipType::ProducerType type)
+QString DocumentChecker::searchPathRecursively(const MediaSearchIndex &index, const QString &fileName, ClipType::ProducerType type)
 {
-    QString foundFileName;
-    bool patternSlideshow = true;
-    QDir searchDir(dir);
-    QStringList filesAndDirs;
-    qApp->processEvents();
-    /*if (m_abortSearch) {
-        return QString();
-    }*/
-    if (type == ClipType::SlideShow) {
-        if (fileName.contains(QLatin1Char('%'))) {
-            searchDir.setNameFilters({fileName.section(QLatin1Char('%'), 0, -2) + QLatin1Char('*')});
-            filesAndDirs = searchDir.entryList(QDir::Files | QDir::Readable);
-
-        } else {
-            patternSlideshow = false;
-            QString slideDirName = QFileInfo(fileName).dir().dirName();
-            searchDir.setNameFilters({slideDirName});
-            filesAndDirs = searchDir.entryList(QDir::Dirs | QDir::Readable);
-        }
-    } else {
-        searchDir.setNameFilters({fileName});
-        filesAndDirs = searchDir.entryList(QDir::Files | QDir::Readable);
-    }
-    if (!filesAndDirs.isEmpty()) {
-        // File Found
-        if (type == ClipType::SlideShow) {
-            if (patternSlideshow) {
-                return searchDir.absoluteFilePath(fileName);
-            } else {
-                // mime type slideshow
-                searchDir.cd(filesAndDirs.first());
-                return searchDir.absoluteFilePath(QFileInfo(fileName).fileName());
-            }
-        } else {
-            return searchDir.absoluteFilePath(filesAndDirs.first());
-        }
-    }
-    searchDir.setNameFilters(QStringList());
-    filesAndDirs = searchDir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchPathRecursively(searchDir.absoluteFilePath(filesAndDirs.at(i)), fileName, type);
-        if (!foundFileName.isEmpty()) {
-            break;
-        }
-    }
-    return foundFileName;
+    return index.findPath(fileName, type);
 }
 
-QString DocumentChecker::searchDirRecursively(const QDir &dir, const QString &matchHash, const QString &fullName)
+QString DocumentChecker::searchDirRecursively(const MediaSearchIndex &index, const QString &matchHash, const QString &fullName)
 {
-    qApp->processEvents();
-    /*if (m_abortSearch) {
-        return QString();
-    }*/
-    // Q_EMIT showScanning(i18n("Scanning %1", dir.absolutePath()));
-    QString fileName = QFileInfo(fullName).fileName();
-    // Check main dir
-    QString fileHash = ProjectClip::getFolderHash(dir, fileName).toHex();
-    if (fileHash == matchHash) {
-        return dir.absoluteFilePath(fileName);
-    }
-    // Search subfolders
-    const QStringList subDirs = dir.entryList(QDir::AllDirs | QDir::NoDot | QDir::NoDotDot);
-    for (const QString &sub : subDirs) {
-        QDir subFolder(dir.absoluteFilePath(sub));
-        fileHash = ProjectClip::getFolderHash(subFolder, fileName).toHex();
-        if (fileHash == matchHash) {
-            return subFolder.absoluteFilePath(fileName);
-        }
-    }
-    /*if (m_abortSearch) {
-        return QString();
-    }*/
-    // Search inside subfolders
-    for (const QString &sub : subDirs) {
-        QDir subFolder(dir.absoluteFilePath(sub));
-        const QStringList subSubDirs = subFolder.entryList(QDir::AllDirs | QDir::NoDot | QDir::NoDotDot);
-        for (const QString &subsub : subSubDirs) {
-            QDir subDir(subFolder.absoluteFilePath(subsub));
-            QString result = searchDirRecursively(subDir, matchHash, fullName);
-            if (!result.isEmpty()) {
-                return result;
-            }
-        }
-    }
-    return QString();
+    return index.findFolders({{matchHash, fullName}}).constFirst();
 }
 
-QString DocumentChecker::searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash, const QString &fileName)
+QString DocumentChecker::searchFileRecursively(const MediaSearchIndex &index, const QString &matchSize, const QString &matchHash, const QString &fileName)
 {
     if (matchSize.isEmpty() && matchHash.isEmpty()) {
-        return searchPathRecursively(dir, QUrl::fromLocalFile(fileName).fileName());
-    }
-    QString foundFileName;
-    QByteArray fileData;
-    QByteArray fileHash;
-    QStringList filesAndDirs = dir.entryList(QDir::Files | QDir::Readable);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        qApp->processEvents();
-        /*if (m_abortSearch) {
-            return QString();
-        }*/
-        QFile file(dir.absoluteFilePath(filesAndDirs.at(i)));
-        if (QString::number(file.size()) == matchSize) {
-            if (file.open(QIODevice::ReadOnly)) {
-                /*
-                 * 1 MB = 1 second per 450 files (or faster)
-                 * 10 MB = 9 seconds per 450 files (or faster)
-                 */
-                if (file.size() > 1000000 * 2) {
-                    fileData = file.read(1000000);
-                    if (file.seek(file.size() - 1000000)) {
-                        fileData.append(file.readAll());
-                    }
-                } else {
-                    fileData = file.readAll();
-                }
-                file.close();
-                fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-                if (QString::fromLatin1(fileHash.toHex()) == matchHash) {
-                    return file.fileName();
-                }
-            }
-        }
-    }
-    filesAndDirs = dir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchFileRecursively(dir.absoluteFilePath(filesAndDirs.at(i)), matchSize, matchHash, fileName);
-        if (!foundFileName.isEmpty()) {
-            break;
-        }
+        return index.findPath(QUrl::fromLocalFile(fileName).fileName());
     }
-    return foundFileName;
+    return index.findFiles({{matchSize, matchHash}}).constFirst();
 }
 
 QString DocumentChecker::ensureAbsolutePath(QString filepath)
@@ -13,6 +13,8 @@
 #include <QDomElement>
 #include <QUrl>
 
+class MediaSearchIndex;
+
 class DocumentChecker : public QObject
 {
     Q_OBJECT
@@ -43,15 +45,16 @@ public:
     bool hasErrorInProject();
     static QString fixLutFile(const QString &file);
     static QString fixLumaPath(const QString &file);
-    static QString searchLuma(const QDir &dir, const QString &file);
+    static QString searchLuma(const MediaSearchIndex &index, const QString &file);
 
     static QString readableNameForClipType(ClipType::ProducerType type);
     static QString readableNameForMissingType(MissingType type);
     static QString readableNameForMissingStatus(MissingStatus type);
 
-    static QString searchPathRecursively(const QDir &dir, const QString &fileName, ClipType::ProducerType type = ClipType::Unknown);
-    static QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash, const QString &fileName);
-    static QString searchDirRecursively(const QDir &dir, const QString &matchHash, const QString &fullName);
+    /** @brief Search helpers for a single missing item, the @p index of the searched folder should be built once and reused for all items */
+    static QString searchPathRecursively(const MediaSearchIndex &index, const QString &fileName, ClipType::ProducerType type = ClipType::Unknown);
+    static QString searchFileRecursively(const MediaSearchIndex &index, const QString &matchSize, const QString &matchHash, const QString &fileName);
+    static QString searchDirRecursively(const MediaSearchIndex &index, const QString &matchHash, const QString &fullName);
 
     bool resolveProblemsWithGUI();
     /** @brief Get a count of missing items in each category */
@@ -6,15 +6,24 @@
 #include "documentcheckertreemodel.h"
 
 #include "abstractmodel/treeitem.hpp"
+#include "mediasearchindex.h"
 
 #include <KColorScheme>
 
+#include <QtConcurrent/QtConcurrentRun>
+
 DocumentCheckerTreeModel::DocumentCheckerTreeModel(QObject *parent)
     : AbstractTreeModel{parent}
     , m_resourceItems()
 {
 }
 
+DocumentCheckerTreeModel::~DocumentCheckerTreeModel()
+{
+    // The search thread reports its progress through this model
+    m_searchFuture.waitForFinished();
+}
+
 Qt::ItemFlags DocumentCheckerTreeModel::flags(const QModelIndex &index) const
 {
     const auto flags = QAbstractItemModel::flags(index);
@@ -65,49 +74,90 @@ void DocumentCheckerTreeModel::removeItem(const QModelIndex &ix)
 
 void DocumentCheckerTreeModel::slotSearchRecursively(const QString &newpath)
 {
-    QDir searchDir(newpath);
-    QMap<QModelIndex, QString> fixedMap;
-    QMapIterator<int, DocumentChecker::DocumentResource> i(m_resourceItems);
-    int counter = 1;
-    while (i.hasNext()) {
-        i.next();
-        Q_EMIT searchProgress(counter, m_resourceItems.count());
-        counter++;
+    if (m_searchFuture.isRunning()) {
+        return;
+    }
+    Q_EMIT searchProgress(0, 0);
+    auto progress = [this](int current, int total) { Q_EMIT searchProgress(current, total); };
+    // The items are copied, the user can still edit them while the folder is searched
+    m_searchFuture = QtConcurrent::run(&DocumentCheckerTreeModel::searchMissingItems, newpath, m_resourceItems, progress);
+    m_searchFuture.then(this, [this](const QMap<int, QString> &foundPaths) {
+        for (auto i = foundPaths.constBegin(); i != foundPaths.constEnd(); ++i) {
+            auto item = m_resourceItems.constFind(i.key());
+            if (item == m_resourceItems.constEnd() ||
+                (item->status != DocumentChecker::MissingStatus::Missing && item->status != DocumentChecker::MissingStatus::MissingButProxy)) {
+                // Fixed or removed during the search
+                continue;
+            }
+            setItemsNewFilePath(getIndexFromId(i.key()), i.value(), DocumentChecker::MissingStatus::Fixed, false);
+        }
+        Q_EMIT dataChanged(QModelIndex(), QModelIndex());
+        Q_EMIT searchDone();
+    });
+}
+
+QMap<int, QString> DocumentCheckerTreeModel::searchMissingItems(const QString &path, const QMap<int, DocumentChecker::DocumentResource> &items,
+                                                                const std::function<void(int, int)> &progress)
+{
+    // Walk the folder once for all the missing items
+    const MediaSearchIndex searchIndex{QDir(path), progress};
+    QList<int> missingIds;
+    QList<int> fileIds;
+    QList<QPair<QString, QString>> fileRequests;
+    QList<int> slideshowIds;
+    QList<QPair<QString, QString>> slideshowRequests;
+    for (auto i = items.constBegin(); i != items.constEnd(); ++i) {
         if (i.value().status != DocumentChecker::MissingStatus::Missing && i.value().status != DocumentChecker::MissingStatus::MissingButProxy) {
             continue;
         }
-        QString newPath;
-        if (i.value().type == DocumentChecker::MissingType::Clip) {
-            ClipType::ProducerType type = i.value().clipType;
-            if (type == ClipType::SlideShow) {
-                // Slideshows cannot be found with hash / size
-                newPath = DocumentChecker::searchDirRecursively(searchDir, i.value().hash, i.value().originalFilePath);
-            } else {
-                newPath = DocumentChecker::searchFileRecursively(searchDir, i.value().fileSize, i.value().hash, i.value().originalFilePath);
-            }
-            if (newPath.isEmpty()) {
-                newPath = DocumentChecker::searchPathRecursively(searchDir, QUrl::fromLocalFile(i.value().originalFilePath).fileName(), type);
-            }
-        } else if (i.value().type == DocumentChecker::MissingType::Luma) {
-            newPath = DocumentChecker::searchLuma(searchDir, i.value().originalFilePath);
-
-        } else if (i.value().type == DocumentChecker::MissingType::AssetFile) {
-            newPath = DocumentChecker::searchPathRecursively(searchDir, QFileInfo(i.value().originalFilePath).fileName());
+        missingIds << i.key();
+        if (i.value().type != DocumentChecker::MissingType::Clip) {
+            continue;
+        }
+        if (i.value().clipType == ClipType::SlideShow) {
+            // Slideshows cannot be found with hash / size
+            slideshowIds << i.key();
+            slideshowRequests.append({i.value().hash, i.value().originalFilePath});
+        } else if (!i.value().fileSize.isEmpty() || !i.value().hash.isEmpty()) {
+            fileIds << i.key();
+            fileRequests.append({i.value().fileSize, i.value().hash});
+        }
+    }
+    // Verify all the candidates by hash at once
+    QMap<int, QString> foundPaths;
+    const QStringList foundFiles = searchIndex.findFiles(fileRequests, progress);
+    for (int ix = 0; ix < fileIds.size(); ++ix) {
+        foundPaths.insert(fileIds.at(ix), foundFiles.at(ix));
+    }
+    const QStringList foundFolders = searchIndex.findFolders(slideshowRequests);
+    for (int ix = 0; ix < slideshowIds.size(); ++ix) {
+        foundPaths.insert(slideshowIds.at(ix), foundFolders.at(ix));
+    }
 
-        } else if (i.value().type == DocumentChecker::MissingType::TitleImage) {
-            newPath = DocumentChecker::searchPathRecursively(searchDir, QFileInfo(i.value().originalFilePath).fileName());
+    QMap<int, QString> fixedPaths;
+    int counter = 1;
+    for (int id : std::as_const(missingIds)) {
+        if (progress) {
+            progress(counter, int(missingIds.count()));
+        }
+        counter++;
+        const DocumentChecker::DocumentResource item = items.value(id);
+        QString newPath = foundPaths.value(id);
+        if (newPath.isEmpty()) {
+            // Not found by hash, try by name
+            if (item.type == DocumentChecker::MissingType::Clip) {
+                newPath = DocumentChecker::searchPathRecursively(searchIndex, QUrl::fromLocalFile(item.originalFilePath).fileName(), item.clipType);
+            } else if (item.type == DocumentChecker::MissingType::Luma) {
+                newPath = DocumentChecker::searchLuma(searchIndex, item.originalFilePath);
+            } else if (item.type == DocumentChecker::MissingType::AssetFile || item.type == DocumentChecker::MissingType::TitleImage) {
+                newPath = DocumentChecker::searchPathRecursively(searchIndex, QFileInfo(item.originalFilePath).fileName());
+            }
         }
         if (!newPath.isEmpty()) {
-            fixedMap.insert(getIndexFromId(i.key()), newPath);
+            fixedPaths.insert(id, newPath);
         }
     }
-    QMapIterator<QModelIndex, QString> j(fixedMap);
-    while (j.hasNext()) {
-        j.next();
-        setItemsNewFilePath(j.key(), j.value(), DocumentChecker::MissingStatus::Fixed, false);
-    }
-    Q_EMIT dataChanged(QModelIndex(), QModelIndex());
-    Q_EMIT searchDone();
+    return fixedPaths;
 }
 
 void DocumentCheckerTreeModel::usePlaceholdersForMissing()
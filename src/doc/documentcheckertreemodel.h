@@ -9,6 +9,9 @@
 
 #include "doc/documentchecker.h"
 
+#include <QFuture>
+
+#include <functional>
 #include <vector>
 
 class DocumentCheckerTreeModel : public AbstractTreeModel
@@ -20,8 +23,11 @@ protected:
 
 public:
     static std::shared_ptr<DocumentCheckerTreeModel> construct(const std::vector<DocumentChecker::DocumentResource> &items, QObject *parent = nullptr);
+    ~DocumentCheckerTreeModel() override;
 
     void removeItem(const QModelIndex &ix);
+    /** @brief Search the missing items in @p newpath and its subfolders.
+     *  The search runs in a worker thread, reports its progress with searchProgress() and ends with searchDone() */
     void slotSearchRecursively(const QString &newpath);
     void usePlaceholdersForMissing();
     void setItemsNewFilePath(const QModelIndex &ix, const QString &url, DocumentChecker::MissingStatus status, bool refresh = true);
@@ -38,6 +44,10 @@ public:
 
 private:
     QMap<int, DocumentChecker::DocumentResource> m_resourceItems;
+    QFuture<QMap<int, QString>> m_searchFuture;
+    /** @brief Find the missing @p items in @p path, returns the new path of the found items by id. Runs in a worker thread */
+    static QMap<int, QString> searchMissingItems(const QString &path, const QMap<int, DocumentChecker::DocumentResource> &items,
+                                                 const std::function<void(int, int)> &progress);
 
 Q_SIGNALS:
     void searchProgress(int current, int total);
@@ -7,7 +7,6 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlivedoc.h"
 #include "bin/bin.h"
 #include "bin/bincommands.h"
-#include "bin/binplaylist.hpp"
 #include "bin/clipcreator.hpp"
 #include "bin/mediabrowser.h"
 #include "bin/model/markerlistmodel.hpp"
@@ -51,8 +50,15 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QStandardPaths>
 #include <QUndoGroup>
 #include <QUndoStack>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
 #include <QtConcurrent/QtConcurrentRun>
 #include <memory>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 #include <mlt++/Mlt.h>
 
 #include <audio/audioInfo.h>
@@ -342,6 +348,8 @@ KdenliveDoc::~KdenliveDoc()
     }
     m_commandStack->clear();
     m_timelines.clear();
+    // Don't let a pending backup recreate the file we are about to remove
+    waitForAutoSave();
     if (m_autosave) {
         if (!m_autosave->fileName().isEmpty()) {
             m_autosave->remove();
@@ -576,7 +584,7 @@ bool KdenliveDoc::autoGenerateImageProxy(int width) const
            (width < 0 || width > m_documentProperties.value(QStringLiteral("proxyimageminsize")).toInt());
 }
 
-void KdenliveDoc::slotAutoSave(const QString &scene)
+void KdenliveDoc::slotAutoSave(const QString &scene, const QMap<QString, QString> &replacements)
 {
     if (m_autosave != nullptr) {
         if (!m_autosave->isOpen() && !m_autosave->open(QIODevice::ReadWrite)) {
@@ -590,11 +598,59 @@ void KdenliveDoc::slotAutoSave(const QString &scene)
             KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", m_autosave->fileName()));
             return;
         }
-        m_autosave->resize(0);
-        if (m_autosave->write(scene.toUtf8()) < 0) {
-            pCore->displayMessage(i18n("Cannot create autosave file %1", m_autosave->fileName()), ErrorMessage);
-        }
-        m_autosave->flush();
+        waitForAutoSave();
+        const QString fileName = m_autosave->fileName();
+        m_autoSaveFuture = QtConcurrent::run(&KdenliveDoc::writeAutoSave, fileName, scene, replacements);
+        // The continuation is dropped if the document is deleted in the meantime
+        m_autoSaveFuture.then(this, [fileName](AUTOSAVESTATUS status) {
+            if (status == AutoSaveCorrupted) {
+                pCore->displayMessage(i18n("Project was corrupted, cannot backup. Please close and reopen your project file to recover last backup"),
+                                      ErrorMessage);
+            } else if (status == AutoSaveFailed) {
+                pCore->displayMessage(i18n("Cannot create autosave file %1", fileName), ErrorMessage);
+            }
+        });
+    }
+}
+
+KdenliveDoc::AUTOSAVESTATUS KdenliveDoc::writeAutoSave(const QString &fileName, QString scene, const QMap<QString, QString> &replacements)
+{
+    QMapIterator<QString, QString> i(replacements);
+    while (i.hasNext()) {
+        i.next();
+        scene.replace(i.key(), i.value());
+    }
+    if (!scene.contains(QLatin1String("<track "))) {
+        // In some unexplained cases, the MLT playlist is corrupted and all tracks are deleted. Don't save in that case.
+        return AutoSaveCorrupted;
+    }
+    const QByteArray data = scene.toUtf8();
+    // KAutoSaveFile keeps its own handle on the file, write through a separate one so that no QObject is used from this thread
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadWrite)) {
+        return AutoSaveFailed;
+    }
+    file.resize(0);
+    if (file.write(data) != data.size() || !file.flush()) {
+        return AutoSaveFailed;
+    }
+#if defined(Q_OS_WIN)
+    _commit(file.handle());
+#else
+    ::fsync(file.handle());
+#endif
+    return AutoSaveDone;
+}
+
+bool KdenliveDoc::autoSaveRunning() const
+{
+    return m_autoSaveFuture.isValid() && !m_autoSaveFuture.isFinished();
+}
+
+void KdenliveDoc::waitForAutoSave()
+{
+    if (m_autoSaveFuture.isValid()) {
+        m_autoSaveFuture.waitForFinished();
     }
 }
 
@@ -640,91 +696,101 @@ QPair<int, int> KdenliveDoc::targetTracks(const QUuid &uuid) const
     return {getSequenceProperty(uuid, QStringLiteral("videoTarget")).toInt(), getSequenceProperty(uuid, QStringLiteral("audioTarget")).toInt()};
 }
 
-QDomDocument KdenliveDoc::xmlSceneList(const QString &scene)
-{
-    QDomDocument sceneList;
-    sceneList.setContent(scene);
-    QDomElement mlt = sceneList.firstChildElement(QStringLiteral("mlt"));
-    if (mlt.isNull() || !mlt.hasChildNodes()) {
-        // scenelist is corrupted
-        return QDomDocument();
-    }
-
-    // Set playlist audio volume to 100%
-    QDomNodeList tractors = mlt.elementsByTagName(QStringLiteral("tractor"));
-    for (int i = 0; i < tractors.count(); ++i) {
-        if (tractors.at(i).toElement().hasAttribute(QStringLiteral("global_feed"))) {
-            // This is our main tractor
-            QDomElement tractor = tractors.at(i).toElement();
-            if (Xml::hasXmlProperty(tractor, QLatin1String("meta.volume"))) {
-                Xml::setXmlProperty(tractor, QStringLiteral("meta.volume"), QStringLiteral("1"));
+bool KdenliveDoc::writeSceneList(const QString &scene, QIODevice *output)
+{
+    QXmlStreamReader reader(scene);
+    QXmlStreamWriter writer(output);
+    writer.setAutoFormatting(true);
+    writer.setAutoFormattingIndent(1);
+    bool hasContent = false;
+    bool hasTracks = false;
+    bool mainTractorDone = false;
+    int depth = 0;
+    // Depth of the main tractor element, -1 when we are not inside it
+    int mainTractorDepth = -1;
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            ++depth;
+            const QStringView name = reader.name();
+            if (depth == 1 && name != QLatin1String("mlt")) {
+                // scenelist is corrupted
+                return false;
             }
+            hasContent = hasContent || depth > 1;
+            if (name == QLatin1String("track")) {
+                hasTracks = true;
+            } else if (name == QLatin1String("tractor")) {
+                if (mainTractorDepth < 0 && !mainTractorDone && reader.attributes().hasAttribute(QLatin1String("global_feed"))) {
+                    // This is our main tractor
+                    mainTractorDepth = depth;
+                }
+            } else if (mainTractorDepth >= 0 && depth == mainTractorDepth + 1 && name == QLatin1String("property") &&
+                       reader.attributes().value(QLatin1String("name")) == QLatin1String("meta.volume")) {
+                // Set playlist audio volume to 100%, properties of nested elements are kept
+                writer.writeCurrentToken(reader);
+                writer.writeCharacters(QStringLiteral("1"));
+                writer.writeEndElement();
+                reader.skipCurrentElement();
+                --depth;
+                mainTractorDepth = -1;
+                mainTractorDone = true;
+                break;
+            }
+            writer.writeCurrentToken(reader);
             break;
         }
-    }
-    QDomNodeList tracks = mlt.elementsByTagName(QStringLiteral("track"));
-    if (tracks.isEmpty()) {
-        // Something is very wrong, inform user.
-        qDebug() << " = = = =  = =  CORRUPTED DOC\n" << scene;
-        return QDomDocument();
-    }
-
-    QDomNodeList pls = mlt.elementsByTagName(QStringLiteral("playlist"));
-    QDomElement mainPlaylist;
-    for (int i = 0; i < pls.count(); ++i) {
-        if (pls.at(i).toElement().attribute(QStringLiteral("id")) == BinPlaylist::binPlaylistId) {
-            mainPlaylist = pls.at(i).toElement();
-            break;
-        }
-    }
-
-    // check if project contains custom effects to embed them in project file
-    QDomNodeList effects = mlt.elementsByTagName(QStringLiteral("filter"));
-    int maxEffects = effects.count();
-    QMap<QString, QString> effectIds;
-    for (int i = 0; i < maxEffects; ++i) {
-        QDomNode m = effects.at(i);
-        QDomNodeList params = m.childNodes();
-        QString id;
-        QString tag;
-        for (int j = 0; j < params.count(); ++j) {
-            QDomElement e = params.item(j).toElement();
-            if (e.attribute(QStringLiteral("name")) == QLatin1String("kdenlive_id")) {
-                id = e.firstChild().nodeValue();
-            }
-            if (e.attribute(QStringLiteral("name")) == QLatin1String("tag")) {
-                tag = e.firstChild().nodeValue();
+        case QXmlStreamReader::EndElement:
+            if (depth == mainTractorDepth) {
+                mainTractorDepth = -1;
+                mainTractorDone = true;
             }
-            if (!id.isEmpty() && !tag.isEmpty()) {
-                effectIds.insert(id, tag);
+            --depth;
+            writer.writeCurrentToken(reader);
+            break;
+        case QXmlStreamReader::Characters:
+            // Drop the formatting of the MLT xml consumer, like QDomDocument does
+            if (!reader.isWhitespace()) {
+                writer.writeCurrentToken(reader);
             }
+            break;
+        case QXmlStreamReader::Invalid:
+            break;
+        default:
+            writer.writeCurrentToken(reader);
+            break;
         }
     }
-    // TODO: find a way to process this before rendering MLT scenelist to xml
-    /*QDomDocument customeffects = initEffects::getUsedCustomEffects(effectIds);
-    if (!customeffects.documentElement().childNodes().isEmpty()) {
-        Xml::setXmlProperty(mainPlaylist, QStringLiteral("kdenlive:customeffects"), customeffects.toString());
-    }*/
-    // addedXml.appendChild(sceneList.importNode(customeffects.documentElement(), true));
-
-    // TODO: move metadata to previous step in saving process
-    QDomElement docmetadata = sceneList.createElement(QStringLiteral("documentmetadata"));
-    QMapIterator<QString, QString> j(m_documentMetadata);
-    while (j.hasNext()) {
-        j.next();
-        docmetadata.setAttribute(j.key(), j.value());
+    if (reader.hasError()) {
+        qCWarning(KDENLIVE_LOG) << "Invalid scene list:" << reader.errorString() << "at line" << reader.lineNumber();
+        return false;
     }
-    // addedXml.appendChild(docmetadata);
-
-    return sceneList;
+    if (!hasContent || !hasTracks) {
+        // Something is very wrong, inform user.
+        qCWarning(KDENLIVE_LOG) << " = = = =  = =  CORRUPTED DOC\n" << scene;
+        return false;
+    }
+    return !writer.hasError();
 }
 
 bool KdenliveDoc::saveSceneList(const QString &path, const QString &scene, bool saveOverExistingFile)
 {
-    QDomDocument sceneList = xmlSceneList(scene);
-    if (sceneList.isNull()) {
-        // Make sure we don't save if scenelist is corrupted
-        KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", path));
+    // The project is streamed to a temporary file, the target is only replaced on commit
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCWarning(KDENLIVE_LOG) << "//////  ERROR writing to file: " << path;
+        KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1", path));
+        return false;
+    }
+    if (!writeSceneList(scene, &file)) {
+        const bool writeError = file.error() != QFileDevice::NoError;
+        file.cancelWriting();
+        if (writeError) {
+            KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1", path));
+        } else {
+            // Make sure we don't save if scenelist is corrupted
+            KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1, scene list is corrupted.", path));
+        }
         return false;
     }
 
@@ -760,16 +826,6 @@ bool KdenliveDoc::saveSceneList(const QString &path, const QString &scene, bool
                      backupFile));
         }
     }
-    QSaveFile file(path);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qCWarning(KDENLIVE_LOG) << "//////  ERROR writing to file: " << path;
-        KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1", path));
-        return false;
-    }
-
-    const QByteArray sceneData = sceneList.toString().toUtf8();
-
-    file.write(sceneData);
     if (!file.commit()) {
         KMessageBox::error(QApplication::activeWindow(), i18n("Cannot write to file %1", path));
         return false;
@@ -1131,47 +1187,6 @@ const QString KdenliveDoc::description(const QString suffix) const
     return fullName;
 }
 
-QString KdenliveDoc::searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const
-{
-    QString foundFileName;
-    QByteArray fileData;
-    QByteArray fileHash;
-    QStringList filesAndDirs = dir.entryList(QDir::Files | QDir::Readable);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        QFile file(dir.absoluteFilePath(filesAndDirs.at(i)));
-        if (file.open(QIODevice::ReadOnly)) {
-            if (QString::number(file.size()) == matchSize) {
-                /*
-                 * 1 MB = 1 second per 450 files (or faster)
-                 * 10 MB = 9 seconds per 450 files (or faster)
-                 */
-                if (file.size() > 1000000 * 2) {
-                    fileData = file.read(1000000);
-                    if (file.seek(file.size() - 1000000)) {
-                        fileData.append(file.readAll());
-                    }
-                } else {
-                    fileData = file.readAll();
-                }
-                file.close();
-                fileHash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5);
-                if (QString::fromLatin1(fileHash.toHex()) == matchHash) {
-                    return file.fileName();
-                }
-                qCDebug(KDENLIVE_LOG) << filesAndDirs.at(i) << "size match but not hash";
-            }
-        }
-    }
-    filesAndDirs = dir.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
-    for (int i = 0; i < filesAndDirs.size() && foundFileName.isEmpty(); ++i) {
-        foundFileName = searchFileRecursively(dir.absoluteFilePath(filesAndDirs.at(i)), matchSize, matchHash);
-        if (!foundFileName.isEmpty()) {
-            break;
-        }
-    }
-    return foundFileName;
-}
-
 QStringList KdenliveDoc::getBinFolderClipIds(const QString &folderId) const
 {
     return pCore->bin()->getBinFolderClipIds(folderId);
@@ -2298,6 +2313,25 @@ QStringList KdenliveDoc::getProxyHashList()
     return pCore->bin()->getProxyHashList();
 }
 
+QStringList KdenliveDoc::cachedDataPaths()
+{
+    QStringList paths;
+    bool ok = false;
+    QDir cacheDir = getCacheDir(CacheBase, &ok);
+    if (ok) {
+        paths << cacheDir.absolutePath() + QLatin1Char('/');
+    }
+    QDir proxyDir = getCacheDir(CacheProxy, &ok);
+    if (ok) {
+        // Proxy clips are named after the clip hash
+        const QStringList hashes = getProxyHashList();
+        for (const QString &hash : hashes) {
+            paths << proxyDir.absoluteFilePath(hash);
+        }
+    }
+    return paths;
+}
+
 std::shared_ptr<TimelineItemModel> KdenliveDoc::getTimeline(const QUuid &uuid, bool allowEmpty)
 {
     if (m_timelines.contains(uuid)) {
@@ -2527,6 +2561,10 @@ const QString KdenliveDoc::subTitlePath(const QUuid &uuid, int ix, bool final, b
 
 void KdenliveDoc::duplicateSequenceProperty(const QUuid &destUuid, const QUuid &srcUuid, const QString &subsData)
 {
+    if (m_timelines.contains(srcUuid) && m_timelines.value(srcUuid)->hasSubtitleModel()) {
+        // Ensure the working file of the source sequence is up to date
+        m_timelines.value(srcUuid)->getSubtitleModel()->flushWorkFile();
+    }
     QJsonArray list;
     QMap<std::pair<int, QString>, QString> currentSubs = JSonToSubtitleList(subsData);
     QMapIterator<std::pair<int, QString>, QString> s(currentSubs);
@@ -15,6 +15,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <KJob>
 #include <QAction>
 #include <QDir>
+#include <QFuture>
 #include <QList>
 #include <QMap>
 #include <QObject>
@@ -38,6 +39,7 @@ class ProfileParam;
 class SubtitleModel;
 class MarkerSortModel;
 
+class QIODevice;
 class QUndoGroup;
 class QUndoCommand;
 class DocUndoStack;
@@ -115,6 +117,10 @@ public:
     int height() const;
     QUrl url() const;
     KAutoSaveFile *m_autosave;
+    /** @brief True while a backup started by slotAutoSave() is being written */
+    bool autoSaveRunning() const;
+    /** @brief Block until the pending autosave write is done, must be called before touching the autosave file */
+    void waitForAutoSave();
     /** @brief Whether the project folder should be in the same folder as the project file (var is only used for new projects)*/
     bool m_sameProjectFolder{false};
     bool m_restoreFromBackup{false};
@@ -161,8 +167,11 @@ public:
     void setZoom(const QUuid &uuid, int horizontal, int vertical = -1);
     QPoint zoom(const QUuid &uuid) const;
     double dar() const;
-    /** @brief Returns the project file xml. */
-    QDomDocument xmlSceneList(const QString &scene);
+    /** @brief Writes the project file xml for an MLT scene list in a single streaming pass.
+     *
+     * The main tractor volume is reset to 100%. Nothing is kept in memory apart from the scene itself.
+     * @return false if the scene list is corrupted or could not be written */
+    static bool writeSceneList(const QString &scene, QIODevice *output);
     /** @brief Saves the project file xml to a file. */
     bool saveSceneList(const QString &path, const QString &scene, bool saveOverExistingFile = true);
     void setProjectFolder(const QUrl &url);
@@ -240,6 +249,8 @@ public:
     void initCacheDirs();
     /** @brief Get a list of all proxy hash used in this project */
     QStringList getProxyHashList();
+    /** @brief Paths of the cached data used by this project (cache folder and proxy clips), as path prefixes */
+    QStringList cachedDataPaths();
     /** @brief Move project data files to new url */
     const QList<QUrl> getProjectData(bool *ok);
 
@@ -358,7 +369,12 @@ private:
      *  @param newDocument true if we are creating a new document, false when opening an existing one
      */
     void initializeProperties(bool newDocument = true, std::pair<int, int> tracks = {}, int audioChannels = 2);
+    enum AUTOSAVESTATUS { AutoSaveDone, AutoSaveCorrupted, AutoSaveFailed };
+    /** @brief Write an autosave file, runs on a worker thread */
+    static AUTOSAVESTATUS writeAutoSave(const QString &fileName, QString scene, const QMap<QString, QString> &replacements);
     QUuid m_uuid;
+    /** @brief The autosave write running in the background */
+    QFuture<AUTOSAVESTATUS> m_autoSaveFuture;
     QDomDocument m_document;
     int m_clipsCount;
     /** @brief MLT's root (base path) that is stripped from urls in saved xml */
@@ -396,7 +412,6 @@ private:
     QString m_modifiedDecimalPoint;
     /** @brief A list of guide models for this project (one for each timeline). */
     QMap<QUuid, std::shared_ptr<TimelineItemModel>> m_timelines;
-    QString searchFileRecursively(const QDir &dir, const QString &matchSize, const QString &matchHash) const;
 
     /** @brief Creates a new project. */
     QDomDocument createEmptyDocument(const QList<TrackInfo> &tracks, bool disableProfile);
@@ -426,8 +441,12 @@ public Q_SLOTS:
                               QUndoCommand *masterCommand = nullptr);
     /** @brief Saves the current project at the autosave location.
      *
-     * The autosave files are in ~/.kde/data/stalefiles/kdenlive/ */
-    void slotAutoSave(const QString &scene);
+     * The autosave files are in ~/.kde/data/stalefiles/kdenlive/ \n
+     * Only the autosave file is opened on the calling thread: the @p replacements, the
+     * corruption check and the write are done on a worker thread, see autoSaveRunning().
+     * @param scene the MLT xml of the project
+     * @param replacements strings to replace in the scene before writing it */
+    void slotAutoSave(const QString &scene, const QMap<QString, QString> &replacements = {});
     void switchProfile(ProfileParam* pf, const QString &clipName);
 
 private Q_SLOTS:
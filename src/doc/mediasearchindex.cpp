@@ -0,0 +1,188 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "mediasearchindex.h"
+#include "bin/projectclip.h"
+
+#include <QCryptographicHash>
+#include <QAtomicInt>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSet>
+#include <QtConcurrent/QtConcurrentMap>
+#include <algorithm>
+
+MediaSearchIndex::MediaSearchIndex(const QDir &root, const ProgressCallback &progress)
+{
+    const QString rootPath = root.absolutePath();
+    const Listing rootListing = listFolder(rootPath, false);
+    QStringList subFolders;
+    const QStringList subFolderNames = root.entryList(QDir::Dirs | QDir::Readable | QDir::Executable | QDir::NoDotAndDotDot);
+    for (const QString &name : subFolderNames) {
+        subFolders << root.absoluteFilePath(name);
+    }
+    // Walk each subfolder tree in a worker thread
+    QAtomicInt listed;
+    const int total = int(subFolders.size());
+    const QList<Listing> listings = QtConcurrent::blockingMapped<QList<Listing>>(subFolders, [&listed, total, &progress](const QString &path) {
+        Listing listing = MediaSearchIndex::listFolder(path, true);
+        if (progress) {
+            progress(listed.fetchAndAddRelaxed(1) + 1, total);
+        }
+        return listing;
+    });
+
+    m_folders << rootPath;
+    auto addListing = [this](const Listing &listing) {
+        for (const auto &file : listing.files) {
+            m_bySize.insert(file.second, file.first);
+            m_byName.insert(QFileInfo(file.first).fileName().toLower(), file.first);
+        }
+        for (const QString &folder : listing.folders) {
+            m_folders << folder;
+            m_foldersByName.insert(QFileInfo(folder).fileName().toLower(), folder);
+        }
+    };
+    addListing(rootListing);
+    for (const Listing &listing : listings) {
+        addListing(listing);
+    }
+}
+
+MediaSearchIndex::Listing MediaSearchIndex::listFolder(const QString &path, bool recursive)
+{
+    Listing listing;
+    if (recursive) {
+        listing.folders << path;
+    }
+    QDirIterator it(path, QDir::Files | QDir::Dirs | QDir::Readable | QDir::NoDotAndDotDot,
+                    recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+    while (it.hasNext()) {
+        const QString filePath = it.next();
+        const QFileInfo info = it.fileInfo();
+        if (!info.isDir()) {
+            listing.files.append({filePath, info.size()});
+        } else if (recursive) {
+            listing.folders << filePath;
+        }
+    }
+    return listing;
+}
+
+QString MediaSearchIndex::firstInSearchOrder(const QStringList &paths)
+{
+    if (paths.isEmpty()) {
+        return QString();
+    }
+    // A folder comes before its subfolders, siblings are sorted by name
+    auto best = std::min_element(paths.cbegin(), paths.cend(), [](const QString &a, const QString &b) {
+        const QStringList partsA = QFileInfo(a).path().split(QLatin1Char('/'));
+        const QStringList partsB = QFileInfo(b).path().split(QLatin1Char('/'));
+        if (partsA != partsB) {
+            return std::lexicographical_compare(partsA.cbegin(), partsA.cend(), partsB.cbegin(), partsB.cend());
+        }
+        return a < b;
+    });
+    return *best;
+}
+
+QStringList MediaSearchIndex::findFiles(const QList<QPair<QString, QString>> &requests, const ProgressCallback &progress) const
+{
+    // Hash every candidate only once, even if it matches the size of several requests
+    QSet<QString> candidateSet;
+    for (const auto &request : requests) {
+        bool ok = false;
+        const qint64 size = request.first.toLongLong(&ok);
+        if (ok && !request.second.isEmpty()) {
+            const QList<QString> sameSize = m_bySize.values(size);
+            for (const QString &path : sameSize) {
+                candidateSet.insert(path);
+            }
+        }
+    }
+    const QStringList candidates(candidateSet.cbegin(), candidateSet.cend());
+    QAtomicInt hashed;
+    const int total = int(candidates.size());
+    const QStringList hashes = QtConcurrent::blockingMapped<QStringList>(candidates, [&hashed, total, &progress](const QString &path) {
+        const QString hash = QString::fromLatin1(ProjectClip::calculateHash(path).first.toHex());
+        if (progress) {
+            progress(hashed.fetchAndAddRelaxed(1) + 1, total);
+        }
+        return hash;
+    });
+    QMultiHash<QString, QString> byHash;
+    for (int i = 0; i < candidates.size(); ++i) {
+        byHash.insert(hashes.at(i), candidates.at(i));
+    }
+
+    QStringList result;
+    result.reserve(requests.size());
+    for (const auto &request : requests) {
+        const qint64 size = request.first.toLongLong();
+        QStringList matches;
+        const QList<QString> sameHash = byHash.values(request.second);
+        for (const QString &path : sameHash) {
+            if (m_bySize.contains(size, path)) {
+                matches << path;
+            }
+        }
+        result << firstInSearchOrder(matches);
+    }
+    return result;
+}
+
+QStringList MediaSearchIndex::findFolders(const QList<QPair<QString, QString>> &requests) const
+{
+    QStringList result;
+    if (requests.isEmpty()) {
+        return result;
+    }
+    // The file name dependent part of the folder hash is cheap, compute the rest once per folder
+    const QStringList folderData =
+        QtConcurrent::blockingMapped<QStringList>(m_folders, [](const QString &path) { return ProjectClip::folderHashData(QDir(path)); });
+    for (const auto &request : requests) {
+        const QString fileName = QFileInfo(request.second).fileName();
+        QStringList matches;
+        for (int i = 0; i < m_folders.size(); ++i) {
+            const QString hash = QString::fromLatin1(QCryptographicHash::hash((fileName + folderData.at(i)).toUtf8(), QCryptographicHash::Md5).toHex());
+            if (hash == request.first) {
+                // Ensure the folder, not its parent, is compared in search order
+                matches << m_folders.at(i) + QLatin1Char('/');
+            }
+        }
+        const QString folder = firstInSearchOrder(matches);
+        result << (folder.isEmpty() ? QString() : folder + fileName);
+    }
+    return result;
+}
+
+QString MediaSearchIndex::findPath(const QString &fileName, ClipType::ProducerType type) const
+{
+    if (type == ClipType::SlideShow) {
+        if (fileName.contains(QLatin1Char('%'))) {
+            // Image sequence, look for a folder containing one of the images
+            const QString prefix = fileName.section(QLatin1Char('%'), 0, -2).toLower();
+            QStringList matches;
+            for (auto it = m_byName.constBegin(); it != m_byName.constEnd(); ++it) {
+                if (it.key().startsWith(prefix)) {
+                    matches << it.value();
+                }
+            }
+            const QString match = firstInSearchOrder(matches);
+            return match.isEmpty() ? QString() : QFileInfo(match).absoluteDir().absoluteFilePath(fileName);
+        }
+        // Mime type slideshow, look for a folder with the same name
+        const QString slideDirName = QFileInfo(fileName).dir().dirName().toLower();
+        const QString match = firstInSearchOrder(m_foldersByName.values(slideDirName));
+        return match.isEmpty() ? QString() : QDir(match).absoluteFilePath(QFileInfo(fileName).fileName());
+    }
+    return firstInSearchOrder(m_byName.values(fileName.toLower()));
+}
+
+int MediaSearchIndex::count() const
+{
+    return int(m_bySize.size());
+}
@@ -0,0 +1,79 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "definitions.h"
+
+#include <QDir>
+#include <QList>
+#include <QMultiHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+/**
+ * @class MediaSearchIndex
+ * @brief Index of the files below a folder, used to relocate missing clips.
+ *
+ * The folder is walked once, each first level subfolder in its own thread, and the
+ * files are indexed by size and by name. Missing clips are then resolved together:
+ * only the files with a matching size are read, and the partial hash of each
+ * candidate (see ProjectClip::calculateHash) is computed once, in parallel.
+ *
+ * When several files match, the result is the one the former depth first search
+ * would have found: files of a folder come before the ones of its subfolders,
+ * subfolders being visited in alphabetical order.
+ *
+ * Building the index and searching it block, callers on the GUI thread should run them through QtConcurrent.
+ */
+class MediaSearchIndex
+{
+public:
+    /** @brief Receives the number of processed and total steps, called from worker threads */
+    using ProgressCallback = std::function<void(int current, int total)>;
+
+    /** @brief Walk @p root and build the index. Hidden files are ignored.
+     *  @param progress is called each time a first level subfolder was listed */
+    explicit MediaSearchIndex(const QDir &root, const ProgressCallback &progress = {});
+
+    /** @brief Find files by size and partial hash.
+     *  @param requests size (as stored in kdenlive:file_size) and hexadecimal hash (kdenlive:file_hash) of each missing file
+     *  @param progress is called each time a candidate file was hashed
+     *  @return for each request, the path of a matching file or an empty string
+     */
+    QStringList findFiles(const QList<QPair<QString, QString>> &requests, const ProgressCallback &progress = {}) const;
+    /** @brief Find slideshow folders by hash, see ProjectClip::getFolderHash.
+     *  @param requests hexadecimal hash and original path of each missing slideshow
+     *  @return for each request, the path of the slideshow in the matching folder or an empty string
+     */
+    QStringList findFolders(const QList<QPair<QString, QString>> &requests) const;
+    /** @brief Find a file by name (case insensitive). For slideshows, find a folder with a matching image sequence or name. */
+    QString findPath(const QString &fileName, ClipType::ProducerType type = ClipType::Unknown) const;
+
+    /** @brief Number of indexed files */
+    int count() const;
+
+private:
+    struct Listing
+    {
+        QList<QPair<QString, qint64>> files;
+        QStringList folders;
+    };
+    static Listing listFolder(const QString &path, bool recursive);
+    /** @brief The first path in search order, or an empty string */
+    static QString firstInSearchOrder(const QStringList &paths);
+
+    QMultiHash<qint64, QString> m_bySize;
+    // Lower case file name to path
+    QMultiHash<QString, QString> m_byName;
+    // Lower case folder name to path, the root folder is not included
+    QMultiHash<QString, QString> m_foldersByName;
+    // All indexed folders, including the root
+    QStringList m_folders;
+};
@@ -55,6 +55,9 @@ protected:
     bool m_isForce;
     bool m_running;
     QUuid m_uuid;
+    /** @brief The media processed by this task, for example the clip hash. Tasks of the same type
+     *  working on the same resource are not run concurrently, see TaskManager */
+    QString m_resource;
     void run() override;
     void cleanup();
 
@@ -0,0 +1,283 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "audiolevelspyramid.h"
+#include "definitions.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+/**
+ * Header of the audio levels cache file, followed by the levels.
+ * Values are stored in native byte order: a file written on a machine with another
+ * endianness fails the version check and is regenerated.
+ */
+struct CacheHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 channels;
+    quint32 pointsPerFrame;
+    quint32 levelCount;
+    char sourceHash[64];
+    // Offsets in bytes from the start of the file and number of values of each level
+    quint64 offsets[AudioLevelsPyramid::LEVELS];
+    quint64 sizes[AudioLevelsPyramid::LEVELS];
+};
+static_assert(sizeof(CacheHeader) % sizeof(quint64) == 0, "Levels must stay aligned");
+constexpr char CACHE_MAGIC[8] = {'K', 'D', 'E', 'N', 'L', 'V', 'L', 'S'};
+} // namespace
+
+AudioLevelsPyramid::AudioLevelsPyramid(const QVector<int16_t> &base, int channels)
+    : m_channels(channels)
+{
+    if (channels <= 0 || base.isEmpty()) {
+        m_channels = 0;
+        return;
+    }
+    QVector<QVector<int16_t>> levels;
+    levels.reserve(LEVELS);
+    levels << base;
+    for (int i = 1; i < LEVELS; ++i) {
+        const QVector<int16_t> &previous = levels.constLast();
+        levels << decimate(previous.constData(), previous.size(), channels, decimation(i));
+    }
+    setLevels(levels);
+}
+
+AudioLevelsPyramid::AudioLevelsPyramid(const QVector<QVector<int16_t>> &levels, int channels)
+    : m_channels(channels)
+{
+    if (channels <= 0 || levels.isEmpty() || levels.constFirst().isEmpty()) {
+        m_channels = 0;
+        return;
+    }
+    QVector<QVector<int16_t>> checked;
+    checked << levels.constFirst();
+    for (int i = 1; i < LEVELS; ++i) {
+        const QVector<int16_t> &previous = checked.constLast();
+        const qsizetype expected = (previous.size() / channels + decimation(i) - 1) / decimation(i) * channels;
+        if (i < levels.size() && levels.at(i).size() == expected) {
+            checked << levels.at(i);
+        } else {
+            // Missing or inconsistent level, rebuild it
+            checked << decimate(previous.constData(), previous.size(), channels, decimation(i));
+        }
+    }
+    setLevels(checked);
+}
+
+void AudioLevelsPyramid::setLevels(const QVector<QVector<int16_t>> &levels)
+{
+    auto storage = std::make_shared<const QVector<QVector<int16_t>>>(levels);
+    m_levels.clear();
+    for (const QVector<int16_t> &level : *storage) {
+        m_levels << Level{level.constData(), level.size()};
+    }
+    m_storage = storage;
+    m_mapped = false;
+}
+
+AudioLevelsPyramid AudioLevelsPyramid::loadFromFile(const QString &path, int channels, const QByteArray &sourceHash, LoadResult *result)
+{
+    LoadResult dummy;
+    LoadResult &status = result ? *result : dummy;
+    status = Missing;
+    auto file = std::make_shared<QFile>(path);
+    if (channels <= 0 || !file->open(QIODevice::ReadOnly)) {
+        return {};
+    }
+    const qint64 fileSize = file->size();
+    if (fileSize < qint64(sizeof(CacheHeader)) || file->peek(sizeof(CACHE_MAGIC)) != QByteArray::fromRawData(CACHE_MAGIC, sizeof(CACHE_MAGIC))) {
+        status = OtherFormat;
+        return {};
+    }
+    status = Stale;
+    const uchar *map = file->map(0, fileSize);
+    if (map == nullptr) {
+        qWarning() << "Cannot map audio levels cache" << path;
+        status = Missing;
+        return {};
+    }
+    // The mapping stays valid until the file object is destroyed, don't keep a descriptor per clip
+    file->close();
+    CacheHeader header;
+    memcpy(&header, map, sizeof(CacheHeader));
+    if (header.version != CACHE_VERSION || header.channels != quint32(channels) || header.pointsPerFrame != quint32(AUDIOLEVELS_POINTS_PER_FRAME) ||
+        header.levelCount != quint32(LEVELS)) {
+        return {};
+    }
+    if (!sourceHash.isEmpty() && qstrncmp(header.sourceHash, sourceHash.constData(), sizeof(header.sourceHash)) != 0) {
+        qDebug() << "Audio levels cache" << path << "does not match the source media";
+        return {};
+    }
+    AudioLevelsPyramid pyramid;
+    pyramid.m_channels = channels;
+    for (int i = 0; i < LEVELS; ++i) {
+        const quint64 offset = header.offsets[i];
+        const quint64 size = header.sizes[i];
+        if (size == 0 || offset % sizeof(int16_t) != 0 || offset > quint64(fileSize) || size > (quint64(fileSize) - offset) / sizeof(int16_t)) {
+            qWarning() << "Corrupted audio levels cache" << path;
+            return {};
+        }
+        pyramid.m_levels << Level{reinterpret_cast<const int16_t *>(map + offset), qsizetype(size)};
+    }
+    // The mapping stays valid as long as the file object lives
+    pyramid.m_storage = file;
+    pyramid.m_mapped = true;
+    status = Loaded;
+    return pyramid;
+}
+
+bool AudioLevelsPyramid::saveToFile(const QString &path, const QByteArray &sourceHash) const
+{
+    if (isEmpty()) {
+        return false;
+    }
+    CacheHeader header;
+    memset(&header, 0, sizeof(CacheHeader));
+    memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.channels = quint32(m_channels);
+    header.pointsPerFrame = quint32(AUDIOLEVELS_POINTS_PER_FRAME);
+    header.levelCount = quint32(LEVELS);
+    qstrncpy(header.sourceHash, sourceHash.constData(), sizeof(header.sourceHash));
+    quint64 offset = sizeof(CacheHeader);
+    for (int i = 0; i < LEVELS; ++i) {
+        header.offsets[i] = offset;
+        header.sizes[i] = quint64(m_levels.at(i).size);
+        offset += header.sizes[i] * sizeof(int16_t);
+    }
+
+    // Write to a temporary file and rename, so that a mapped previous version is never truncated
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write audio levels cache" << path;
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(&header), sizeof(CacheHeader));
+    for (const Level &level : m_levels) {
+        file.write(reinterpret_cast<const char *>(level.data), qint64(level.size * qsizetype(sizeof(int16_t))));
+    }
+    return file.commit();
+}
+
+int AudioLevelsPyramid::decimation(int level)
+{
+    static const int factors[LEVELS] = {1, AUDIOLEVELS_POINTS_PER_FRAME, 8, 8};
+    if (level < 0 || level >= LEVELS) {
+        return 1;
+    }
+    return factors[level];
+}
+
+double AudioLevelsPyramid::pointsPerFrame(int level)
+{
+    double points = AUDIOLEVELS_POINTS_PER_FRAME;
+    for (int i = 1; i <= level && i < LEVELS; ++i) {
+        points /= decimation(i);
+    }
+    return points;
+}
+
+QVector<int16_t> AudioLevelsPyramid::decimate(const int16_t *in, qsizetype size, int channels, int factor)
+{
+    if (channels <= 0 || factor <= 1) {
+        return QVector<int16_t>(in, in + size);
+    }
+    const qsizetype pointsIn = size / channels;
+    const qsizetype pointsOut = (pointsIn + factor - 1) / factor;
+    QVector<int16_t> out(pointsOut * channels, 0);
+    const int16_t *src = in;
+    int16_t *dst = out.data();
+    for (qsizetype p = 0; p < pointsIn; ++p) {
+        int16_t *target = dst + (p / factor) * channels;
+        for (int ch = 0; ch < channels; ++ch) {
+            target[ch] = std::max(target[ch], src[ch]);
+        }
+        src += channels;
+    }
+    return out;
+}
+
+bool AudioLevelsPyramid::isEmpty() const
+{
+    return m_levels.isEmpty();
+}
+
+bool AudioLevelsPyramid::isMapped() const
+{
+    return m_mapped;
+}
+
+int AudioLevelsPyramid::channels() const
+{
+    return m_channels;
+}
+
+int AudioLevelsPyramid::levelCount() const
+{
+    return int(m_levels.size());
+}
+
+const int16_t *AudioLevelsPyramid::levelData(int level) const
+{
+    if (level < 0 || level >= m_levels.size()) {
+        return nullptr;
+    }
+    return m_levels.at(level).data;
+}
+
+qsizetype AudioLevelsPyramid::levelSize(int level) const
+{
+    if (level < 0 || level >= m_levels.size()) {
+        return 0;
+    }
+    return m_levels.at(level).size;
+}
+
+QVector<int16_t> AudioLevelsPyramid::level(int level) const
+{
+    const int16_t *data = levelData(level);
+    if (data == nullptr) {
+        return {};
+    }
+    return QVector<int16_t>(data, data + levelSize(level));
+}
+
+int AudioLevelsPyramid::frames() const
+{
+    if (m_levels.isEmpty()) {
+        return 0;
+    }
+    return int(m_levels.constFirst().size / AUDIOLEVELS_POINTS_PER_FRAME / m_channels);
+}
+
+int16_t AudioLevelsPyramid::maxLevel() const
+{
+    if (m_levels.isEmpty()) {
+        return 0;
+    }
+    // The coarsest level holds the same maximum with far fewer points
+    const Level &coarsest = m_levels.constLast();
+    return *std::max_element(coarsest.data, coarsest.data + coarsest.size);
+}
+
+int AudioLevelsPyramid::levelForScale(double pixelsPerFrame) const
+{
+    int best = 0;
+    for (int i = 1; i < m_levels.size(); ++i) {
+        if (pointsPerFrame(i) < pixelsPerFrame) {
+            break;
+        }
+        best = i;
+    }
+    return best;
+}
@@ -0,0 +1,100 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+/**
+ * @class AudioLevelsPyramid
+ * @brief Multi-resolution audio peaks of one audio stream.
+ *
+ * Level 0 holds the levels computed by the generators, AUDIOLEVELS_POINTS_PER_FRAME
+ * interleaved peaks per frame. Each following level keeps the maximum of a fixed
+ * number of points of the previous one, so that drawing a zoomed out waveform only
+ * has to read a number of points proportional to the number of pixels.
+ *
+ * The levels are either held in memory or read directly from a memory mapped cache
+ * file (see loadFromFile()), in which case they are never copied to the heap.
+ * The class is a cheap to copy value type, all copies share the same storage.
+ */
+class AudioLevelsPyramid
+{
+public:
+    /** @brief Number of levels: 5, 1, 1/8 and 1/64 points per frame. */
+    static constexpr int LEVELS = 4;
+    /** @brief Version of the binary cache format written by saveToFile() */
+    static constexpr quint32 CACHE_VERSION = 1;
+
+    /** @brief Outcome of loadFromFile() */
+    enum LoadResult {
+        Loaded,
+        /** The file is missing or unreadable */
+        Missing,
+        /** The file is not in the binary cache format, it may have been written by a previous version */
+        OtherFormat,
+        /** The file is in the binary cache format but from another version, for another source or corrupted */
+        Stale
+    };
+
+    AudioLevelsPyramid() = default;
+    /** @brief Builds the coarser levels from @p base, the interleaved peaks of @p channels channels. */
+    AudioLevelsPyramid(const QVector<int16_t> &base, int channels);
+    /** @brief Uses already computed levels. The levels are checked for consistency and rebuilt if needed. */
+    AudioLevelsPyramid(const QVector<QVector<int16_t>> &levels, int channels);
+
+    /** @brief Maps a cache file written by saveToFile(). The file is closed once mapped.
+     *  @param channels expected number of channels
+     *  @param sourceHash expected hash of the source media, ignored if empty
+     *  @param result if not null, set to the reason why the pyramid could not be loaded
+     *  @return an empty pyramid if the file is missing, from another version or does not match the source
+     */
+    static AudioLevelsPyramid loadFromFile(const QString &path, int channels, const QByteArray &sourceHash, LoadResult *result = nullptr);
+    /** @brief Atomically writes the pyramid in the binary cache format: a versioned header followed by the levels. */
+    bool saveToFile(const QString &path, const QByteArray &sourceHash) const;
+
+    /** @brief Number of points of the previous level merged into one point of @p level. */
+    static int decimation(int level);
+    /** @brief Points per frame stored in @p level (5, 1, 1/8 and 1/64). */
+    static double pointsPerFrame(int level);
+    /** @brief Downsamples @p size interleaved values by keeping the max of each group of @p factor points, per channel. */
+    static QVector<int16_t> decimate(const int16_t *in, qsizetype size, int channels, int factor);
+
+    bool isEmpty() const;
+    /** @brief True if the levels are read from a memory mapped cache file. */
+    bool isMapped() const;
+    int channels() const;
+    int levelCount() const;
+    /** @brief Interleaved peaks of a level, level 0 being the full resolution. Valid as long as a copy of the pyramid exists. */
+    const int16_t *levelData(int level) const;
+    /** @brief Number of values (points * channels) of a level. */
+    qsizetype levelSize(int level) const;
+    /** @brief Copy of a level. */
+    QVector<int16_t> level(int level) const;
+    /** @brief Number of frames covered by the levels. */
+    int frames() const;
+    /** @brief Highest peak of all channels. */
+    int16_t maxLevel() const;
+    /** @brief Coarsest level that still has at least one point per pixel when a frame is @p pixelsPerFrame pixels wide. */
+    int levelForScale(double pixelsPerFrame) const;
+
+private:
+    struct Level
+    {
+        const int16_t *data;
+        qsizetype size;
+    };
+    QVector<Level> m_levels;
+    /** @brief Owner of the memory pointed to by m_levels: in memory levels or a mapped file */
+    std::shared_ptr<const void> m_storage;
+    int m_channels{0};
+    bool m_mapped{false};
+
+    void setLevels(const QVector<QVector<int16_t>> &levels);
+};
@@ -12,6 +12,7 @@
 #include "bin/projectitemmodel.h"
 #include "core.h"
 #include "generators.h"
+#include "utils/cachemanager.hpp"
 
 #include <KLocalizedString>
 #include <KMessageWidget>
@@ -22,6 +23,7 @@
 #include <QRgb>
 #include <QString>
 #include <QVariantList>
+#include <QtEndian>
 #include <functional>
 constexpr int UPDATE_DELAY_MS = 1000;
 
@@ -41,24 +43,28 @@ void AudioLevelsTask::start(const ObjectId &owner, QObject *object, bool force)
     AudioLevelsTask *task = new AudioLevelsTask(owner, object);
     // Otherwise, start a new audio levels generation thread.
     task->m_isForce = force;
+    if (auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(owner.itemId))) {
+        // Clips using the same media share the levels cache, the media is only processed once
+        task->m_resource = binClip->hash(false);
+    }
     pCore->taskManager.startTask(owner.itemId, task);
 }
 
-void AudioLevelsTask::storeLevels(const std::shared_ptr<ProjectClip> &binClip, const int stream, const QVector<int16_t> &levels)
+void AudioLevelsTask::storeLevels(const std::shared_ptr<ProjectClip> &binClip, const int stream, const AudioLevelsPyramid &levels)
 {
     const auto producer = binClip->originalProducer();
     producer->lock();
 
-    auto *levelsCopy = new QVector<int16_t>(levels);
+    auto *levelsCopy = new AudioLevelsPyramid(levels);
     producer->set(QStringLiteral("_kdenlive:audio%1").arg(stream).toUtf8().constData(), levelsCopy, 0,
-                  [](void *ptr) { delete static_cast<QVector<int16_t> *>(ptr); });
+                  [](void *ptr) { delete static_cast<AudioLevelsPyramid *>(ptr); });
 
     producer->unlock();
 }
 
-void AudioLevelsTask::storeMax(const std::shared_ptr<ProjectClip> &binClip, const int stream, const QVector<int16_t> &levels)
+void AudioLevelsTask::storeMax(const std::shared_ptr<ProjectClip> &binClip, const int stream, const AudioLevelsPyramid &levels)
 {
-    const auto max = *std::max_element(levels.constBegin(), levels.constEnd());
+    const auto max = levels.maxLevel();
 
     const auto producer = binClip->originalProducer();
     producer->lock();
@@ -66,31 +72,74 @@ void AudioLevelsTask::storeMax(const std::shared_ptr<ProjectClip> &binClip, cons
     producer->unlock();
 }
 
-QVector<int16_t> AudioLevelsTask::getLevelsFromCache(const QString &cachePath)
+AudioLevelsPyramid AudioLevelsTask::getLevelsFromCache(const QString &cachePath, int channels, const QByteArray &sourceHash, bool *isLegacy)
 {
     qDebug() << "Loading audio levels from cache" << cachePath;
+    if (isLegacy) {
+        *isLegacy = false;
+    }
+    AudioLevelsPyramid::LoadResult result;
+    AudioLevelsPyramid pyramid = AudioLevelsPyramid::loadFromFile(cachePath, channels, sourceHash, &result);
+    if (result == AudioLevelsPyramid::Loaded) {
+        CacheManager::get()->recordAccess(cachePath);
+        return pyramid;
+    }
+    if (result == AudioLevelsPyramid::Stale) {
+        // Outdated or broken cache, it will be regenerated
+        if (QFile::remove(cachePath)) {
+            CacheManager::get()->recordRemoval(cachePath);
+        }
+        return pyramid;
+    }
+    if (result != AudioLevelsPyramid::OtherFormat) {
+        return pyramid;
+    }
+    // Try the QDataStream based format of previous versions
     QFile file(cachePath);
-    QVector<int16_t> levels;
+    QVector<QVector<int16_t>> levels;
     if (file.open(QIODevice::ReadOnly)) {
+        // The file starts with the number of values of the first level
+        const QByteArray sizeData = file.peek(sizeof(quint32));
+        if (sizeData.size() < int(sizeof(quint32)) ||
+            qFromBigEndian<quint32>(sizeData.constData()) > quint64(file.size() - qint64(sizeof(quint32))) / sizeof(int16_t)) {
+            // Not a levels list, don't allocate memory for garbage
+            qWarning() << "Invalid audio levels cache" << cachePath;
+            return pyramid;
+        }
         QDataStream in(&file);
-        in >> levels;
+        QVector<int16_t> level;
+        in >> level;
+        if (in.status() == QDataStream::Ok) {
+            levels << level;
+        }
+        while (!levels.isEmpty() && !in.atEnd() && levels.size() < AudioLevelsPyramid::LEVELS) {
+            in >> level;
+            if (in.status() != QDataStream::Ok) {
+                break;
+            }
+            levels << level;
+        }
         file.close();
     }
-    return levels;
+    pyramid = AudioLevelsPyramid(levels, channels);
+    if (isLegacy && !pyramid.isEmpty()) {
+        *isLegacy = true;
+    }
+    return pyramid;
 }
 
-void AudioLevelsTask::saveLevelsToCache(const QString &cachePath, const QVector<int16_t> &levels)
+bool AudioLevelsTask::saveLevelsToCache(const QString &cachePath, const AudioLevelsPyramid &levels, const QByteArray &sourceHash)
 {
     qDebug() << "Saving audio levels to cache" << cachePath;
-    QFile file(cachePath);
-    if (file.open(QIODevice::WriteOnly)) {
-        QDataStream out(&file);
-        out << levels;
-        file.close();
+    if (!levels.saveToFile(cachePath, sourceHash)) {
+        return false;
     }
+    CacheManager::get()->recordWrite(cachePath);
+    return true;
 }
 
-void AudioLevelsTask::progressCallback(const std::shared_ptr<ProjectClip> &binClip, const QVector<int16_t> &levels, const int streamIdx, const int progress)
+void AudioLevelsTask::progressCallback(const std::shared_ptr<ProjectClip> &binClip, const QVector<int16_t> &levels, const int streamIdx, const int channels,
+                                       const int progress)
 {
     if (m_progress != progress) {
         m_progress = progress;
@@ -99,7 +148,7 @@ void AudioLevelsTask::progressCallback(const std::shared_ptr<ProjectClip> &binCl
 
     if (m_timer.elapsed() > UPDATE_DELAY_MS && !m_isCanceled) {
         m_timer.restart();
-        storeLevels(binClip, streamIdx, levels);
+        storeLevels(binClip, streamIdx, AudioLevelsPyramid(levels, channels));
         QMetaObject::invokeMethod(m_object, "updateAudioThumbnail", Q_ARG(bool, false));
     }
 }
@@ -123,7 +172,6 @@ void AudioLevelsTask::run()
         // nothing to do
         return;
     }
-
     std::shared_ptr<Mlt::Producer> producer = binClip->originalProducer();
     if ((producer == nullptr) || !producer->is_valid()) {
         QMetaObject::invokeMethod(pCore.get(), "displayBinMessage", Qt::QueuedConnection,
@@ -154,37 +202,49 @@ void AudioLevelsTask::run()
             break;
         }
 
-        auto clbk = [this, binClip, ix = streamIdx.key()](const int progress, const QVector<int16_t> &levels) {
-            progressCallback(binClip, levels, ix, progress);
+        const int channels = binClip->audioInfo()->channelsForStream(streamIdx.key());
+        auto clbk = [this, binClip, channels, ix = streamIdx.key()](const int progress, const QVector<int16_t> &levels) {
+            progressCallback(binClip, levels, ix, channels, progress);
         };
 
         const QString cachePath = binClip->getAudioThumbPath(streamIdx.key());
-        QVector<int16_t> levels;
+        const QByteArray sourceHash = binClip->hash(false).toLatin1();
+        AudioLevelsPyramid pyramid;
         bool skipSaving = false;
         if (!m_isCanceled && !m_isForce && QFile::exists(cachePath)) {
-            // load from cache
-            levels = getLevelsFromCache(cachePath);
-            skipSaving = true;
+            // load from cache, rewriting caches from previous versions
+            bool isLegacy = false;
+            pyramid = getLevelsFromCache(cachePath, channels, sourceHash, &isLegacy);
+            skipSaving = !isLegacy;
         }
 
-        if (!m_isCanceled && levels.empty() && service == QStringLiteral("avformat")) {
+        QVector<int16_t> levels;
+        if (!m_isCanceled && pyramid.isEmpty() && service == QStringLiteral("avformat")) {
             // if the resource is a media file, we can use libav for speed
             const auto fps = producer->get_fps();
             levels = generateLibav(streamIdx.key(), res, lengthInFrames, fps, clbk, m_isCanceled);
         }
 
-        if (!m_isCanceled && levels.empty()) {
+        if (!m_isCanceled && pyramid.isEmpty() && levels.empty()) {
             // else, or if using libav failed, use MLT
-            const int channels = binClip->audioInfo()->channelsForStream(streamIdx.key());
             levels = generateMLT(streamIdx.key(), service, res, channels, clbk, m_isCanceled);
         }
 
-        if (!m_isCanceled && !levels.empty()) {
-            storeLevels(binClip, streamIdx.key(), levels);
-            storeMax(binClip, streamIdx.key(), levels);
-            if (!skipSaving) {
-                saveLevelsToCache(cachePath, levels);
+        if (!m_isCanceled && pyramid.isEmpty() && !levels.empty()) {
+            pyramid = AudioLevelsPyramid(levels, channels);
+            skipSaving = false;
+        }
+
+        if (!m_isCanceled && !pyramid.isEmpty()) {
+            if (!skipSaving && saveLevelsToCache(cachePath, pyramid, sourceHash)) {
+                // Switch to the mapped copy to release the memory used by the generated levels
+                const AudioLevelsPyramid mapped = AudioLevelsPyramid::loadFromFile(cachePath, channels, sourceHash);
+                if (!mapped.isEmpty()) {
+                    pyramid = mapped;
+                }
             }
+            storeLevels(binClip, streamIdx.key(), pyramid);
+            storeMax(binClip, streamIdx.key(), pyramid);
             m_progress = 100;
             QMetaObject::invokeMethod(m_object, "updateJobProgress");
         }
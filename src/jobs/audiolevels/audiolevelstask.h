@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "audiolevelspyramid.h"
 #include "jobs/abstracttask.h"
 
 #include <QObject>
@@ -20,15 +21,21 @@ class AudioLevelsTask : public AbstractTask
 public:
     AudioLevelsTask(const ObjectId &owner, QObject *object);
     static void start(const ObjectId &owner, QObject *object, bool force = false);
-    static QVector<int16_t> getLevelsFromCache(const QString &cachePath);
-    static void saveLevelsToCache(const QString &cachePath, const QVector<int16_t> &levels);
+    /** @brief Loads the levels pyramid of a stream with @p channels channels from the audio thumb cache.
+     *  The cache file is memory mapped, its levels are not copied. Cache files from older versions
+     *  are read in memory, @p isLegacy is then set so that the caller can rewrite them.
+     *  @param sourceHash hash of the source media, the cache is ignored if it does not match
+     */
+    static AudioLevelsPyramid getLevelsFromCache(const QString &cachePath, int channels, const QByteArray &sourceHash = QByteArray(),
+                                                 bool *isLegacy = nullptr);
+    static bool saveLevelsToCache(const QString &cachePath, const AudioLevelsPyramid &levels, const QByteArray &sourceHash = QByteArray());
 
 protected:
     void run() override;
 
 private:
-    static void storeLevels(const std::shared_ptr<ProjectClip> &binClip, int stream, const QVector<int16_t> &levels);
-    static void storeMax(const std::shared_ptr<ProjectClip> &binClip, int stream, const QVector<int16_t> &levels);
-    void progressCallback(const std::shared_ptr<ProjectClip> &binClip, const QVector<int16_t> &levels, int streamIdx, int progress);
+    static void storeLevels(const std::shared_ptr<ProjectClip> &binClip, int stream, const AudioLevelsPyramid &levels);
+    static void storeMax(const std::shared_ptr<ProjectClip> &binClip, int stream, const AudioLevelsPyramid &levels);
+    void progressCallback(const std::shared_ptr<ProjectClip> &binClip, const QVector<int16_t> &levels, int streamIdx, int channels, int progress);
     QElapsedTimer m_timer;
 };
@@ -44,6 +44,11 @@ void CacheTask::start(const ObjectId &owner, int thumbsCount, int in, int out, Q
     CacheTask *task = new CacheTask(owner, thumbsCount, in, out, object);
     // Otherwise, start a new audio levels generation thread.
     task->m_isForce = force;
+    if (auto binClip = pCore->projectItemModel()->getClipByBinID(QString::number(owner.itemId))) {
+        // Clips using the same media share the thumbnail archive, the media is only processed once.
+        // Use the archive key, which differs for each video stream
+        task->m_resource = binClip->hashForThumbs();
+    }
     pCore->taskManager.startTask(owner.itemId, task);
 }
 
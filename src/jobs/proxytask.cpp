@@ -13,6 +13,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "kdenlive_debug.h"
 #include "kdenlivesettings.h"
 #include "macros.hpp"
+#include "utils/cachemanager.hpp"
 
 #include <QImageReader>
 #include <QProcess>
@@ -58,6 +59,7 @@ void ProxyTask::run()
     QFileInfo fInfo(dest);
     if (binClip->getProducerIntProperty(QStringLiteral("_overwriteproxy")) == 0 && fInfo.exists() && fInfo.size() > 0) {
         // Proxy clip already created
+        CacheManager::get()->recordAccess(dest);
         m_progress = 100;
         QMetaObject::invokeMethod(m_object, "updateJobProgress");
         QMetaObject::invokeMethod(binClip.get(), "updateProxyProducer", Qt::QueuedConnection, Q_ARG(QString, dest));
@@ -407,6 +409,7 @@ void ProxyTask::run()
             }
         } else if (binClip) {
             // Job successful
+            CacheManager::get()->recordWrite(dest);
             QMetaObject::invokeMethod(binClip.get(), "updateProxyProducer", Qt::QueuedConnection, Q_ARG(QString, dest));
         }
     } else {
@@ -17,16 +17,25 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <KMessageWidget>
 #include <QFuture>
 #include <QThread>
+#include <algorithm>
+
+namespace {
+// Head start of each lane in ms, added to the time a task has been waiting: an analysis
+// task queued for more than 20 seconds is started before a clip load that was just queued
+constexpr qint64 LANE_HEAD_START[] = {600000, 20000, 0, 0};
+} // namespace
 
 TaskManager::TaskManager(QObject *parent)
     : QObject(parent)
     , displayedClip(-1)
     , m_tasksListLock(QReadWriteLock::Recursive)
     , m_blockUpdates(false)
+    , m_workerCount(1)
 {
-    int maxThreads = qMin(4, QThread::idealThreadCount() - 1);
-    m_taskPool.setMaxThreadCount(qMax(maxThreads, 1));
-    m_transcodePool.setMaxThreadCount(KdenliveSettings::proxythreads());
+    m_runningTasks.fill(0);
+    m_laneLimits.fill(1);
+    m_clock.start();
+    updateConcurrency();
 }
 
 TaskManager::~TaskManager()
@@ -41,7 +50,163 @@ bool TaskManager::isBlocked() const
 
 void TaskManager::updateConcurrency()
 {
-    m_transcodePool.setMaxThreadCount(KdenliveSettings::proxythreads());
+    QWriteLocker lk(&m_tasksListLock);
+    m_workerCount = qBound(1, QThread::idealThreadCount() - 1, 8);
+    m_laneLimits[InteractiveLane] = m_workerCount;
+    m_laneLimits[LoadLane] = qMax(1, m_workerCount - 1);
+    m_laneLimits[AnalysisLane] = qMax(1, m_workerCount / 2);
+    m_laneLimits[TranscodeLane] = qMax(1, KdenliveSettings::proxythreads());
+    m_taskPool.setMaxThreadCount(m_workerCount);
+    m_transcodePool.setMaxThreadCount(m_laneLimits[TranscodeLane]);
+    dispatchTasks();
+}
+
+TaskManager::TaskLane TaskManager::laneForTask(const AbstractTask *task) const
+{
+    switch (task->m_type) {
+    case AbstractTask::TRANSCODEJOB:
+    case AbstractTask::PROXYJOB:
+        // We only want a limited concurrent jobs for those as for example GPU usually only accept 2 concurrent encoding jobs
+        return TranscodeLane;
+    default:
+        break;
+    }
+    if (task->m_owner.itemId == displayedClip) {
+        return InteractiveLane;
+    }
+    return task->m_type == AbstractTask::LOADJOB ? LoadLane : AnalysisLane;
+}
+
+void TaskManager::dispatchTasks()
+{
+    if (m_blockUpdates) {
+        return;
+    }
+    const qint64 now = m_clock.elapsed();
+    while (true) {
+        const int backgroundWorkers = m_runningTasks[LoadLane] + m_runningTasks[AnalysisLane];
+        const int sharedWorkers = m_runningTasks[InteractiveLane] + backgroundWorkers;
+        int lane = -1;
+        qint64 bestScore = 0;
+        for (int i = 0; i < LaneCount; ++i) {
+            if (m_pendingTasks[i].empty() || m_runningTasks[i] >= m_laneLimits[i]) {
+                continue;
+            }
+            if (i != TranscodeLane && sharedWorkers >= m_workerCount) {
+                continue;
+            }
+            if ((i == LoadLane || i == AnalysisLane) && backgroundWorkers >= qMax(1, m_workerCount - 1)) {
+                // Keep a worker available for the clip opened in the Clip Monitor
+                continue;
+            }
+            const qint64 score = LANE_HEAD_START[i] + now - m_pendingTasks[i].front().queuedAt;
+            if (lane == -1 || score > bestScore) {
+                lane = i;
+                bestScore = score;
+            }
+        }
+        if (lane == -1) {
+            break;
+        }
+        AbstractTask *task = m_pendingTasks[lane].front().task;
+        m_pendingTasks[lane].pop_front();
+        const QString key = resourceKey(task);
+        if (!key.isEmpty()) {
+            AbstractTask *owner = m_resourceOwners.value(key);
+            if (owner != nullptr && owner != task) {
+                // Another task is processing the same media, wait for it to reuse its result
+                m_coalescedTasks[key].append(task);
+                continue;
+            }
+            m_resourceOwners.insert(key, task);
+        }
+        m_startedTasks[task] = lane;
+        m_runningTasks[lane]++;
+        if (lane == TranscodeLane) {
+            m_transcodePool.start(task, task->m_priority);
+        } else {
+            m_taskPool.start(task, task->m_priority);
+        }
+    }
+}
+
+bool TaskManager::tryTakeTask(AbstractTask *task)
+{
+    for (auto &queue : m_pendingTasks) {
+        for (auto it = queue.begin(); it != queue.end(); ++it) {
+            if (it->task == task) {
+                queue.erase(it);
+                return true;
+            }
+        }
+    }
+    for (auto &waiting : m_coalescedTasks) {
+        if (waiting.removeOne(task)) {
+            return true;
+        }
+    }
+    auto started = m_startedTasks.find(task);
+    if (started == m_startedTasks.end()) {
+        return false;
+    }
+    QThreadPool &pool = started->second == TranscodeLane ? m_transcodePool : m_taskPool;
+    if (pool.tryTake(task)) {
+        releaseTask(task);
+        return true;
+    }
+    return false;
+}
+
+void TaskManager::releaseTask(AbstractTask *task)
+{
+    auto started = m_startedTasks.find(task);
+    if (started != m_startedTasks.end()) {
+        m_runningTasks[started->second]--;
+        m_startedTasks.erase(started);
+    }
+    const QString key = resourceKey(task);
+    if (key.isEmpty() || m_resourceOwners.value(key) != task) {
+        return;
+    }
+    m_resourceOwners.remove(key);
+    // Restart the tasks that were waiting for this one, they will find its result in the cache
+    const QList<AbstractTask *> waiting = m_coalescedTasks.take(key);
+    for (AbstractTask *t : waiting) {
+        m_pendingTasks[laneForTask(t)].push_back({t, m_clock.elapsed()});
+    }
+}
+
+QString TaskManager::resourceKey(const AbstractTask *task)
+{
+    if (task->m_resource.isEmpty()) {
+        return QString();
+    }
+    return QStringLiteral("%1:%2").arg(int(task->m_type)).arg(task->m_resource);
+}
+
+void TaskManager::setDisplayedClip(int clipId)
+{
+    QWriteLocker lk(&m_tasksListLock);
+    displayedClip = clipId;
+    if (clipId < 0) {
+        return;
+    }
+    // Promote the pending tasks of this clip, keeping the interactive lane sorted by age
+    std::deque<PendingTask> &interactive = m_pendingTasks[InteractiveLane];
+    for (int lane : {LoadLane, AnalysisLane}) {
+        std::deque<PendingTask> &queue = m_pendingTasks[lane];
+        for (auto it = queue.begin(); it != queue.end();) {
+            if (it->task->m_owner.itemId != clipId) {
+                ++it;
+                continue;
+            }
+            auto pos = std::upper_bound(interactive.begin(), interactive.end(), it->queuedAt,
+                                        [](qint64 queuedAt, const PendingTask &pending) { return queuedAt < pending.queuedAt; });
+            interactive.insert(pos, *it);
+            it = queue.erase(it);
+        }
+    }
+    dispatchTasks();
 }
 
 void TaskManager::discardJobs(const ObjectId &owner, AbstractTask::JOBTYPE type, bool softDelete, const QVector<AbstractTask::JOBTYPE> exceptions)
@@ -70,34 +235,24 @@ void TaskManager::discardJobs(const ObjectId &owner, AbstractTask::JOBTYPE type,
             ix--;
             continue;
         }
-        if (taskType != AbstractTask::TRANSCODEJOB && taskType != AbstractTask::PROXYJOB) {
-            if (m_taskPool.tryTake(t)) {
-                // Task was not started yet, we can simply delete
-                m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t),
-                                               m_taskList[owner.itemId].end());
-                delete t;
-                ix--;
-                continue;
-            }
-        } else {
-            if (m_transcodePool.tryTake(t)) {
-                // Task was not started yet, we can simply delete
-                m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t),
-                                               m_taskList[owner.itemId].end());
-                delete t;
-                ix--;
-                continue;
-            }
+        if (tryTakeTask(t)) {
+            // Task was not started yet, we can simply delete
+            m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t), m_taskList[owner.itemId].end());
+            delete t;
+            ix--;
+            continue;
         }
         if (t->cancelJob(softDelete)) {
             // Block until the task is finished
             m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t), m_taskList[owner.itemId].end());
             t->m_runMutex.lock();
             t->m_runMutex.unlock();
+            releaseTask(t);
             t->deleteLater();
         }
         ix--;
     }
+    dispatchTasks();
 }
 
 void TaskManager::discardJob(const ObjectId &owner, const QUuid &uuid)
@@ -120,34 +275,24 @@ void TaskManager::discardJob(const ObjectId &owner, const QUuid &uuid)
             ix--;
             continue;
         }
-        if (taskType != AbstractTask::TRANSCODEJOB && taskType != AbstractTask::PROXYJOB) {
-            if (m_taskPool.tryTake(t)) {
-                // Task was not started yet, we can simply delete
-                m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t),
-                                               m_taskList[owner.itemId].end());
-                delete t;
-                ix--;
-                continue;
-            }
-        } else {
-            if (m_transcodePool.tryTake(t)) {
-                // Task was not started yet, we can simply delete
-                m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t),
-                                               m_taskList[owner.itemId].end());
-                delete t;
-                ix--;
-                continue;
-            }
+        if (tryTakeTask(t)) {
+            // Task was not started yet, we can simply delete
+            m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t), m_taskList[owner.itemId].end());
+            delete t;
+            ix--;
+            continue;
         }
         if (t->cancelJob()) {
             m_taskList[owner.itemId].erase(std::remove(m_taskList[owner.itemId].begin(), m_taskList[owner.itemId].end(), t), m_taskList[owner.itemId].end());
             // Block until the task is finished
             t->m_runMutex.lock();
             t->m_runMutex.unlock();
+            releaseTask(t);
             t->deleteLater();
         }
         ix--;
     }
+    dispatchTasks();
 }
 
 bool TaskManager::hasPendingJob(const ObjectId &owner, AbstractTask::JOBTYPE type) const
@@ -188,11 +333,14 @@ TaskManagerStatus TaskManager::jobStatus(const ObjectId &owner) const
 void TaskManager::taskDone(int cid, AbstractTask *task)
 {
     // This will be executed in the QRunnable job thread
+    m_tasksListLock.lockForWrite();
+    releaseTask(task);
     if (m_blockUpdates) {
         // We are closing, tasks will be handled on close
+        m_tasksListLock.unlock();
         return;
     }
-    m_tasksListLock.lockForWrite();
+    dispatchTasks();
     if (!m_taskList.empty() && m_taskList.find(cid) != m_taskList.end()) {
         m_taskList[cid].erase(std::remove(m_taskList[cid].begin(), m_taskList[cid].end(), task), m_taskList[cid].end());
         if (m_taskList[cid].size() == 0) {
@@ -229,22 +377,12 @@ void TaskManager::slotCancelJobs(bool leaveBlocked, const QVector<AbstractTask::
                 ix--;
                 continue;
             }
-            if (taskType != AbstractTask::TRANSCODEJOB && taskType != AbstractTask::PROXYJOB) {
-                if (m_taskPool.tryTake(t)) {
-                    // Task was not started yet, we can simply delete
-                    qDebug() << "** DELETED  1 TASK from task pool: " << taskType;
-                    delete t;
-                    ix--;
-                    continue;
-                }
-            } else {
-                if (m_transcodePool.tryTake(t)) {
-                    // Task was not started yet, we can simply delete
-                    qDebug() << "** DELETED  1 TASK from transcode pool: " << taskType;
-                    delete t;
-                    ix--;
-                    continue;
-                }
+            if (tryTakeTask(t)) {
+                // Task was not started yet, we can simply delete
+                qDebug() << "** DELETED  1 TASK from task queue: " << taskType;
+                delete t;
+                ix--;
+                continue;
             }
             if (m_taskList.find(task.first) != m_taskList.end()) {
                 // If so, then just add ourselves to be notified upon completion.
@@ -252,6 +390,7 @@ void TaskManager::slotCancelJobs(bool leaveBlocked, const QVector<AbstractTask::
                 t->cancelJob();
                 t->m_runMutex.lock();
                 t->m_runMutex.unlock();
+                releaseTask(t);
                 t->deleteLater();
                 qDebug() << "** CLOSING 1 TASK DONE : " << taskType;
             }
@@ -271,17 +410,27 @@ void TaskManager::slotCancelJobs(bool leaveBlocked, const QVector<AbstractTask::
         QWriteLocker lock(&m_tasksListLock);
         m_taskList.clear();
         m_taskPool.clear();
+        for (auto &queue : m_pendingTasks) {
+            queue.clear();
+        }
+        m_runningTasks.fill(0);
+        m_startedTasks.clear();
+        m_resourceOwners.clear();
+        m_coalescedTasks.clear();
     }
     if (!leaveBlocked) {
         // Set jobs count
         Q_EMIT jobCount(0);
-        m_blockUpdates = false;
+        unBlock();
     }
 }
 
 void TaskManager::unBlock()
 {
+    QWriteLocker lk(&m_tasksListLock);
     m_blockUpdates = false;
+    // Start the tasks that were kept while canceling
+    dispatchTasks();
 }
 
 void TaskManager::startTask(int ownerId, AbstractTask *task)
@@ -302,15 +451,11 @@ void TaskManager::startTask(int ownerId, AbstractTask *task)
     for (const auto &task : m_taskList) {
         count += task.second.size();
     }
+    m_pendingTasks[laneForTask(task)].push_back({task, m_clock.elapsed()});
+    dispatchTasks();
     m_tasksListLock.unlock();
     // Set jobs count
     Q_EMIT jobCount(count);
-    if (task->m_type == AbstractTask::TRANSCODEJOB || task->m_type == AbstractTask::PROXYJOB) {
-        // We only want a limited concurrent jobs for those as for example GPU usually only accept 2 concurrent encoding jobs
-        m_transcodePool.start(task, task->m_priority);
-    } else {
-        m_taskPool.start(task, task->m_priority);
-    }
 }
 
 int TaskManager::getJobProgressForClip(const ObjectId &owner)
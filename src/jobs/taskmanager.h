@@ -12,11 +12,15 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "definitions.h"
 
 #include <QAbstractListModel>
+#include <QElapsedTimer>
 #include <QFutureWatcher>
+#include <QHash>
 #include <QObject>
 #include <QReadWriteLock>
 #include <QThreadPool>
 #include <QUuid>
+#include <array>
+#include <deque>
 #include <map>
 #include <memory>
 #include <unordered_map>
@@ -29,10 +33,24 @@ Q_DECLARE_METATYPE(TaskManagerStatus)
 
 /** @class TaskManager
     @brief This class is responsible for clip jobs management.
+
+    Tasks are queued in scheduling lanes, each with its own concurrency limit:
+    - Interactive: tasks of the clip displayed in the Clip Monitor, a worker is always kept for them
+    - Load: clip loading
+    - Analysis: thumbnails, audio levels, scene detection and filter jobs
+    - Transcode: proxy and transcoding jobs, run in a separate pool
+    When a worker is free, the oldest task of the lanes below their limit is
+    started, each lane being given a head start. Waiting tasks age, so that
+    background work keeps progressing while many clips are loaded.
+
+    Tasks of the same type working on the same resource (see AbstractTask::m_resource),
+    like several clips using the same file, are coalesced: while one of them runs, the
+    others wait and are only started once it is finished, reusing its cached result.
  */
 class TaskManager : public QObject
 {
     Q_OBJECT
+    friend class KdenliveTests;
 
 public:
     explicit TaskManager(QObject *parent);
@@ -65,6 +83,9 @@ public:
     /** @brief Update the number of concurrent jobs allowed */
     void updateConcurrency();
 
+    /** @brief Set the clip opened in Clip Monitor, its pending tasks are moved to the interactive lane */
+    void setDisplayedClip(int clipId);
+
     /** @brief We are aborting all tasks and don't want them to send any updates */
     bool isBlocked() const;
 
@@ -79,11 +100,43 @@ public Q_SLOTS:
     void slotCancelJobs(bool leaveBlocked = false, const QVector<AbstractTask::JOBTYPE> exceptions = {});
 
 private:
+    enum TaskLane { InteractiveLane = 0, LoadLane, AnalysisLane, TranscodeLane, LaneCount };
+    struct PendingTask
+    {
+        AbstractTask *task;
+        // Time at which the task was queued, in ms from m_clock start
+        qint64 queuedAt;
+    };
     QThreadPool m_taskPool;
     QThreadPool m_transcodePool;
     std::unordered_map<int, std::vector<AbstractTask*> > m_taskList;
     mutable QReadWriteLock m_tasksListLock;
     bool m_blockUpdates;
+    /** @brief Tasks waiting for a free slot in their lane, oldest first */
+    std::array<std::deque<PendingTask>, LaneCount> m_pendingTasks;
+    /** @brief Number of tasks handed to the thread pools for each lane */
+    std::array<int, LaneCount> m_runningTasks;
+    /** @brief The lane of each task handed to the thread pools */
+    std::unordered_map<AbstractTask *, int> m_startedTasks;
+    std::array<int, LaneCount> m_laneLimits;
+    /** @brief Number of threads shared by the interactive, load and analysis lanes */
+    int m_workerCount;
+    QElapsedTimer m_clock;
+    /** @brief The lane in which a new task is queued */
+    TaskLane laneForTask(const AbstractTask *task) const;
+    /** @brief Start pending tasks while their lanes have free slots. Called with m_tasksListLock locked for write */
+    void dispatchTasks();
+    /** @brief Remove a task that was not started yet. Called with m_tasksListLock locked for write */
+    bool tryTakeTask(AbstractTask *task);
+    /** @brief The key identifying the job type and resource of a task, empty if the task has no resource */
+    static QString resourceKey(const AbstractTask *task);
+    /** @brief Started task owning each resource key */
+    QHash<QString, AbstractTask *> m_resourceOwners;
+    /** @brief Tasks waiting for the task owning a resource to finish */
+    QHash<QString, QList<AbstractTask *>> m_coalescedTasks;
+    /** @brief Free the lane slot and the resources used by a finished or canceled task.
+     *  Called with m_tasksListLock locked for write */
+    void releaseTask(AbstractTask *task);
 
 Q_SIGNALS:
     void jobCount(int);
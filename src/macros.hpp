@@ -28,20 +28,37 @@
         return res_lambda;                                                                                                                                     \
     };
 
-/** This convenience macro locks the mutex for reading.
-Note that it might happen that a thread is executing a write operation that requires
-reading a Read-protected property. In that case, we try to write lock it first (this will be granted since the lock is recursive)
-*/
-#define READ_LOCK()                                                                                                                                            \
-    std::unique_ptr<QReadLocker> rlocker(new QReadLocker(nullptr));                                                                                            \
-    std::unique_ptr<QWriteLocker> wlocker(new QWriteLocker(nullptr));                                                                                          \
-    if (m_lock.tryLockForWrite()) {                                                                                                                            \
-        /*we yield ownership of the lock to the WriteLocker*/                                                                                                  \
-        m_lock.unlock();                                                                                                                                       \
-        wlocker.reset(new QWriteLocker(&m_lock));                                                                                                              \
-    } else {                                                                                                                                                   \
-        rlocker.reset(new QReadLocker(&m_lock));                                                                                                               \
+#include <QReadWriteLock>
+
+/** @brief Scoped lock used by READ_LOCK(), without heap allocation.
+ * A read lock is taken when possible, so that readers don't block each other. If it is refused, the current thread
+ * might be executing a write operation that requires reading a Read-protected property. In that case we take the
+ * write lock, which will be granted since the lock is recursive (asking for a read lock would deadlock).
+ * A read lock cannot be upgraded: functions using READ_LOCK() must not call anything taking the write lock.
+ * Readers run concurrently, so functions that modify the object, including lazy initialization, must take the write lock.
+ */
+class ReadLockGuard
+{
+public:
+    explicit ReadLockGuard(QReadWriteLock &lock)
+        : m_guardedLock(lock)
+    {
+        if (!lock.tryLockForRead() && !lock.tryLockForWrite()) {
+            // Another thread is writing
+            lock.lockForRead();
+        }
     }
+    ~ReadLockGuard() { m_guardedLock.unlock(); }
+    ReadLockGuard(const ReadLockGuard &) = delete;
+    ReadLockGuard &operator=(const ReadLockGuard &) = delete;
+
+private:
+    QReadWriteLock &m_guardedLock;
+};
+
+/** This convenience macro locks the mutex for reading, see ReadLockGuard.
+ */
+#define READ_LOCK() ReadLockGuard readLockGuard(m_lock);
 
 /** @brief This macro takes some lambdas that represent undo/redo for an operation and the text (name) associated with this operation
  * The lambdas are transformed to make sure they lock access to the class they operate on.
@@ -60,14 +77,8 @@ reading a Read-protected property. In that case, we try to write lock it first (
  * This should be used in the rare case where we don't need a lock mutex. In general, prefer the other version
  */
 #define UPDATE_UNDO_REDO_NOLOCK(operation, reverse, undo, redo)                                                                                                \
-    undo = [reverse, undo]() {                                                                                                                                 \
-        bool v = reverse();                                                                                                                                    \
-        return undo() && v;                                                                                                                                    \
-    };                                                                                                                                                         \
-    redo = [operation, redo]() {                                                                                                                               \
-        bool v = redo();                                                                                                                                       \
-        return operation() && v;                                                                                                                               \
-    };
+    appendOperation(undo, reverse, OperationLog::Backward);                                                                                                    \
+    appendOperation(redo, operation, OperationLog::Forward);
 /** @brief This macro takes as parameter one atomic operation and its reverse, and update
  *  the undo and redo functional stacks/queue accordingly
  *  It will also ensure that operation and reverse are dealing with mutexes
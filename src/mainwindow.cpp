@@ -68,6 +68,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "titler/titlewidget.h"
 #include "transitions/transitionlist/view/transitionlistwidget.hpp"
 #include "transitions/transitionsrepository.hpp"
+#include "utils/cachemanager.hpp"
 #include "utils/thememanager.h"
 #include "widgets/progressbutton.h"
 #include <config-kdenlive.h>
@@ -2666,6 +2667,7 @@ void MainWindow::updateConfiguration()
     m_buttonAudioThumbs->setChecked(KdenliveSettings::audiothumbnails());
     m_buttonVideoThumbs->setChecked(KdenliveSettings::videothumbnails());
     m_buttonShowMarkers->setChecked(KdenliveSettings::showmarkers());
+    updateCacheBudget();
 
     // Update list of transcoding profiles
     buildDynamicActions();
@@ -4613,6 +4615,8 @@ void MainWindow::resetSubtitles(const QUuid &uuid)
         std::shared_ptr<TimelineItemModel> timeline = pCore->currentDoc()->getTimeline(uuid);
         if (timeline && timeline->hasSubtitleModel()) {
             auto subModel = timeline->getSubtitleModel();
+            // Don't write the work files back once deleted
+            subModel->cancelWorkFileUpdate();
             QMap<std::pair<int, QString>, QString> currentSubs = subModel->getSubtitlesList();
             QMapIterator<std::pair<int, QString>, QString> i(currentSubs);
             while (i.hasNext()) {
@@ -4985,7 +4989,14 @@ void MainWindow::processRestoreState(const QByteArray &state)
 
 void MainWindow::checkMaxCacheSize()
 {
-    if (KdenliveSettings::lastCacheCheck().daysTo(QDateTime::currentDateTime()) < 14) {
+    updateCacheBudget();
+    // Read the cache index, or walk the cache folder if there is none, without blocking the first cache writes
+    CacheManager::get()->scheduleIndexLoad();
+    const bool periodicCheck = KdenliveSettings::lastCacheCheck().daysTo(QDateTime::currentDateTime()) >= 14;
+    if (KdenliveSettings::autocleancache()) {
+        CacheManager::get()->scheduleEviction(periodicCheck);
+    }
+    if (!periodicCheck) {
         return;
     }
     if (KdenliveSettings::checkForUpdate()) {
@@ -5030,52 +5041,22 @@ void MainWindow::checkMaxCacheSize()
 
     KdenliveSettings::setLastCacheCheck(QDateTime::currentDateTime());
     // Check cached data size
-    if (KdenliveSettings::maxcachesize() <= 0 || pCore->currentDoc() == nullptr) {
+    if (KdenliveSettings::maxcachesize() <= 0 || KdenliveSettings::autocleancache()) {
         return;
     }
-    bool ok;
-    KIO::filesize_t total = 0;
-    QDir cacheDir = pCore->currentDoc()->getCacheDir(SystemCacheRoot, &ok);
-    if (!ok) {
-        return;
-    }
-    QDir backupFolder(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/.backup"));
-    QList<QDir> toAdd;
-    QList<QDir> toRemove;
-    if (cacheDir.exists()) {
-        toAdd << cacheDir;
-    }
-    if (backupFolder.exists()) {
-        toAdd << cacheDir;
-    }
-    if (cacheDir.cd(QStringLiteral("knewstuff"))) {
-        toRemove << cacheDir;
-        cacheDir.cdUp();
-    }
-    if (cacheDir.cd(QStringLiteral("attica"))) {
-        toRemove << cacheDir;
-        cacheDir.cdUp();
-    }
-    if (cacheDir.cd(QStringLiteral("proxy"))) {
-        toRemove << cacheDir;
-        cacheDir.cdUp();
-    }
-    pCore->displayMessage(i18n("Checking cached data size"), InformationMessage);
-    while (!toAdd.isEmpty()) {
-        QDir dir = toAdd.takeFirst();
-        KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(dir.absolutePath()));
-        job->exec();
-        total += job->totalSize();
-    }
-    while (!toRemove.isEmpty()) {
-        QDir dir = toRemove.takeFirst();
-        KIO::DirectorySizeJob *job = KIO::directorySize(QUrl::fromLocalFile(dir.absolutePath()));
-        job->exec();
-        total -= job->totalSize();
-    }
-    if (total > KIO::filesize_t(1048576) * KdenliveSettings::maxcachesize()) {
-        slotManageCache();
-    }
+    // Rebuild the cache index in case files were changed outside of Kdenlive, nothing is evicted without a budget
+    const qint64 maxSize = qint64(1048576) * KdenliveSettings::maxcachesize();
+    CacheManager::get()->scheduleEviction(true).then(this, [this, maxSize]() {
+        if (CacheManager::get()->totalSize() > maxSize) {
+            slotManageCache();
+        }
+    });
+}
+
+void MainWindow::updateCacheBudget()
+{
+    const bool autoClean = KdenliveSettings::autocleancache() && KdenliveSettings::maxcachesize() > 0;
+    CacheManager::get()->setBudget(autoClean ? qint64(1048576) * KdenliveSettings::maxcachesize() : 0);
 }
 
 void MainWindow::manageClipJobs(AbstractTask::JOBTYPE type, QWidget *parentWidget)
@@ -338,6 +338,8 @@ private:
     void buildDynamicActions();
     void loadClipActions();
     void loadContainerActions();
+    /** @brief Apply the cached data size limit to the cache manager, if automatic cleanup is enabled. */
+    void updateCacheBudget();
 
     QTime m_timer;
     KXMLGUIClient *m_extraFactory;
@@ -1943,7 +1943,7 @@ bool Monitor::slotOpenClip(const std::shared_ptr<ProjectClip> &controller, int i
         }
     } else if (controller == nullptr) {
         // Nothing to do
-        pCore->taskManager.displayedClip = -1;
+        pCore->taskManager.setDisplayedClip(-1);
         m_displayedUuid = QUuid();
         m_dirty = false;
         return true;
@@ -1956,7 +1956,7 @@ bool Monitor::slotOpenClip(const std::shared_ptr<ProjectClip> &controller, int i
     m_glMonitor->getControllerProxy()->clearJobsProgress();
     if (controller == nullptr) {
         // We had another clip displayed, reset
-        pCore->taskManager.displayedClip = -1;
+        pCore->taskManager.setDisplayedClip(-1);
         m_markerModel = nullptr;
         loadQmlScene(MonitorSceneDefault);
         m_glMonitor->setProducer(nullptr, isActive(), -1);
@@ -1980,7 +1980,7 @@ bool Monitor::slotOpenClip(const std::shared_ptr<ProjectClip> &controller, int i
         }
         return true;
     } else {
-        pCore->taskManager.displayedClip = m_controller->clipId().toInt();
+        pCore->taskManager.setDisplayedClip(m_controller->clipId().toInt());
         if (m_controller->clipType() == ClipType::Timeline) {
             if (m_displayedUuid != m_controller->getSequenceUuid()) {
                 m_dirty = false;
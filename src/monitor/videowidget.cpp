@@ -181,8 +181,10 @@ QImage VideoWidget::image() const
         if (image) {
             int width = frame.get_image_width();
             int height = frame.get_image_height();
-            QImage temp(image, width, height, QImage::Format_RGBA8888);
-            return temp.copy();
+            // Wrap the frame data without copying, the image keeps a reference on the frame until it is destroyed
+            auto *ref = new SharedFrame(frame);
+            return QImage(
+                image, width, height, width * 4, QImage::Format_RGBA8888, [](void *info) { delete static_cast<SharedFrame *>(info); }, ref);
         }
     }
     return QImage();
@@ -10,6 +10,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "core.h"
 #include "doc/kdenlivedoc.h"
 #include "kdenlivesettings.h"
+#include "utils/cachemanager.hpp"
 
 #include <KLocalizedString>
 #include <KMessageBox>
@@ -355,6 +356,7 @@ void TemporaryData::deletePreview()
     }
     if (dir.dirName() == QLatin1String("preview")) {
         dir.removeRecursively();
+        CacheManager::get()->recordRemoval(dir.absolutePath());
         dir.mkpath(QStringLiteral("."));
         Q_EMIT disablePreview();
         updateDataInfo();
@@ -733,6 +735,7 @@ void TemporaryData::deleteCache(QStringList &folders)
         }
         QDir toRemove(m_globalDir.filePath(folder));
         toRemove.removeRecursively();
+        CacheManager::get()->recordRemoval(toRemove.absolutePath());
     }
     updateGlobalInfo();
 }
@@ -749,6 +752,7 @@ void TemporaryData::deleteProxy()
     }
     QDir toRemove(m_globalDir.filePath(QStringLiteral("proxy")));
     toRemove.removeRecursively();
+    CacheManager::get()->recordRemoval(toRemove.absolutePath());
     // We deleted proxy folder, recreate it
     toRemove.mkpath(QStringLiteral("."));
     processProxyDirectory();
@@ -781,6 +785,7 @@ void TemporaryData::cleanProxy()
     }
     for (const QString &f : std::as_const(oldFiles)) {
         proxies.remove(f);
+        CacheManager::get()->recordRemoval(proxies.absoluteFilePath(f));
     }
     processProxyDirectory();
 }
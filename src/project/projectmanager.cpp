@@ -22,6 +22,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "project/dialogs/noteswidget.h"
 #include "project/dialogs/projectsettings.h"
 #include "timeline2/model/timelinefunctions.hpp"
+#include "utils/cachemanager.hpp"
 #include "utils/qstringutils.h"
 #include "utils/thumbnailcache.hpp"
 #include "xml/xml.hpp"
@@ -62,6 +63,13 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include <QTimeZone>
 #include <QUndoGroup>
 
+// Longest acceptable interface freeze (in ms) when taking an autosave snapshot
+static constexpr qint64 AUTOSAVE_PAUSE_BUDGET = 20;
+// Once a snapshot went over the budget, the next ones wait until the project was not edited for that long (in ms)
+static constexpr qint64 AUTOSAVE_IDLE_DELAY = 15000;
+// Longest time (in ms) without a backup, an autosave is never deferred past it
+static constexpr qint64 AUTOSAVE_MAX_DELAY = 300000;
+
 static QString getProjectNameFilters(bool ark = true)
 {
     QString filter = i18n("Kdenlive Project") + QStringLiteral(" (*.kdenlive)");
@@ -80,6 +88,8 @@ ProjectManager::ProjectManager(QObject *parent)
     QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
     dir.mkpath(QStringLiteral(".backup"));
     dir.mkdir(QStringLiteral("titles"));
+    // Never evict the cached data of the open project
+    connect(this, &ProjectManager::docOpened, this, [](KdenliveDoc *document) { CacheManager::get()->setProtected(document->cachedDataPaths()); });
 }
 
 ProjectManager::~ProjectManager() = default;
@@ -288,6 +298,7 @@ void ProjectManager::newFile(QString profileName, bool showProjectSettings)
     Q_EMIT pCore->gotMissingClipsCount(0, 0);
     m_project->loading = false;
     m_lastSave.start();
+    m_autoSaveSnapshotDuration = 0;
     if (pCore->monitorManager()) {
         Q_EMIT pCore->monitorManager()->updatePreviewScaling();
         pCore->monitorManager()->projectMonitor()->slotActivateMonitor();
@@ -579,6 +590,7 @@ bool ProjectManager::saveFileAs(const QString &outputFileName, bool saveOverExis
         // This timer is set by KdenliveDoc::setModified()
         const QString projectId = QCryptographicHash::hash(url.fileName().toUtf8(), QCryptographicHash::Md5).toHex();
         QUrl autosaveUrl = QUrl::fromLocalFile(QFileInfo(outputFileName).absoluteDir().absoluteFilePath(projectId + QStringLiteral(".kdenlive")));
+        m_project->waitForAutoSave();
         if (m_project->m_autosave == nullptr) {
             // The temporary file is not opened or created until actually needed.
             // The file filename does not have to exist for KAutoSaveFile to be constructed (if it exists, it will not be touched).
@@ -682,6 +694,7 @@ bool ProjectManager::saveFile()
         return saveFileAs();
     }
     bool result = saveFileAs(m_project->url().toLocalFile());
+    m_project->waitForAutoSave();
     m_project->m_autosave->resize(0);
     return result;
 }
@@ -1066,6 +1079,7 @@ void ProjectManager::doOpenFile(const QUrl &url, KAutoSaveFile *stale, bool isBa
 
     pCore->displayMessage(QString(), OperationCompletedMessage, 100);
     m_lastSave.start();
+    m_autoSaveSnapshotDuration = 0;
     m_project->loading = false;
     checkProjectWarnings();
     pCore->projectItemModel()->missingClipTimer.start();
@@ -1204,7 +1218,8 @@ KRecentFilesAction *ProjectManager::recentFilesAction()
 
 void ProjectManager::slotStartAutoSave()
 {
-    if (m_lastSave.elapsed() > 300000) {
+    m_lastEdit.start();
+    if (m_lastSave.elapsed() > AUTOSAVE_MAX_DELAY) {
         // If the project was not saved in the last 5 minute, force save
         m_autoSaveTimer.stop();
         slotAutoSave();
@@ -1219,23 +1234,31 @@ void ProjectManager::slotAutoSave()
         // Dont start autosave if the project is still loading
         return;
     }
-    prepareSave();
-    QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
-    QString scene = projectSceneList(saveFolder).first;
-    if (!m_replacementPattern.isEmpty()) {
-        QMapIterator<QString, QString> i(m_replacementPattern);
-        while (i.hasNext()) {
-            i.next();
-            scene.replace(i.key(), i.value());
-        }
-    }
-    if (!scene.contains(QLatin1String("<track "))) {
-        // In some unexplained cases, the MLT playlist is corrupted and all tracks are deleted. Don't save in that case.
-        pCore->displayMessage(i18n("Project was corrupted, cannot backup. Please close and reopen your project file to recover last backup"), ErrorMessage);
+    if (m_project->autoSaveRunning()) {
+        // Previous backup is still being written, try again later
+        m_autoSaveTimer.start();
         return;
     }
-    m_project->slotAutoSave(scene);
+    if (m_autoSaveSnapshotDuration > AUTOSAVE_PAUSE_BUDGET && m_lastSave.elapsed() < AUTOSAVE_MAX_DELAY) {
+        // The last snapshot froze the interface for too long, only take the next one when the user pauses
+        const bool editing = m_lastEdit.isValid() && m_lastEdit.elapsed() < AUTOSAVE_IDLE_DELAY;
+        if (editing || (pCore->monitorManager() && pCore->monitorManager()->projectMonitor()->isPlaying())) {
+            m_autoSaveTimer.start();
+            return;
+        }
+    }
+    // Only the MLT snapshot is taken here, the rest of the work is done by a worker thread in KdenliveDoc::slotAutoSave
+    QElapsedTimer pause;
+    pause.start();
+    prepareSave();
+    QString saveFolder = m_project->url().adjusted(QUrl::RemoveFilename | QUrl::StripTrailingSlash).toLocalFile();
+    const QString scene = projectSceneList(saveFolder).first;
+    m_project->slotAutoSave(scene, m_replacementPattern);
     m_lastSave.start();
+    m_autoSaveSnapshotDuration = pause.elapsed();
+    if (m_autoSaveSnapshotDuration > AUTOSAVE_PAUSE_BUDGET) {
+        qCDebug(KDENLIVE_LOG) << "Autosave blocked the interface for" << m_autoSaveSnapshotDuration << "ms, deferring the next ones to idle times";
+    }
 }
 
 std::pair<QString, QString> ProjectManager::projectSceneList(const QString &outputFolder, bool timelineProducerOnly, const QString &overlayData,
@@ -242,7 +242,10 @@ private Q_SLOTS:
     void updateSequenceDuration(const QUuid &uuid);
     /** @brief Open the project's backupdialog. */
     bool slotOpenBackup(const QUrl &url = QUrl());
-    /** @brief Start autosaving the document. */
+    /** @brief Start autosaving the document.
+     *
+     * Once taking the snapshot blocked the interface for longer than the budget, autosaves are
+     * deferred until the project is not edited nor played, at most until the last backup is 5 minutes old. */
     void slotAutoSave();
     /** @brief Report progress of folder move operation. */
     void slotMoveProgress(KJob *, unsigned long progress);
@@ -268,6 +271,10 @@ private:
 
     std::shared_ptr<TimelineItemModel> m_activeTimelineModel;
     QElapsedTimer m_lastSave;
+    /** @brief Time since the project was last modified */
+    QElapsedTimer m_lastEdit;
+    /** @brief How long (in ms) the last autosave snapshot blocked the interface */
+    qint64 m_autoSaveSnapshotDuration{0};
     QTimer m_autoSaveTimer;
     QUrl m_startUrl;
     QString m_loadClipsOnOpen;
@@ -6,6 +6,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "histogramgenerator.h"
+#include "scopekernels.h"
 
 #include "klocalizedstring.h"
 #include <QDebug>
@@ -29,43 +30,59 @@ QImage HistogramGenerator::calculateHistogram(const QSize &paradeSize, qreal sca
     bool drawB = (components & HistogramGenerator::ComponentB) != 0;
     bool drawSum = (components & HistogramGenerator::ComponentSum) != 0;
 
-    int r[256], g[256], b[256], y[256], s[766];
-    // Initialize the values to zero
-    std::fill(r, r + 256, 0);
-    std::fill(g, g + 256, 0);
-    std::fill(b, b + 256, 0);
-    std::fill(y, y + 256, 0);
-    std::fill(s, s + 766, 0);
+    // Per band bins, merged once all bands are done
+    struct Bins
+    {
+        int r[256] = {};
+        int g[256] = {};
+        int b[256] = {};
+        int y[256] = {};
+        int s[766] = {};
+    };
 
     const int ww = paradeSize.width();
     const int wh = paradeSize.height();
 
     // Read the stats from the input image
-    for (int Y = 0; Y < image.height(); ++Y) {
-        for (int X = 0; X < image.width(); X += accelFactor) {
-
-            QRgb col = image.pixel(X, Y);
-            r[qRed(col)]++;
-            g[qGreen(col)]++;
-            b[qBlue(col)]++;
-
-            if (drawY) {
-                // Use if branch to avoid expensive multiplication if Y disabled
-                if (rec == ITURec::Rec_601) {
-                    y[int(REC_601_R * qRed(col) + REC_601_G * qGreen(col) + REC_601_B * qBlue(col))]++;
-                } else {
-                    y[int(REC_709_R * qRed(col) + REC_709_G * qGreen(col) + REC_709_B * qBlue(col))]++;
-                }
-            }
-
-            if (drawSum) {
-                // Use an if branch here because the sum takes more operations than rgb
-                s[qRed(col)]++;
-                s[qGreen(col)]++;
-                s[qBlue(col)]++;
+    const QImage source = ScopeKernels::toRgb32(image);
+    const int step = int(qMax(1u, accelFactor));
+    const int iw = source.width();
+    const ScopeKernels::LumaWeights weights = ScopeKernels::lumaWeights(rec);
+    // Sampling restarts at the beginning of each row, hence accelFactor 1 for the row offsets
+    const std::vector<Bins> bands = ScopeKernels::accumulateRows(source, 1, Bins(), [&](const QRgb *line, int, int, Bins &bins) {
+        for (int X = 0; X < iw; X += step) {
+            const QRgb col = line[X];
+            bins.r[qRed(col)]++;
+            bins.g[qGreen(col)]++;
+            bins.b[qBlue(col)]++;
+        }
+        if (drawY) {
+            for (int X = 0; X < iw; X += step) {
+                bins.y[ScopeKernels::luma8(line[X], weights) >> 8]++;
             }
         }
+    });
+
+    Bins total;
+    for (const Bins &bins : bands) {
+        for (int i = 0; i < 256; ++i) {
+            total.r[i] += bins.r[i];
+            total.g[i] += bins.g[i];
+            total.b[i] += bins.b[i];
+            total.y[i] += bins.y[i];
+        }
+    }
+    if (drawSum) {
+        // The sum histogram only depends on the r, g and b ones
+        for (int i = 0; i < 256; ++i) {
+            total.s[i] += total.r[i] + total.g[i] + total.b[i];
+        }
     }
+    const int *r = total.r;
+    const int *g = total.g;
+    const int *b = total.b;
+    const int *y = total.y;
+    const int *s = total.s;
 
     const int nParts = (drawY ? 1 : 0) + (drawR ? 1 : 0) + (drawG ? 1 : 0) + (drawB ? 1 : 0) + (drawSum ? 1 : 0);
     if (nParts == 0) {
@@ -6,9 +6,11 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "rgbparadegenerator.h"
+#include "scopekernels.h"
 #include "klocalizedstring.h"
 #include <QColor>
 #include <QDebug>
+#include <QMutex>
 #include <QPainter>
 
 #define CHOP255(a) ((255) < (a) ? (255) : int(a))
@@ -51,84 +53,80 @@ QImage RGBParadeGenerator::calculateRGBParade(const QSize &paradeSize, qreal sca
 
     const uint ww = uint(paradeSize.width());
     const uint wh = uint(paradeSize.height());
-    const uint iw = uint(image.width());
-    const uint ih = uint(image.height());
+    const QImage source = ScopeKernels::toRgb32(image);
+    const int iw = source.width();
+    const int ih = source.height();
 
     const uchar offset = 10;
     const uint partW = (ww - 2 * offset - distRight) / 3;
     const uint partH = wh - distBottom;
 
-    // Statistics
-    uchar minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0;
-
     // Number of input pixels that will fall on one scope pixel.
     // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
-    const float pixelDepth = float((iw * ih) / accelFactor) / (partW * 255);
+    const float pixelDepth = float((qint64(iw) * ih) / accelFactor) / (partW * 255);
     const float gain = 255 / (8 * pixelDepth);
     //        qCDebug(KDENLIVE_LOG) << "Pixel depth: expected " << pixelDepth << "; Gain: using " << gain << " (acceleration: " << accelFactor << "x)";
 
     QImage unscaled(int(ww) - distRight, 256, QImage::Format_ARGB32);
     unscaled.fill(qRgba(0, 0, 0, 0));
 
-    const float wPrediv = float(partW - 1) / (iw - 1);
-
-    std::vector<std::vector<StructRGB>> paradeVals(partW, std::vector<StructRGB>(256, {0, 0, 0}));
-
-    const auto totalPixels = image.width() * image.height();
-    for (int i = 0; i < totalPixels; i += accelFactor) {
-        const auto x = i % image.width();
-        const QRgb pixel = image.pixel(x, i / image.width());
-        auto r = uchar(qRed(pixel));
-        auto g = uchar(qGreen(pixel));
-        auto b = uchar(qBlue(pixel));
-
-        double dx = x * double(wPrediv);
-
-        paradeVals[size_t(dx)][r].r++;
-        paradeVals[size_t(dx)][g].g++;
-        paradeVals[size_t(dx)][b].b++;
-
-        if (r < minR) {
-            minR = r;
-        }
-        if (g < minG) {
-            minG = g;
-        }
-        if (b < minB) {
-            minB = b;
-        }
-        if (r > maxR) {
-            maxR = r;
-        }
-        if (g > maxG) {
-            maxG = g;
-        }
-        if (b > maxB) {
-            maxB = b;
+    // Sample counts, indexed by [column * 256 + value]
+    std::vector<StructRGB> paradeVals(size_t(partW) * 256, {0, 0, 0});
+    const std::vector<int> columns = ScopeKernels::columnMap(iw, int(partW));
+
+    // Statistics, merged from all bands
+    struct MinMax
+    {
+        uchar minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0;
+    };
+    QMutex statsMutex;
+    MinMax stats;
+
+    // Each band owns a distinct set of parade columns, so all bands write to the same buffer
+    ScopeKernels::forEachColumnBand(columns, [&](int x0, int x1) {
+        MinMax local;
+        for (int y = 0; y < ih; ++y) {
+            const auto *line = reinterpret_cast<const QRgb *>(source.constScanLine(y));
+            for (int x = ScopeKernels::firstSampleFrom(y, iw, accelFactor, x0); x < x1; x += int(accelFactor)) {
+                const QRgb pixel = line[x];
+                const auto r = uchar(qRed(pixel));
+                const auto g = uchar(qGreen(pixel));
+                const auto b = uchar(qBlue(pixel));
+                StructRGB *column = paradeVals.data() + size_t(columns[size_t(x)]) * 256;
+                column[r].r++;
+                column[g].g++;
+                column[b].b++;
+                local.minR = qMin(local.minR, r);
+                local.minG = qMin(local.minG, g);
+                local.minB = qMin(local.minB, b);
+                local.maxR = qMax(local.maxR, r);
+                local.maxG = qMax(local.maxG, g);
+                local.maxB = qMax(local.maxB, b);
+            }
         }
-    }
+        QMutexLocker lock(&statsMutex);
+        stats.minR = qMin(stats.minR, local.minR);
+        stats.minG = qMin(stats.minG, local.minG);
+        stats.minB = qMin(stats.minB, local.minB);
+        stats.maxR = qMax(stats.maxR, local.maxR);
+        stats.maxG = qMax(stats.maxG, local.maxG);
+        stats.maxB = qMax(stats.maxB, local.maxB);
+    });
+    const uchar minR = stats.minR, minG = stats.minG, minB = stats.minB, maxR = stats.maxR, maxG = stats.maxG, maxB = stats.maxB;
 
     const int offset1 = int(partW + offset);
     const int offset2 = int(2 * partW + 2 * offset);
-    switch (paintMode) {
-    case PaintMode_RGB:
+    const QRgb colR = paintMode == PaintMode_RGB ? qRgb(255, 10, 10) : qRgb(255, 255, 255);
+    const QRgb colG = paintMode == PaintMode_RGB ? qRgb(10, 255, 10) : qRgb(255, 255, 255);
+    const QRgb colB = paintMode == PaintMode_RGB ? qRgb(10, 10, 255) : qRgb(255, 255, 255);
+    for (int j = 0; j < 256; ++j) {
+        auto *out = reinterpret_cast<QRgb *>(unscaled.scanLine(j));
         for (int i = 0; i < int(partW); ++i) {
-            for (int j = 0; j < 256; ++j) {
-                unscaled.setPixel(i, j, qRgba(255, 10, 10, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].r))));
-                unscaled.setPixel(i + offset1, j, qRgba(10, 255, 10, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].g))));
-                unscaled.setPixel(i + offset2, j, qRgba(10, 10, 255, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].b))));
-            }
-        }
-        break;
-    default:
-        for (int i = 0; i < int(partW); ++i) {
-            for (int j = 0; j < 256; ++j) {
-                unscaled.setPixel(i, j, qRgba(255, 255, 255, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].r))));
-                unscaled.setPixel(i + offset1, j, qRgba(255, 255, 255, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].g))));
-                unscaled.setPixel(i + offset2, j, qRgba(255, 255, 255, CHOP255(gain * float(paradeVals[size_t(i)][size_t(j)].b))));
-            }
+            const StructRGB &vals = paradeVals[size_t(i) * 256 + size_t(j)];
+            out[i] = (colR & RGB_MASK) | (uint(CHOP255(gain * float(vals.r))) << 24);
+            out[i + offset1] = (colG & RGB_MASK) | (uint(CHOP255(gain * float(vals.g))) << 24);
+            out[i + offset2] = (colB & RGB_MASK) | (uint(CHOP255(gain * float(vals.b))) << 24);
         }
-        break;
     }
 
     // Scale the image to the target height. Scaling is not accomplished before because
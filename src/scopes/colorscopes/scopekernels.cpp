@@ -0,0 +1,78 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+    This file is part of kdenlive. See www.kdenlive.org.
+
+SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "scopekernels.h"
+
+#include <QThread>
+
+QImage ScopeKernels::toRgb32(const QImage &image)
+{
+    switch (image.format()) {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+        return image;
+    default:
+        // Premultiplied formats are converted too, the scopes read unpremultiplied colors
+        return image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    }
+}
+
+QImage ScopeKernels::toRgb32(const QImage &image, QImage &buffer)
+{
+    QImage::Format target;
+    switch (image.format()) {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+        return image;
+    case QImage::Format_RGBX8888:
+        target = QImage::Format_RGB32;
+        break;
+    case QImage::Format_RGBA8888:
+        target = QImage::Format_ARGB32;
+        break;
+    default:
+        buffer = toRgb32(image);
+        return buffer;
+    }
+    if (buffer.size() != image.size() || buffer.format() != target || !buffer.isDetached()) {
+        buffer = QImage(image.size(), target);
+    }
+    // RGBA byte order to native endian 0xAARRGGBB, which is the same for both formats
+    const int width = image.width();
+    for (int y = 0; y < image.height(); ++y) {
+        const uchar *src = image.constScanLine(y);
+        auto *dst = reinterpret_cast<QRgb *>(buffer.scanLine(y));
+        for (int x = 0; x < width; ++x) {
+            dst[x] = qRgba(src[0], src[1], src[2], src[3]);
+            src += 4;
+        }
+    }
+    return buffer;
+}
+
+int ScopeKernels::bandCount(int units, int minPerBand, int maxBands)
+{
+    int threads = qMax(1, QThread::idealThreadCount());
+    if (maxBands > 0) {
+        threads = qMin(threads, maxBands);
+    }
+    return qBound(1, units / qMax(1, minPerBand), threads);
+}
+
+std::vector<int> ScopeKernels::columnMap(int imageWidth, int outputWidth)
+{
+    std::vector<int> map(size_t(qMax(0, imageWidth)), 0);
+    if (imageWidth <= 1 || outputWidth <= 1) {
+        return map;
+    }
+    // Same mapping as the former float based x * wPrediv, computed once per frame instead of once per sample
+    const float prediv = float(outputWidth - 1) / float(imageWidth - 1);
+    for (int x = 0; x < imageWidth; ++x) {
+        map[size_t(x)] = qMin(outputWidth - 1, int(float(x) * prediv));
+    }
+    return map;
+}
@@ -0,0 +1,172 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+    This file is part of kdenlive. See www.kdenlive.org.
+
+SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "colorconstants.h"
+
+#include <QImage>
+#include <QRgb>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <vector>
+
+/**
+ * Shared pixel loops for the color scope generators.
+ *
+ * All generators sample the frame the same way: every accelFactor-th pixel
+ * of the image, counted in reading order. The helpers below reproduce that
+ * sampling on constScanLine() rows (no QImage::pixel() and no div/mod per
+ * sample) and split the work in bands that run on the global thread pool.
+ */
+namespace ScopeKernels {
+
+/** @brief Fixed point (16 bit fraction) luma weights for a given ITU recommendation. */
+struct LumaWeights
+{
+    quint32 r;
+    quint32 g;
+    quint32 b;
+};
+
+constexpr LumaWeights lumaWeights(ITURec rec)
+{
+    // Weights sum up to 1 << 16, so that white maps to exactly 255 << 16
+    return rec == ITURec::Rec_601 ? LumaWeights{19595, 38470, 7471} : LumaWeights{13926, 46885, 4725};
+}
+
+/** @brief Luma of @p pixel with 8 bits of fraction, on [0, 255 << 8] */
+inline quint32 luma8(QRgb pixel, const LumaWeights &w)
+{
+    return (w.r * quint32(qRed(pixel)) + w.g * quint32(qGreen(pixel)) + w.b * quint32(qBlue(pixel))) >> 8;
+}
+
+/** @brief Returns @p image as Format_RGB32 or Format_ARGB32 (not premultiplied), only converting when required.
+ */
+QImage toRgb32(const QImage &image);
+
+/** @brief Converts @p image to Format_RGB32 or Format_ARGB32, writing into @p buffer when its storage can be reused.
+ *
+ *  The buffer is only written to if it is not shared with another QImage (e.g. still held by a scope),
+ *  and has the right size and format. Otherwise a new image is allocated and stored in @p buffer.
+ *  @return The converted image, sharing its data with @p buffer, or @p image itself if no conversion is needed
+ */
+QImage toRgb32(const QImage &image, QImage &buffer);
+
+/** @brief Number of bands to split @p units of work in, taking the thread count into account.
+ *  @param units Number of independent work units (rows or columns)
+ *  @param minPerBand Minimum number of units per band below which threading is not worth it
+ *  @param maxBands Upper limit for the number of bands, 0 for the thread count
+ */
+int bandCount(int units, int minPerBand, int maxBands = 0);
+
+/** @brief Index of the first sampled pixel in row @p y, so that rows continue the global accelFactor stride. */
+inline int firstSampleInRow(int y, int width, uint accelFactor)
+{
+    if (accelFactor <= 1) {
+        return 0;
+    }
+    const auto rowStart = qint64(y) * width;
+    return int((accelFactor - rowStart % accelFactor) % accelFactor);
+}
+
+/** @brief First sampled pixel in row @p y that is >= @p x0 */
+inline int firstSampleFrom(int y, int width, uint accelFactor, int x0)
+{
+    int x = firstSampleInRow(y, width, accelFactor);
+    if (x < x0) {
+        x += int((x0 - x + accelFactor - 1) / accelFactor * accelFactor);
+    }
+    return x;
+}
+
+/**
+ * @brief Accumulates samples of @p image into the given @p states, one per horizontal band, in parallel.
+ *
+ * Use this version to reuse large states between frames, they are not reset.
+ * @param image A 32 bit image as returned by toRgb32()
+ * @param states One state per band, in image order, to be merged by the caller
+ * @param rowFunc Called as rowFunc(const QRgb *line, int firstX, int y, State &state) for each row,
+ *                the function samples every accelFactor-th pixel starting at firstX
+ */
+template <typename State, typename RowFunc> void accumulateRowsInto(const QImage &image, uint accelFactor, std::vector<State> &states, RowFunc rowFunc)
+{
+    const int height = image.height();
+    const int width = image.width();
+    const int bands = int(states.size());
+    std::vector<int> indexes(size_t(bands));
+    for (int i = 0; i < bands; ++i) {
+        indexes[size_t(i)] = i;
+    }
+    auto runBand = [&](int band) {
+        const int y0 = int(qint64(height) * band / bands);
+        const int y1 = int(qint64(height) * (band + 1) / bands);
+        State &state = states[size_t(band)];
+        for (int y = y0; y < y1; ++y) {
+            rowFunc(reinterpret_cast<const QRgb *>(image.constScanLine(y)), firstSampleInRow(y, width, accelFactor), y, state);
+        }
+    };
+    if (bands == 1) {
+        runBand(0);
+    } else if (bands > 1) {
+        QtConcurrent::blockingMap(indexes, runBand);
+    }
+}
+
+/**
+ * @brief Accumulates samples of @p image into one @p State per horizontal band, in parallel.
+ * @param image A 32 bit image as returned by toRgb32()
+ * @param init Initial state copied for each band
+ * @param rowFunc Called as rowFunc(const QRgb *line, int firstX, int y, State &state) for each row,
+ *                the function samples every accelFactor-th pixel starting at firstX
+ * @return The band states, in image order, to be merged by the caller
+ */
+template <typename State, typename RowFunc> std::vector<State> accumulateRows(const QImage &image, uint accelFactor, const State &init, RowFunc rowFunc)
+{
+    std::vector<State> states(size_t(bandCount(image.height(), 32)), init);
+    accumulateRowsInto(image, accelFactor, states, rowFunc);
+    return states;
+}
+
+/**
+ * @brief Runs @p columnFunc on vertical bands of output columns, in parallel.
+ *
+ * Scopes like the waveform and RGB parade write each image column to a single
+ * output column. Bands are aligned on output column changes, so that two bands
+ * never write the same output column and no per-thread buffer needs merging.
+ * @param columnMap Output column for each image column, monotonically increasing
+ * @param columnFunc Called as columnFunc(int x0, int x1) for each band of image columns [x0, x1)
+ */
+template <typename ColumnFunc> void forEachColumnBand(const std::vector<int> &columnMap, ColumnFunc columnFunc)
+{
+    const int width = int(columnMap.size());
+    const int bands = bandCount(width, 64);
+    std::vector<std::pair<int, int>> ranges;
+    ranges.reserve(size_t(bands));
+    int start = 0;
+    for (int band = 1; band <= bands && start < width; ++band) {
+        int end = band == bands ? width : int(qint64(width) * band / bands);
+        while (end < width && end > 0 && columnMap[size_t(end)] == columnMap[size_t(end - 1)]) {
+            ++end;
+        }
+        if (end > start) {
+            ranges.emplace_back(start, end);
+            start = end;
+        }
+    }
+    if (ranges.size() == 1) {
+        columnFunc(ranges.front().first, ranges.front().second);
+    } else {
+        QtConcurrent::blockingMap(ranges, [&columnFunc](const std::pair<int, int> &range) { columnFunc(range.first, range.second); });
+    }
+}
+
+/** @brief Maps each of the @p imageWidth columns to one of @p outputWidth columns, like x * (ow - 1) / (iw - 1) */
+std::vector<int> columnMap(int imageWidth, int outputWidth);
+
+} // namespace ScopeKernels
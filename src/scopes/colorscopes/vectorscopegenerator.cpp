@@ -61,6 +61,8 @@ mRgb2YPbPr =                        r =
  */
 
 #include "vectorscopegenerator.h"
+#include "scopekernels.h"
+
 #include <cmath>
 
 // The maximum distance from the center for any RGB color is 0.63, so
@@ -104,6 +106,44 @@ QPoint VectorscopeGenerator::mapToCircle(const QSize &targetSize, const QPointF
     return {int((targetSize.width() - 1) * (point.x() + 1) / 2), int((targetSize.height() - 1) * (1 - (point.y() + 1) / 2))};
 }
 
+/**
+  Color of a scope pixel for the YUV and Chroma paint modes, see yuvColorWheel.
+ */
+static QRgb uvColor(double u, double v, VectorscopeGenerator::PaintMode paintMode, VectorscopeGenerator::ColorSpace colorSpace)
+{
+    // Default Y value. Lower = darker.
+    const double dy = paintMode == VectorscopeGenerator::PaintMode_YUV ? 128 : 200;
+    double dr, dg, db;
+
+    // Calculate the RGB values from YUV/YPbPr
+    switch (colorSpace) {
+    case VectorscopeGenerator::ColorSpace_YUV:
+        dr = dy + 290.8 * v;
+        dg = dy - 100.6 * u - 148 * v;
+        db = dy + 517.2 * u;
+        break;
+    case VectorscopeGenerator::ColorSpace_YPbPr:
+    default:
+        dr = dy + 357.5 * v;
+        dg = dy - 87.75 * u - 182 * v;
+        db = dy + 451.9 * u;
+        break;
+    }
+
+    if (paintMode == VectorscopeGenerator::PaintMode_YUV) {
+        dr = qBound(0., dr, 255.);
+        dg = qBound(0., dg, 255.);
+        db = qBound(0., db, 255.);
+    } else {
+        // Scale the RGB values back to max 255
+        const double dmax = 255 / qMax(dr, qMax(dg, db));
+        dr *= dmax;
+        dg *= dmax;
+        db *= dmax;
+    }
+    return qRgba(int(dr), int(dg), int(db), 255);
+}
+
 QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize, qreal scalingFactor, const QImage &image, const float &gain,
                                                   const VectorscopeGenerator::PaintMode &paintMode, const VectorscopeGenerator::ColorSpace &colorSpace, bool,
                                                   uint accelFactor) const
@@ -120,11 +160,6 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
     scope.setDevicePixelRatio(scalingFactor);
     scope.fill(qRgba(0, 0, 0, 0));
 
-    double dy, dr, dg, db, dmax;
-    double /*y,*/ u, v;
-    QPoint pt;
-    QRgb px;
-
     // Just an average for the number of image pixels per scope pixel.
     // NOTE: byteCount() has to be replaced by (img.bytesPerLine()*img.height()) for Qt 4.5 to compile, see:
     // https://doc.qt.io/qt-5/qimage.html#bytesPerLine
@@ -133,129 +168,116 @@ QImage VectorscopeGenerator::calculateVectorscope(const QSize &vectorscopeSize,
     // benchmarking code
     // const auto start = std::chrono::high_resolution_clock::now();
 
-    const auto totalPixels = image.width() * image.height();
-    for (int i = 0; i < totalPixels; i += accelFactor) {
-        const QRgb pixel = image.pixel(i % image.width(), i / image.width());
-        const int r = qRed(pixel);
-        const int g = qGreen(pixel);
-        const int b = qBlue(pixel);
-
-        switch (colorSpace) {
-        case VectorscopeGenerator::ColorSpace_YUV:
-            //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = -0.0005781 * r - 0.001135 * g + 0.001713 * b;
-            v = 0.002411 * r - 0.002019 * g - 0.0003921 * b;
-            break;
-        case VectorscopeGenerator::ColorSpace_YPbPr:
-        default:
-            //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
-            u = -0.0006671 * r - 0.001299 * g + 0.0019608 * b;
-            v = 0.001961 * r - 0.001642 * g - 0.0003189 * b;
-            break;
-        }
-
-        pt = mapToCircle(vectorscopeSize, QPointF(SCALING * double(gain) * u, SCALING * double(gain) * v));
-
-        if (pt.x() >= scope.width() || pt.x() < 0 || pt.y() >= scope.height() || pt.y() < 0) {
-            // Point lies outside (because of scaling), don't plot it
+    // RGB to UV conversion factors
+    double uR, uG, uB, vR, vG, vB;
+    switch (colorSpace) {
+    case VectorscopeGenerator::ColorSpace_YUV:
+        //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
+        uR = -0.0005781, uG = -0.001135, uB = 0.001713;
+        vR = 0.002411, vG = -0.002019, vB = -0.0003921;
+        break;
+    case VectorscopeGenerator::ColorSpace_YPbPr:
+    default:
+        //             y = (double)  0.001173 * r +0.002302 * g +0.0004471* b;
+        uR = -0.0006671, uG = -0.001299, uB = 0.0019608;
+        vR = 0.001961, vG = -0.001642, vB = -0.0003189;
+        break;
+    }
 
+    // Paint modes where a scope pixel only depends on the number of samples falling on it
+    const bool countOnly = paintMode == PaintMode_Green || paintMode == PaintMode_Green2 || paintMode == PaintMode_Black;
+
+    // Each band plots into its own buffer of cw * cw pixels, all of them are read for each scope pixel when merging.
+    // Use few bands and keep the buffers between frames, so that the buffers and the merge don't cost more than the samples
+    QMutexLocker plotsLock(&m_plotsMutex);
+    m_plots.resize(size_t(ScopeKernels::bandCount(image.height(), 32, MAX_BANDS)));
+    const size_t plotSize = size_t(cw) * size_t(cw);
+    for (Plot &plot : m_plots) {
+        plot.hits.assign(plotSize, 0);
+        if (countOnly) {
+            plot.last.clear();
         } else {
+            // Only read where hits is not 0, no need to reset it
+            plot.last.resize(plotSize);
+        }
+    }
 
-            // Draw the pixel using the chosen draw mode.
-            switch (paintMode) {
-            case PaintMode_YUV:
-                // see yuvColorWheel
-                dy = 128; // Default Y value. Lower = darker.
-
-                // Calculate the RGB values from YUV/YPbPr
-                switch (colorSpace) {
-                case VectorscopeGenerator::ColorSpace_YUV:
-                    dr = dy + 290.8 * v;
-                    dg = dy - 100.6 * u - 148 * v;
-                    db = dy + 517.2 * u;
-                    break;
-                case VectorscopeGenerator::ColorSpace_YPbPr:
-                default:
-                    dr = dy + 357.5 * v;
-                    dg = dy - 87.75 * u - 182 * v;
-                    db = dy + 451.9 * u;
-                    break;
-                }
-
-                if (dr < 0) {
-                    dr = 0;
-                }
-                if (dg < 0) {
-                    dg = 0;
-                }
-                if (db < 0) {
-                    db = 0;
-                }
-                if (dr > 255) {
-                    dr = 255;
-                }
-                if (dg > 255) {
-                    dg = 255;
-                }
-                if (db > 255) {
-                    db = 255;
-                }
-
-                scope.setPixel(pt, qRgba(int(dr), int(dg), int(db), 255));
-                break;
-
-            case PaintMode_Chroma:
-                dy = 200; // Default Y value. Lower = darker.
-
-                // Calculate the RGB values from YUV/YPbPr
-                switch (colorSpace) {
-                case VectorscopeGenerator::ColorSpace_YUV:
-                    dr = dy + 290.8 * v;
-                    dg = dy - 100.6 * u - 148 * v;
-                    db = dy + 517.2 * u;
-                    break;
-                case VectorscopeGenerator::ColorSpace_YPbPr:
-                default:
-                    dr = dy + 357.5 * v;
-                    dg = dy - 87.75 * u - 182 * v;
-                    db = dy + 451.9 * u;
-                    break;
+    const QImage source = ScopeKernels::toRgb32(image);
+    const QRgb alphaMask = source.format() == QImage::Format_RGB32 ? 0xff000000 : 0;
+    const int iw = source.width();
+    const double gainFactor = SCALING * double(gain);
+    const double mapW = vectorscopeSize.width() - 1;
+    const double mapH = vectorscopeSize.height() - 1;
+    ScopeKernels::accumulateRowsInto(source, accelFactor, m_plots, [&](const QRgb *line, int firstX, int, Plot &plot) {
+        for (int x = firstX; x < iw; x += int(accelFactor)) {
+            const QRgb pixel = line[x] | alphaMask;
+            const int r = qRed(pixel);
+            const int g = qGreen(pixel);
+            const int b = qBlue(pixel);
+            const double u = uR * r + uG * g + uB * b;
+            const double v = vR * r + vG * g + vB * b;
+
+            // Same as mapToCircle(vectorscopeSize, QPointF(gainFactor * u, gainFactor * v))
+            const int px = int(mapW * (gainFactor * u + 1) / 2);
+            const int py = int(mapH * (1 - (gainFactor * v + 1) / 2));
+            if (px >= cw || px < 0 || py >= cw || py < 0) {
+                // Point lies outside (because of scaling), don't plot it
+                continue;
+            }
+            const size_t index = size_t(py) * size_t(cw) + size_t(px);
+            plot.hits[index]++;
+            if (!countOnly) {
+                plot.last[index] = paintMode == PaintMode_Original ? pixel : uvColor(u, v, paintMode, colorSpace);
+            }
+        }
+    });
+
+    // For count based modes, the color after n hits is obtained by applying the paint step n times
+    // to the transparent background. Steps converge quickly, so the table stays small.
+    auto paintStep = [paintMode, avgPxPerPx](QRgb px) -> QRgb {
+        switch (paintMode) {
+        case PaintMode_Green:
+            return qRgba(qRed(px) + int((255 - qRed(px)) / (3 * avgPxPerPx)), qGreen(px) + int(20 * (255 - qGreen(px)) / (avgPxPerPx)),
+                         qBlue(px) + int((255 - qBlue(px)) / (avgPxPerPx)), qAlpha(px) + int((255 - qAlpha(px)) / (avgPxPerPx)));
+        case PaintMode_Green2:
+            return qRgba(qRed(px) + int(ceil((255 - qRed(px)) / (4 * avgPxPerPx))), 255, qBlue(px) + int(ceil((255 - qBlue(px)) / (avgPxPerPx))),
+                         qAlpha(px) + int(ceil((255 - qAlpha(px)) / (avgPxPerPx))));
+        case PaintMode_Black:
+        default:
+            return qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20);
+        }
+    };
+    std::vector<QRgb> stepTable{qRgba(0, 0, 0, 0)};
+    bool converged = false;
+    auto colorForHits = [&](uint hits) -> QRgb {
+        while (!converged && stepTable.size() <= hits) {
+            const QRgb next = paintStep(stepTable.back());
+            converged = next == stepTable.back();
+            stepTable.push_back(next);
+        }
+        return stepTable[qMin(size_t(hits), stepTable.size() - 1)];
+    };
+
+    for (int y = 0; y < cw; ++y) {
+        auto *out = reinterpret_cast<QRgb *>(scope.scanLine(y));
+        for (int x = 0; x < cw; ++x) {
+            const size_t index = size_t(y) * size_t(cw) + size_t(x);
+            if (countOnly) {
+                uint hits = 0;
+                for (const Plot &plot : m_plots) {
+                    hits += plot.hits[index];
                 }
-
-                // Scale the RGB values back to max 255
-                dmax = dr;
-                if (dg > dmax) {
-                    dmax = dg;
+                if (hits > 0) {
+                    out[x] = colorForHits(hits);
                 }
-                if (db > dmax) {
-                    dmax = db;
+            } else {
+                // The last band that hit this pixel wins, like the last sample in reading order
+                for (auto it = m_plots.crbegin(); it != m_plots.crend(); ++it) {
+                    if (it->hits[index] > 0) {
+                        out[x] = it->last[index];
+                        break;
+                    }
                 }
-                dmax = 255 / dmax;
-
-                dr *= dmax;
-                dg *= dmax;
-                db *= dmax;
-
-                scope.setPixel(pt, qRgba(int(dr), int(dg), int(db), 255));
-                break;
-            case PaintMode_Original:
-                scope.setPixel(pt, pixel);
-                break;
-            case PaintMode_Green:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(qRed(px) + int((255 - qRed(px)) / (3 * avgPxPerPx)), qGreen(px) + int(20 * (255 - qGreen(px)) / (avgPxPerPx)),
-                                         qBlue(px) + int((255 - qBlue(px)) / (avgPxPerPx)), qAlpha(px) + int((255 - qAlpha(px)) / (avgPxPerPx))));
-                break;
-            case PaintMode_Green2:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(qRed(px) + int(ceil((255 - qRed(px)) / (4 * avgPxPerPx))), 255,
-                                         qBlue(px) + int(ceil((255 - qBlue(px)) / (avgPxPerPx))), qAlpha(px) + int(ceil((255 - qAlpha(px)) / (avgPxPerPx)))));
-                break;
-            case PaintMode_Black:
-            default:
-                px = scope.pixel(pt);
-                scope.setPixel(pt, qRgba(0, 0, 0, qAlpha(px) + (255 - qAlpha(px)) / 20));
-                break;
             }
         }
     }
@@ -8,8 +8,11 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #pragma once
 
 #include <QImage>
+#include <QMutex>
 #include <QObject>
 
+#include <vector>
+
 class QImage;
 class QPoint;
 class QPointF;
@@ -32,4 +35,17 @@ public:
 
 Q_SIGNALS:
     void signalCalculationFinished(const QImage &image, uint ms);
+
+private:
+    /** @brief Samples of a horizontal band of the image: number of hits and color of the last hit for each scope pixel */
+    struct Plot
+    {
+        std::vector<uint> hits;
+        std::vector<QRgb> last;
+    };
+    /** @brief Maximum number of bands the image is split in, each one needs a plot as large as the scope */
+    static constexpr int MAX_BANDS = 4;
+    /** @brief Plots of the bands, reused for the next frames */
+    mutable std::vector<Plot> m_plots;
+    mutable QMutex m_plotsMutex;
 };
@@ -6,6 +6,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 */
 
 #include "waveformgenerator.h"
+#include "scopekernels.h"
 
 #include <cmath>
 
@@ -43,68 +44,63 @@ QImage WaveformGenerator::calculateWaveform(const QSize &waveformSize, const qre
 
     const uint ww = uint(scaledWaveformSize.width());
     const uint wh = uint(scaledWaveformSize.height());
-    const uint iw = uint(image.width());
-    const auto totalPixels = image.width() * image.height();
+    const QImage source = ScopeKernels::toRgb32(image);
+    const int iw = source.width();
+    const int ih = source.height();
+    const auto totalPixels = qint64(iw) * ih;
 
-    std::vector<std::vector<uint>> waveValues(size_t(scaledWaveformSize.width()), std::vector<uint>(size_t(scaledWaveformSize.height()), 0));
+    // Sample counts, indexed by [luma row * ww + column]
+    std::vector<uint> waveValues(size_t(ww) * wh, 0);
 
     // Number of input pixels that will fall on one scope pixel.
     // Must be a float because the acceleration factor can be high, leading to <1 expected px per px.
     const float pixelDepth = float(totalPixels / accelFactor) / (ww * wh);
     const float gain = 255.f / (8 * pixelDepth);
 
+    // Scope row for each luma value (with 8 bits of fraction).
     // Subtract 1 from sizes because we start counting from 0.
     // Not doing it would result in attempts to paint outside of the image.
-    const float hPrediv = (wh - 1) / 255.f;
-    const float wPrediv = (ww - 1) / float(iw - 1);
-
-    for (int i = 0; i < totalPixels; i += accelFactor) {
-        const int x = i % image.width();
-        const QRgb pixel = image.pixel(x, i / image.width());
-
-        float dY, dx, dy;
-
-        if (rec == ITURec::Rec_601) {
-            // CIE 601 Luminance
-            dY = REC_601_R * qRed(pixel) + REC_601_G * qGreen(pixel) + REC_601_B * qBlue(pixel);
-        } else {
-            // CIE 709 Luminance
-            dY = REC_709_R * qRed(pixel) + REC_709_G * qGreen(pixel) + REC_709_B * qBlue(pixel);
-        }
-        // dY is on [0,255] now.
-
-        dy = dY * hPrediv;
-        dx = x * wPrediv;
-        waveValues[size_t(dx)][size_t(dy)]++;
+    const quint32 maxLuma = 255 << 8;
+    std::vector<uint> rows(maxLuma + 1);
+    for (quint32 l = 0; l <= maxLuma; ++l) {
+        rows[l] = uint(quint64(l) * (wh - 1) / maxLuma);
     }
-
-    switch (paintMode) {
-    case PaintMode_Green:
-        for (int i = 0; i < scaledWaveformSize.width(); ++i) {
-            for (int j = 0; j < scaledWaveformSize.height(); ++j) {
-                // Logarithmic scale. Needs fine tuning by hand, but looks great.
-                wave.setPixel(i, scaledWaveformSize.height() - j - 1,
-                              qRgba(CHOP255(52 * logf(0.1f * gain * float(waveValues[size_t(i)][size_t(j)]))),
-                                    CHOP255(52 * logf(gain * float(waveValues[size_t(i)][size_t(j)]))),
-                                    CHOP255(52 * logf(.25f * gain * float(waveValues[size_t(i)][size_t(j)]))),
-                                    CHOP255(64 * logf(gain * float(waveValues[size_t(i)][size_t(j)])))));
+    const std::vector<int> columns = ScopeKernels::columnMap(iw, int(ww));
+    const ScopeKernels::LumaWeights weights = ScopeKernels::lumaWeights(rec);
+
+    // Each band owns a distinct set of scope columns, so all bands write to the same buffer
+    ScopeKernels::forEachColumnBand(columns, [&](int x0, int x1) {
+        for (int y = 0; y < ih; ++y) {
+            const auto *line = reinterpret_cast<const QRgb *>(source.constScanLine(y));
+            for (int x = ScopeKernels::firstSampleFrom(y, iw, accelFactor, x0); x < x1; x += int(accelFactor)) {
+                const uint dy = rows[ScopeKernels::luma8(line[x], weights)];
+                waveValues[size_t(dy) * ww + size_t(columns[size_t(x)])]++;
             }
         }
-        break;
-    case PaintMode_Yellow:
-        for (int i = 0; i < scaledWaveformSize.width(); ++i) {
-            for (int j = 0; j < scaledWaveformSize.height(); ++j) {
-                wave.setPixel(i, scaledWaveformSize.height() - j - 1, qRgba(255, 242, 0, CHOP255(gain * float(waveValues[size_t(i)][size_t(j)]))));
+    });
+
+    for (uint j = 0; j < wh; ++j) {
+        auto *out = reinterpret_cast<QRgb *>(wave.scanLine(int(wh - j - 1)));
+        const uint *counts = waveValues.data() + size_t(j) * ww;
+        switch (paintMode) {
+        case PaintMode_Green:
+            for (uint i = 0; i < ww; ++i) {
+                // Logarithmic scale. Needs fine tuning by hand, but looks great.
+                const float value = gain * float(counts[i]);
+                out[i] = qRgba(CHOP255(52 * logf(0.1f * value)), CHOP255(52 * logf(value)), CHOP255(52 * logf(.25f * value)), CHOP255(64 * logf(value)));
             }
-        }
-        break;
-    default:
-        for (int i = 0; i < scaledWaveformSize.width(); ++i) {
-            for (int j = 0; j < scaledWaveformSize.height(); ++j) {
-                wave.setPixel(i, scaledWaveformSize.height() - j - 1, qRgba(255, 255, 255, CHOP255(2.f * gain * float(waveValues[size_t(i)][size_t(j)]))));
+            break;
+        case PaintMode_Yellow:
+            for (uint i = 0; i < ww; ++i) {
+                out[i] = qRgba(255, 242, 0, CHOP255(gain * float(counts[i])));
+            }
+            break;
+        default:
+            for (uint i = 0; i < ww; ++i) {
+                out[i] = qRgba(255, 255, 255, CHOP255(2.f * gain * float(counts[i])));
             }
+            break;
         }
-        break;
     }
 
     if (drawAxis) {
@@ -11,6 +11,7 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 #include "audioscopes/spectrogram.h"
 #include "colorscopes/histogram.h"
 #include "colorscopes/rgbparade.h"
+#include "colorscopes/scopekernels.h"
 #include "colorscopes/vectorscope.h"
 #include "colorscopes/waveform.h"
 #include "core.h"
@@ -121,12 +122,32 @@ void ScopeManager::slotDistributeAudio(const audioShortVector &sampleData, int f
         }
     }
 }
-void ScopeManager::slotDistributeFrame(const QImage &image)
+
+QImage ScopeManager::scopeFrame(const QImage &image)
+{
+    // Use the first pool buffer that is not held by a scope anymore, so that
+    // the conversion does not allocate in the steady state.
+    for (QImage &buffer : m_framePool) {
+        if (buffer.isNull() || buffer.isDetached()) {
+            return ScopeKernels::toRgb32(image, buffer);
+        }
+    }
+    // All buffers still in use, this allocates a new one
+    return ScopeKernels::toRgb32(image, m_framePool.back());
+}
+
+void ScopeManager::slotDistributeFrame(const QImage &frame)
 {
 #ifdef DEBUG_SM
     qCDebug(KDENLIVE_LOG) << "ScopeManager: Starting to distribute frame.";
 #endif
+    // Convert the frame only once for all scopes
+    QImage image;
     for (auto &m_colorScope : m_colorScopes) {
+        if (image.isNull() && !m_colorScope.scope->visibleRegion().isEmpty() &&
+            (m_colorScope.scope->autoRefreshEnabled() || m_colorScope.singleFrameRequested)) {
+            image = scopeFrame(frame);
+        }
         if (!m_colorScope.scope->visibleRegion().isEmpty()) {
             if (m_colorScope.scope->autoRefreshEnabled()) {
                 m_colorScope.scope->slotRenderZoneUpdated(image);
@@ -12,6 +12,8 @@ SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
 
 #include <QList>
 
+#include <array>
+
 class QDockWidget;
 class AbstractMonitor;
 class QSignalMapper;
@@ -75,6 +77,14 @@ private:
     QSignalMapper *m_signalMapper;
     /** @brief a list of all scopes dock object names */
     QStringList m_scopeNames;
+    /** @brief Reusable buffers holding the frame converted for the color scopes */
+    std::array<QImage, 3> m_framePool;
+
+    /**
+      Converts @param image once to the format read by the color scopes, reusing a pooled buffer
+      that is not referenced by any scope anymore.
+      */
+    QImage scopeFrame(const QImage &image);
 
     /**
       Checks whether there is any scope accepting audio data, or if all of them are hidden
@@ -128,7 +138,7 @@ private Q_SLOTS:
       */
     void checkActiveColourScopes();
 
-    void slotDistributeFrame(const QImage &image);
+    void slotDistributeFrame(const QImage &frame);
     void slotDistributeAudio(const audioShortVector &sampleData, int freq, int num_channels, int num_samples);
     /**
       Allows a scope to explicitly request a new frame, even if the scope's autoRefresh is disabled.
@@ -89,6 +89,8 @@ bool constructTimelineFromTractor(const std::shared_ptr<TimelineItemModel> &time
     Fun redo = []() { return true; };
     // First, we destruct the previous tracks
     timeline->requestReset(undo, redo);
+    // Items are inserted without notifying the view, it is reset by endBulkLoad()
+    timeline->beginBulkLoad();
     m_errorMessage.clear();
     bool useMappedIds = true;
 
@@ -257,7 +259,6 @@ bool constructTimelineFromTractor(const std::shared_ptr<TimelineItemModel> &time
             qWarning() << "Unexpected track type" << track->type();
         }
     }
-    timeline->_resetView();
 
     // Loading compositions
     Mlt::Service *prod = tractor.producer();
@@ -334,10 +335,11 @@ bool constructTimelineFromTractor(const std::shared_ptr<TimelineItemModel> &time
 
     if (!ok) {
         // TODO log error
-        // Don't abort loading because of failed composition
-        undo();
+        // Clips are inserted without undo operations, so the partial load is kept like in constructTimelineFromMelt
+        timeline->endBulkLoad();
         return false;
     }
+    timeline->endBulkLoad();
     timeline->isLoading = false;
     if (!m_errorMessage.isEmpty()) {
         if (pCore->window()) {
@@ -360,6 +362,8 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
     Fun redo = []() { return true; };
     // First, we destruct the previous tracks
     timeline->requestReset(undo, redo);
+    // Items are inserted without notifying the view, it is reset by endBulkLoad()
+    timeline->beginBulkLoad();
     m_errorMessage.clear();
     QStringList expandedFolders;
     QStringList extraBins;
@@ -441,6 +445,9 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
 
     for (int i = 0; i < tractor.count() && ok; i++) {
         qDebug() << "::: PROCESSING TK " << i;
+        // Loading is never undone, don't keep the operations of the previous track
+        undo = []() { return true; };
+        redo = []() { return true; };
         std::unique_ptr<Mlt::Producer> track(tractor.track(i));
         if (track->property_exists("kdenlive:playlistid")) {
             playlist_name = track->get("kdenlive:playlistid");
@@ -512,7 +519,6 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
             qWarning() << "Unexpected track type" << track->type();
         }
     }
-    timeline->_resetView();
 
     // Loading compositions
     QScopedPointer<Mlt::Service> service(tractor.producer());
@@ -543,6 +549,8 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
         QString id(t->get("kdenlive_id"));
         int compoId;
         int aTrack = t->get_a_track();
+        undo = []() { return true; };
+        redo = []() { return true; };
         if (!timeline->isTrack(timeline->getTrackIndexFromPosition(t->get_b_track() - 1))) {
             QString tcInfo = QStringLiteral("<a href=\"%1!%2\">%3</a>")
                                  .arg(timeline->uuid().toString(), QString::number(t->get_in()), pCore->timecode().getTimecodeFromFrames(t->get_in()));
@@ -600,6 +608,7 @@ bool constructTimelineFromMelt(const std::shared_ptr<TimelineItemModel> &timelin
         timeline->lockTrack(tid, true);
     }
 
+    timeline->endBulkLoad();
     if (!ok) {
         // Loading tracks failed, abort loading
         qDebug() << "IIIIIIIIIIIIIIIIII\nFAILED LOADING TIMELINE BBBBBBBBBBBBBBBBBBBB";
@@ -909,7 +918,7 @@ bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline,
                                     if (!startMixToFind) {
                                         // Move to top playlist
                                         cid = ClipModel::construct(timeline, binId, clip, st, tid, originalDecimalPoint, hasStartMix ? playlist : 0);
-                                        timeline->requestClipMove(cid, tid, position, true, true, false, true, undo, redo);
+                                        timeline->requestClipBulkInsertion(cid, tid, position);
                                         m_notesLog << i18n("%1 Clip (%2) with missing mix found and resized", tcInfo, clip->parent().get("id"));
                                         m_errorMessage << i18n("Clip without mix %1 found and resized on track %2 at %3.", clip->parent().get("id"), trackTag,
                                                                pCore->timecode().getTimecodeFromFrames(position));
@@ -933,7 +942,7 @@ bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline,
                                     clip->set_in_and_out(currentIn, currentOut);
                                     // Move to top playlist
                                     cid = ClipModel::construct(timeline, binId, clip, st, tid, originalDecimalPoint, hasEndMix ? playlist : 0);
-                                    ok = timeline->requestClipMove(cid, tid, position, true, true, false, true, undo, redo);
+                                    ok = timeline->requestClipBulkInsertion(cid, tid, position);
                                     if (!ok && cid > -1) {
                                         timeline->requestItemDeletion(cid, false);
                                         m_errorMessage << i18n("Invalid clip %1 found on track %2 at %3.", clip->parent().get("id"), track.get("id"),
@@ -972,7 +981,7 @@ bool constructTrackFromMelt(const std::shared_ptr<TimelineItemModel> &timeline,
                     }
                 }
                 cid = ClipModel::construct(timeline, binId, clip, st, tid, originalDecimalPoint, enforceTopPlaylist ? 0 : playlist);
-                ok = timeline->requestClipMove(cid, tid, position, true, true, false, true, undo, redo);
+                ok = timeline->requestClipBulkInsertion(cid, tid, position);
             } else {
                 qWarning() << "Really can't find bin clip" << binId << clip->get("id");
             }
@@ -231,7 +231,7 @@ int CompositionModel::getATrack() const
 
 void CompositionModel::setForceTrack(bool force)
 {
-    READ_LOCK();
+    QWriteLocker locker(&m_lock);
     service()->set("force_track", force ? 1 : 0);
 }
 
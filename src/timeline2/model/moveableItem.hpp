@@ -8,6 +8,7 @@
 #include "timelinemodel.hpp"
 #include "undohelper.hpp"
 #include <QReadWriteLock>
+#include <atomic>
 #include <memory>
 
 /** @brief This is the base class for objects that can move, for example clips and compositions
@@ -122,9 +123,11 @@ protected:
     std::weak_ptr<TimelineModel> m_parent;
     /** @brief this is the creation id of the item, used for book-keeping */
     int m_id;
-    int m_position;
-    int m_currentTrackId;
-    bool m_grabbed;
+    /** @brief Position, track and grab state are read very often while painting the timeline, they can be read without locking.
+     *  They are still modified with the write lock held, to stay consistent with the other properties */
+    std::atomic<int> m_position;
+    std::atomic<int> m_currentTrackId;
+    std::atomic<bool> m_grabbed;
     /** @brief Fake track id, used when dragging in insert/overwrite mode */
     int m_fakeTrack;
     int m_fakePosition;
@@ -21,7 +21,7 @@ MoveableItem<Service>::MoveableItem(std::weak_ptr<TimelineModel> parent, int id)
 
 template <typename Service> int MoveableItem<Service>::getId() const
 {
-    READ_LOCK();
+    // The id never changes
     return m_id;
 }
 
@@ -36,14 +36,12 @@ template <typename Service> QUuid MoveableItem<Service>::getUuid() const
 
 template <typename Service> int MoveableItem<Service>::getCurrentTrackId() const
 {
-    READ_LOCK();
-    return m_currentTrackId;
+    return m_currentTrackId.load();
 }
 
 template <typename Service> int MoveableItem<Service>::getPosition() const
 {
-    READ_LOCK();
-    return m_position;
+    return m_position.load();
 }
 
 template <typename Service> std::pair<int, int> MoveableItem<Service>::getInOut() const
@@ -97,8 +95,7 @@ template <typename Service> void MoveableItem<Service>::setInOut(int in, int out
 
 template <typename Service> bool MoveableItem<Service>::isGrabbed() const
 {
-    READ_LOCK();
-    return m_grabbed;
+    return m_grabbed.load();
 }
 
 template <typename Service> int MoveableItem<Service>::getFakeTrackId() const
@@ -4,6 +4,7 @@
 */
 #include "snapmodel.hpp"
 #include <QDebug>
+#include <algorithm>
 #include <climits>
 #include <cstdlib>
 
@@ -14,6 +15,10 @@ SnapModel::SnapModel() = default;
 
 void SnapModel::addPoint(int position)
 {
+    if (m_deferred) {
+        m_pending.push_back(position);
+        return;
+    }
     if (m_snaps.count(position) == 0) {
         m_snaps[position] = 1;
     } else {
@@ -23,6 +28,7 @@ void SnapModel::addPoint(int position)
 
 void SnapModel::removePoint(int position)
 {
+    flushPending();
     Q_ASSERT(m_snaps.count(position) > 0);
     if (m_snaps[position] == 1) {
         m_snaps.erase(position);
@@ -31,8 +37,33 @@ void SnapModel::removePoint(int position)
     }
 }
 
+void SnapModel::setDeferred(bool deferred)
+{
+    m_deferred = deferred;
+    if (!deferred) {
+        flushPending();
+    }
+}
+
+void SnapModel::flushPending()
+{
+    if (m_pending.empty()) {
+        return;
+    }
+    std::sort(m_pending.begin(), m_pending.end());
+    // Sorted input lets the map insert next to the previous point instead of searching the tree
+    auto hint = m_snaps.begin();
+    for (int position : m_pending) {
+        auto it = m_snaps.try_emplace(hint, position, 0);
+        it->second++;
+        hint = std::next(it);
+    }
+    m_pending.clear();
+}
+
 int SnapModel::getClosestPoint(int position)
 {
+    flushPending();
     if (m_snaps.empty()) {
         return -1;
     }
@@ -53,6 +84,7 @@ int SnapModel::getClosestPoint(int position)
 
 int SnapModel::getNextPoint(int position)
 {
+    flushPending();
     if (m_snaps.empty()) {
         return position;
     }
@@ -66,6 +98,7 @@ int SnapModel::getNextPoint(int position)
 
 int SnapModel::getPreviousPoint(int position)
 {
+    flushPending();
     if (m_snaps.empty()) {
         return 0;
     }
@@ -69,8 +69,17 @@ public:
     int proposeSize(int in, int out, int size, bool right, int maxSnapDist);
     int proposeSize(int in, int out, const std::vector<int> &boundaries, int size, bool right, int maxSnapDist);
 
+    /** @brief While deferred, added points are only queued. They are inserted in one sorted pass
+       when deferring stops or before the points are queried. Used to build the snaps of a whole timeline.
+    */
+    void setDeferred(bool deferred);
+
     // For testing only
-    std::map<int, int> _snaps() { return m_snaps; }
+    std::map<int, int> _snaps()
+    {
+        flushPending();
+        return m_snaps;
+    }
 
 private:
     /** This represents the snappoints internally. The keys are the positions and the values are the number of elements at this
@@ -78,4 +87,8 @@ private:
      */
     std::map<int, int> m_snaps;
     std::vector<int> m_ignore;
+    /** @brief Points added while deferred, not yet in m_snaps */
+    std::vector<int> m_pending;
+    bool m_deferred{false};
+    void flushPending();
 };
@@ -682,11 +682,15 @@ void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelInd
             roles.push_back(TimelineModel::OutPointRole);
         }
     }
-    Q_EMIT dataChanged(topleft, bottomright, roles);
+    notifyChange(topleft, bottomright, roles);
 }
 
 void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelIndex &bottomright, const QVector<int> &roles)
 {
+    if (m_bulkLoading) {
+        // The view is reset when loading ends
+        return;
+    }
     Q_EMIT dataChanged(topleft, bottomright, roles);
 }
 
@@ -779,7 +783,7 @@ void TimelineItemModel::removeTrackCompositing()
 
 void TimelineItemModel::buildTrackCompositing(bool rebuild)
 {
-    READ_LOCK();
+    QWriteLocker locker(&m_lock);
     bool isMultiTrack = pCore->enableMultiTrack(false);
     if (rebuild) {
         removeTrackCompositing();
@@ -843,24 +847,33 @@ void TimelineItemModel::buildTrackCompositing(bool rebuild)
 
 void TimelineItemModel::notifyChange(const QModelIndex &topleft, const QModelIndex &bottomright, int role)
 {
-    Q_EMIT dataChanged(topleft, bottomright, {role});
+    notifyChange(topleft, bottomright, QVector<int>{role});
 }
 
+// Row changes are not notified during a bulk load, endBulkLoad() resets the view
 void TimelineItemModel::_beginRemoveRows(const QModelIndex &i, int j, int k)
 {
-    beginRemoveRows(i, j, k);
+    if (!m_bulkLoading) {
+        beginRemoveRows(i, j, k);
+    }
 }
 void TimelineItemModel::_beginInsertRows(const QModelIndex &i, int j, int k)
 {
-    beginInsertRows(i, j, k);
+    if (!m_bulkLoading) {
+        beginInsertRows(i, j, k);
+    }
 }
 void TimelineItemModel::_endRemoveRows()
 {
-    endRemoveRows();
+    if (!m_bulkLoading) {
+        endRemoveRows();
+    }
 }
 void TimelineItemModel::_endInsertRows()
 {
-    endInsertRows();
+    if (!m_bulkLoading) {
+        endInsertRows();
+    }
 }
 
 void TimelineItemModel::_resetView()
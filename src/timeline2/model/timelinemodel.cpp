@@ -85,6 +85,7 @@ RTTR_REGISTRATION
             parameter_names("clipId", "trackId", "position", "updateView", "logUndo", "invalidateTimeline"))
         .method("requestFakeGroupMove", select_overload<bool(int, int, int, int, bool, bool)>(&TimelineModel::requestFakeGroupMove))(
             parameter_names("clipId", "groupId", "delta_track", "delta_pos", "updateView", "logUndo"))
+        .method("endGhostMove", &TimelineModel::endGhostMove)(parameter_names("clipId", "position", "moveMirrorTracks"))
         .method("suggestClipMove", &TimelineModel::suggestClipMove)(
             parameter_names("clipId", "trackId", "position", "cursorPosition", "snapDistance", "moveMirrorTracks", "fakeMove"))
         .method("suggestCompositionMove",
@@ -291,7 +292,7 @@ int TimelineModel::getClipTrackId(int clipId) const
 {
     READ_LOCK();
     Q_ASSERT(m_allClips.count(clipId) > 0);
-    const auto clip = m_allClips.at(clipId);
+    const auto &clip = m_allClips.at(clipId);
     return clip->getCurrentTrackId();
 }
 
@@ -340,7 +341,7 @@ int TimelineModel::getClipPosition(int clipId) const
 {
     READ_LOCK();
     Q_ASSERT(m_allClips.count(clipId) > 0);
-    const auto clip = m_allClips.at(clipId);
+    const auto &clip = m_allClips.at(clipId);
     int pos = clip->getPosition();
     return pos;
 }
@@ -404,7 +405,7 @@ int TimelineModel::getClipPlaytime(int clipId) const
 {
     READ_LOCK();
     Q_ASSERT(isClip(clipId));
-    const auto clip = m_allClips.at(clipId);
+    const auto &clip = m_allClips.at(clipId);
     int playtime = clip->getPlaytime();
     return playtime;
 }
@@ -1469,6 +1470,8 @@ QVariantList TimelineModel::suggestClipMove(int clipId, int trackId, int positio
     TRACE(clipId, trackId, position, cursorPosition, snapDistance);
     Q_ASSERT(isClip(clipId));
     Q_ASSERT(isTrack(trackId));
+    // In normal edit mode, a fake move is a ghost drag: the move must not overlap other items
+    const bool ghostMove = fakeMove && m_editMode == TimelineMode::NormalEdit;
     if (m_editMode != TimelineMode::NormalEdit) {
         fakeMove = true;
     }
@@ -1486,6 +1489,9 @@ QVariantList TimelineModel::suggestClipMove(int clipId, int trackId, int positio
     }
 
     int sourceTrackId = fakeMove ? m_allClips[clipId]->getFakeTrackId() : getClipTrackId(clipId);
+    if (ghostMove && sourceTrackId == -1) {
+        sourceTrackId = getClipTrackId(clipId);
+    }
     if (sourceTrackId > -1 && getTrackById_const(trackId)->isAudioTrack() != getTrackById_const(sourceTrackId)->isAudioTrack()) {
         // Trying move on incompatible track type, stay on same track
         trackId = sourceTrackId;
@@ -1520,6 +1526,14 @@ QVariantList TimelineModel::suggestClipMove(int clipId, int trackId, int positio
                 ignored_pts.push_back(in + getItemPlaytime(current_clipId));
             }
         }
+        if (ghostMove) {
+            // The moving items are still at their original position in the snap model
+            std::vector<int> original_pts;
+            for (int pt : ignored_pts) {
+                original_pts.push_back(pt + offset);
+            }
+            m_snaps->ignore(original_pts);
+        }
         int snapped = getBestSnapPos(currentPos, position - currentPos, ignored_pts, cursorPosition, snapDistance, fakeMove);
         if (snapped >= 0) {
             position = snapped;
@@ -1575,6 +1589,11 @@ QVariantList TimelineModel::suggestClipMove(int clipId, int trackId, int positio
     // we check if move is possible
     bool possible = fakeMove ? requestFakeClipMove(clipId, trackId, position, true, false, false)
                              : requestClipMove(clipId, trackId, position, moveMirrorTracks, true, false, false);
+    if (possible && ghostMove && !ghostMoveIsValid(clipId)) {
+        // Overlapping, go back to the last valid ghost position
+        requestFakeClipMove(clipId, sourceTrackId, currentPos, true, false, false);
+        possible = false;
+    }
     if (possible) {
         TRACE_RES(position);
         if (fakeMove) {
@@ -1585,6 +1604,11 @@ QVariantList TimelineModel::suggestClipMove(int clipId, int trackId, int positio
         }
         return {position, trackId};
     }
+    if (ghostMove) {
+        // Don't look for a better position, this would require real moves
+        TRACE_RES(currentPos);
+        return {currentPos, sourceTrackId};
+    }
     if (sourceTrackId == -1) {
         // not clear what to do here, if the current move doesn't work. We could try to find empty space, but it might end up being far away...
         TRACE_RES(currentPos);
@@ -2640,6 +2664,88 @@ bool TimelineModel::requestFakeGroupMove(int clipId, int groupId, int delta_trac
     return true;
 }
 
+bool TimelineModel::ghostMoveIsValid(int itemId)
+{
+    std::unordered_set<int> all_items = {itemId};
+    if (m_groups->isInGroup(itemId)) {
+        all_items = m_groups->getLeaves(m_groups->getRootId(itemId));
+    }
+    for (int item : all_items) {
+        int trackId = -1;
+        int position = -1;
+        std::unordered_set<int> overlapping;
+        if (isClip(item)) {
+            const auto &clip = m_allClips.at(item);
+            trackId = clip->getFakeTrackId() > -1 ? clip->getFakeTrackId() : clip->getCurrentTrackId();
+            position = clip->getFakePosition() > -1 ? clip->getFakePosition() : clip->getPosition();
+            if (trackId == clip->getCurrentTrackId() && position == clip->getPosition()) {
+                continue;
+            }
+            if (!isTrack(trackId) || trackIsLocked(trackId)) {
+                return false;
+            }
+            overlapping = getTrackById_const(trackId)->getClipsInRange(position, position + clip->getPlaytime());
+        } else if (isComposition(item)) {
+            const auto &compo = m_allCompositions.at(item);
+            trackId = compo->getFakeTrackId() > -1 ? compo->getFakeTrackId() : compo->getCurrentTrackId();
+            position = compo->getFakePosition() > -1 ? compo->getFakePosition() : compo->getPosition();
+            if (trackId == compo->getCurrentTrackId() && position == compo->getPosition()) {
+                continue;
+            }
+            if (!isTrack(trackId) || trackIsLocked(trackId)) {
+                return false;
+            }
+            overlapping = getTrackById_const(trackId)->getCompositionsInRange(position, position + compo->getPlaytime());
+        }
+        for (int other : overlapping) {
+            if (all_items.count(other) == 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void TimelineModel::clearGhostState(int itemId)
+{
+    std::unordered_set<int> all_items = {itemId};
+    if (m_groups->isInGroup(itemId)) {
+        all_items = m_groups->getLeaves(m_groups->getRootId(itemId));
+    }
+    const QVector<int> roles{FakeTrackIdRole, FakePositionRole};
+    for (int item : all_items) {
+        QModelIndex modelIndex;
+        if (isClip(item)) {
+            m_allClips[item]->cleanFakeState();
+            modelIndex = makeClipIndexFromID(item);
+        } else if (isComposition(item)) {
+            m_allCompositions[item]->cleanFakeState();
+            modelIndex = makeCompositionIndexFromID(item);
+        }
+        if (modelIndex.isValid()) {
+            notifyChange(modelIndex, modelIndex, roles);
+        }
+    }
+    if (m_subtitleModel) {
+        m_subtitleModel->cleanupSubtitleFakePos();
+    }
+}
+
+bool TimelineModel::endGhostMove(int clipId, int position, bool moveMirrorTracks)
+{
+    QWriteLocker locker(&m_lock);
+    TRACE(clipId, position, moveMirrorTracks);
+    Q_ASSERT(isClip(clipId));
+    int trackId = m_allClips[clipId]->getFakeTrackId();
+    if (trackId == -1) {
+        trackId = getClipTrackId(clipId);
+    }
+    clearGhostState(clipId);
+    bool res = requestClipMove(clipId, trackId, position, moveMirrorTracks, true, true, true);
+    TRACE_RES(res);
+    return res;
+}
+
 bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, int delta_pos, bool moveMirrorTracks, bool updateView, bool logUndo,
                                      bool revertMove)
 {
@@ -2975,6 +3081,35 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
         // Keep track of old track for mixes
         oldTrackIds.insert(item.first, getClipTrackId(item.first));
     }
+    // On final moves, keep the playlists of the source and target tracks locked and defer blank consolidation while moving the items
+    std::unordered_set<int> batchedTracks;
+    std::unique_ptr<PlaylistBatch> batch;
+    if (finalMove) {
+        for (const std::pair<int, int> &item : sorted_clips) {
+            int trackId = getClipTrackId(item.first);
+            if (trackId == -1) {
+                continue;
+            }
+            batchedTracks.insert(trackId);
+            if (delta_track != 0) {
+                int d = getTrackById_const(trackId)->isAudioTrack() ? audio_delta : video_delta;
+                if (!moveMirrorTracks && item.first != itemId && !m_singleSelectionMode) {
+                    d = 0;
+                }
+                int target_track_position = getTrackPosition(trackId) + d;
+                if (target_track_position >= 0 && target_track_position < getTracksCount()) {
+                    batchedTracks.insert(getTrackIndexFromPosition(target_track_position));
+                }
+            }
+        }
+        QMapIterator<std::pair<int, int>, int> i(mixesToDelete);
+        while (i.hasNext()) {
+            i.next();
+            batchedTracks.insert(i.value());
+        }
+        batch = std::make_unique<PlaylistBatch>();
+        batchTracks(*batch, batchedTracks);
+    }
     // First delete mixes that have to
     if (finalMove && !mixesToDelete.isEmpty()) {
         QMapIterator<std::pair<int, int>, int> i(mixesToDelete);
@@ -3187,10 +3322,17 @@ bool TimelineModel::requestGroupMove(int itemId, int groupId, int delta_track, i
             }
         }
     }
+    batch.reset();
     update_model();
     PUSH_LAMBDA(update_model, local_redo);
     PUSH_LAMBDA(update_model, local_undo);
-    UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+    if (finalMove) {
+        Fun batched_undo = batchedOperation(local_undo, batchedTracks);
+        Fun batched_redo = batchedOperation(local_redo, batchedTracks);
+        UPDATE_UNDO_REDO(batched_redo, batched_undo, undo, redo);
+    } else {
+        UPDATE_UNDO_REDO(local_redo, local_undo, undo, redo);
+    }
     return true;
 }
 
@@ -6160,9 +6302,38 @@ const QString TimelineModel::sceneList(const QString &root, const QString &fullP
     return playlist;
 }
 
+void TimelineModel::beginBulkLoad()
+{
+    m_bulkLoading = true;
+    m_snaps->setDeferred(true);
+}
+
+void TimelineModel::endBulkLoad()
+{
+    m_snaps->setDeferred(false);
+    m_bulkLoading = false;
+    _resetView();
+}
+
+bool TimelineModel::requestClipBulkInsertion(int clipId, int trackId, int position)
+{
+    Q_ASSERT(m_bulkLoading);
+    Q_ASSERT(isClip(clipId) && getClipTrackId(clipId) == -1);
+    if (!isTrack(trackId)) {
+        qWarning() << "clip is not on a track";
+        return false;
+    }
+    PlaylistState::ClipState state = m_allClips[clipId]->clipState();
+    if (state != PlaylistState::Disabled && getTrackById_const(trackId)->trackType() != state) {
+        qWarning() << "clip type mismatch";
+        return false;
+    }
+    return getTrackById(trackId)->requestClipBulkInsertion(clipId, position);
+}
+
 void TimelineModel::checkRefresh(int start, int end)
 {
-    if (m_blockRefresh) {
+    if (m_blockRefresh || m_bulkLoading) {
         return;
     }
     int currentPos = tractor()->position();
@@ -6171,6 +6342,24 @@ void TimelineModel::checkRefresh(int start, int end)
     }
 }
 
+void TimelineModel::batchTracks(PlaylistBatch &batch, const std::unordered_set<int> &trackIds)
+{
+    for (int trackId : trackIds) {
+        if (isTrack(trackId)) {
+            batch.addTrack(getTrackById(trackId));
+        }
+    }
+}
+
+Fun TimelineModel::batchedOperation(const Fun &operation, const std::unordered_set<int> &trackIds)
+{
+    return [this, operation, trackIds]() {
+        PlaylistBatch batch;
+        batchTracks(batch, trackIds);
+        return operation();
+    };
+}
+
 std::shared_ptr<AssetParameterModel> TimelineModel::getCompositionParameterModel(int compoId) const
 {
     READ_LOCK();
@@ -6201,7 +6390,8 @@ std::shared_ptr<EffectStackModel> TimelineModel::getTrackEffectStackModel(int tr
 
 std::shared_ptr<EffectStackModel> TimelineModel::getMasterEffectStackModel()
 {
-    READ_LOCK();
+    // The master stack is created on first access, concurrent readers must not both build it
+    QWriteLocker locker(&m_lock);
     if (m_masterStack == nullptr) {
         m_masterService.reset(new Mlt::Service(*m_tractor.get()));
         m_masterStack = EffectStackModel::construct(m_masterService, ObjectId(KdenliveObjectType::Master, 0, m_uuid), m_undoStack);
@@ -6212,7 +6402,7 @@ std::shared_ptr<EffectStackModel> TimelineModel::getMasterEffectStackModel()
 
 void TimelineModel::importMasterEffects(std::weak_ptr<Mlt::Service> service)
 {
-    READ_LOCK();
+    QWriteLocker locker(&m_lock);
     if (m_masterStack == nullptr) {
         getMasterEffectStackModel();
     }
@@ -6683,7 +6873,8 @@ void TimelineModel::requestClearSelection(bool onDeletion, Fun &undo, Fun &redo)
 
 void TimelineModel::clearGroupSelectionOnDelete(std::vector<int> groups)
 {
-    READ_LOCK();
+    // requestClearSelection takes the write lock, which cannot be acquired while holding a read lock
+    QWriteLocker locker(&m_lock);
     if (m_currentSelection.size() == 0) {
         return;
     }
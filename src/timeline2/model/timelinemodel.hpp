@@ -452,6 +452,13 @@ public:
     bool requestFakeGroupMove(int clipId, int groupId, int delta_track, int delta_pos, bool updateView = true, bool logUndo = true);
     bool requestFakeGroupMove(int clipId, int groupId, int delta_track, int delta_pos, bool updateView, bool finalMove, Fun &undo, Fun &redo,
                               bool allowViewRefresh = true);
+    /** @brief End a ghost drag: clear the fake state of the dragged clip and its group, then move them to the last ghost position.
+       In ghost drag mode, clips are moved with fake moves in normal edit mode, so the timeline is only modified once on drop
+       @param clipId the clip that was dragged
+       @param position the last position returned by suggestClipMove
+       @returns true if the move succeeded
+    */
+    Q_INVOKABLE bool endGhostMove(int clipId, int position, bool moveMirrorTracks = true);
 
     /** @brief Given an intended move, try to suggest a more valid one
        (accounting for snaps and missing UI calls)
@@ -704,6 +711,19 @@ public:
     /** @brief True until the timeline has all tracks and clips loaded
      */
     bool isLoading{true};
+    /** @brief Enter bulk loading, used when building the timeline from a project file.
+       Until endBulkLoad(), row insertions and changes are not notified, the monitor is not refreshed and
+       snap points are queued to be indexed in one pass.
+    */
+    void beginBulkLoad();
+    /** @brief Leave bulk loading: index the queued snap points and reset the view */
+    void endBulkLoad();
+    /** @brief Insert a newly constructed clip on a track while bulk loading, without building undo operations
+       @param clipId is the id of the clip, it must not be on a track yet
+       @param trackId is the id of the target track
+       @param position is the position where to insert the clip
+    */
+    bool requestClipBulkInsertion(int clipId, int trackId, int position);
 
     /** @brief Get all the elements of the same group as the given clip.
        If there is a group hierarchy, only the topmost group is considered.
@@ -1022,8 +1042,18 @@ public:
 protected:
     /** @brief Refresh project monitor if cursor was inside range */
     void checkRefresh(int start, int end);
+    /** @brief Check that the ghosts (fake positions and tracks) of an item and its group don't overlap items that are not moving */
+    bool ghostMoveIsValid(int itemId);
+    /** @brief Reset the fake positions and tracks of an item and its group */
+    void clearGhostState(int itemId);
+    /** @brief Open a playlist batch on the given tracks, see TrackModel::beginPlaylistBatch() */
+    void batchTracks(PlaylistBatch &batch, const std::unordered_set<int> &trackIds);
+    /** @brief Wrap an operation so that it runs in a playlist batch on the given tracks */
+    Fun batchedOperation(const Fun &operation, const std::unordered_set<int> &trackIds);
 
     bool m_blockRefresh;
+    /** @brief True between beginBulkLoad() and endBulkLoad() */
+    bool m_bulkLoading{false};
 
 Q_SIGNALS:
     /** @brief signal triggered by clearAssetView */
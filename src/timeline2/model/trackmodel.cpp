@@ -19,6 +19,7 @@
 #include "timelinemodel.hpp"
 #include <QDebug>
 #include <QModelIndex>
+#include <algorithm>
 #include <memory>
 #include <mlt++/MltTransition.h>
 
@@ -114,7 +115,10 @@ TrackModel::~TrackModel()
         field->unblock();
         m_sameCompositions.clear();
         m_allClips.clear();
+        m_clipRows.clear();
+        m_clipsByPosition.clear();
         m_allCompositions.clear();
+        m_compositionRows.clear();
         m_track->remove_track(1);
         m_track->remove_track(0);
     }
@@ -196,8 +200,10 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
         if (auto ptr = m_parent.lock()) {
             std::shared_ptr<ClipModel> clip = ptr->getClipPtr(clipId);
             m_allClips[clip->getId()] = clip; // store clip
+            m_clipRows.insert(clipId);
             // update clip position and track
             clip->setPosition(position);
+            m_clipsByPosition.emplace(position, clipId);
             if (finalMove) {
                 clip->setSubPlaylistIndex(subPlaylist, m_id);
             }
@@ -260,7 +266,11 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
                 std::shared_ptr<ClipModel> clip = ptr->getClipPtr(clipId);
                 clip->setCurrentTrackId(m_id, finalMove);
                 int index = m_playlists[target_playlist].insert_at(position, *clip, 1);
-                m_playlists[target_playlist].consolidate_blanks();
+                if (m_batchDepth > 0) {
+                    m_batchModified = true;
+                } else {
+                    m_playlists[target_playlist].consolidate_blanks();
+                }
                 m_playlists[target_playlist].unlock();
                 field->unblock();
                 if (finalMove && !groupMove) {
@@ -284,7 +294,11 @@ Fun TrackModel::requestClipInsertion_lambda(int clipId, int position, bool updat
                     std::shared_ptr<ClipModel> clip = ptr->getClipPtr(clipId);
                     clip->setCurrentTrackId(m_id);
                     int index = m_playlists[target_playlist].insert_at(position, *clip, 1);
-                    m_playlists[target_playlist].consolidate_blanks();
+                    if (m_batchDepth > 0) {
+                        m_batchModified = true;
+                    } else {
+                        m_playlists[target_playlist].consolidate_blanks();
+                    }
                     m_playlists[target_playlist].unlock();
                     field->unblock();
                     return index != -1 && end_function(target_playlist);
@@ -345,6 +359,39 @@ bool TrackModel::requestClipInsertion(int clipId, int position, bool updateView,
     return false;
 }
 
+bool TrackModel::requestClipBulkInsertion(int clipId, int position)
+{
+    QWriteLocker locker(&m_lock);
+    if (isLocked() || position < 0) {
+        return false;
+    }
+    if (auto ptr = m_parent.lock()) {
+        std::shared_ptr<ClipModel> clip = ptr->getClipPtr(clipId);
+        if ((isAudioTrack() && !clip->canBeAudio()) || (!isAudioTrack() && !clip->canBeVideo())) {
+            return false;
+        }
+        // The operations are only kept to restore the clip state on failure
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        bool res = true;
+        if (clip->clipState() != PlaylistState::Disabled) {
+            res = clip->setClipState(isAudioTrack() ? PlaylistState::AudioOnly : PlaylistState::VideoOnly, undo, redo);
+        }
+        int duration = trackDuration();
+        res = res && requestClipInsertion_lambda(clipId, position, true, true)();
+        if (res) {
+            if (duration != trackDuration()) {
+                m_effectStack->adjustStackLength(true, 0, duration, 0, trackDuration(), 0, undo, redo, true);
+            }
+            return true;
+        }
+        bool undone = undo();
+        Q_ASSERT(undone);
+        return false;
+    }
+    return false;
+}
+
 void TrackModel::adjustStackLength(int duration, int newDuration, Fun &undo, Fun &redo)
 {
     m_effectStack->adjustStackLength(true, 0, duration, 0, newDuration, 0, undo, redo, true);
@@ -438,10 +485,17 @@ Fun TrackModel::requestClipDeletion_lambda(int clipId, bool updateView, bool fin
         Q_ASSERT(!m_playlists[target_track].is_blank(target_clip));
         auto prod = m_playlists[target_track].replace_with_blank(target_clip);
         if (prod != nullptr) {
-            m_playlists[target_track].consolidate_blanks();
+            if (m_batchDepth > 0) {
+                mergeBlanksAround(target_track, target_clip);
+                m_batchModified = true;
+            } else {
+                m_playlists[target_track].consolidate_blanks();
+            }
             m_allClips[clipId]->setCurrentTrackId(-1);
             // m_allClips[clipId]->setSubPlaylistIndex(-1);
+            m_clipsByPosition.erase({m_allClips[clipId]->getPosition(), clipId});
             m_allClips.erase(clipId);
+            m_clipRows.remove(clipId);
             delete prod;
             field->unblock();
             m_playlists[target_track].unlock();
@@ -710,7 +764,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
             // The second is parameter is delta - 1 because this function expects an out time, which is basically size - 1
             m_playlists[target_track].insert_blank(blank_index, delta - 1);
             if (!right) {
-                m_allClips[clipId]->setPosition(clip_position + delta);
+                setClipPosition(clipId, clip_position + delta);
                 // Because we inserted blank before, the index of our clip has increased
                 target_clip_mutable++;
             }
@@ -809,7 +863,7 @@ Fun TrackModel::requestClipResize_lambda(int clipId, int in, int out, bool right
                     // m_track->unblock();
                 }
                 if (!right && err == 0) {
-                    m_allClips[clipId]->setPosition(m_playlists[target_track].clip_start(target_clip_mutable));
+                    setClipPosition(clipId, m_playlists[target_track].clip_start(target_clip_mutable));
                 }
                 if (err == 0) {
                     update_snaps(m_allClips[clipId]->getPosition(), m_allClips[clipId]->getPosition() + out - in + 1);
@@ -835,14 +889,21 @@ int TrackModel::getId() const
 int TrackModel::getClipByStartPosition(int position) const
 {
     READ_LOCK();
-    for (auto &clip : m_allClips) {
-        if (clip.second->getPosition() == position) {
-            return clip.second->getId();
-        }
+    auto it = m_clipsByPosition.lower_bound({position, -1});
+    if (it != m_clipsByPosition.end() && it->first == position) {
+        return it->second;
     }
     return -1;
 }
 
+void TrackModel::setClipPosition(int clipId, int position)
+{
+    const std::shared_ptr<ClipModel> &clip = m_allClips.at(clipId);
+    m_clipsByPosition.erase({clip->getPosition(), clipId});
+    clip->setPosition(position);
+    m_clipsByPosition.emplace(position, clipId);
+}
+
 int TrackModel::getClipByPosition(int position, int playlist)
 {
     READ_LOCK();
@@ -905,27 +966,30 @@ int TrackModel::getCompositionByPosition(int position)
 int TrackModel::getClipByRow(int row) const
 {
     READ_LOCK();
-    if (row >= static_cast<int>(m_allClips.size())) {
-        return -1;
-    }
-    auto it = m_allClips.cbegin();
-    std::advance(it, row);
-    return (*it).first;
+    return m_clipRows.at(row);
 }
 
 std::unordered_set<int> TrackModel::getClipsInRange(int position, int end)
 {
     READ_LOCK();
     std::unordered_set<int> ids;
-    for (const auto &clp : m_allClips) {
-        int pos = clp.second->getPosition();
-        int length = clp.second->getPlaytime();
-        if (end > -1 && pos >= end) {
-            continue;
+    auto first = m_clipsByPosition.lower_bound({position, -1});
+    // Clips starting before the range may overlap it. Clips of a playlist never overlap, and a clip only
+    // overlaps clips of the other playlist in the mixes at its start and end, so no clip lies inside another.
+    // A clip ending before the range therefore has no earlier clip reaching the range, walking back stops there.
+    auto it = first;
+    while (it != m_clipsByPosition.begin()) {
+        --it;
+        if (it->first + m_allClips.at(it->second)->getPlaytime() - 1 < position) {
+            break;
         }
-        if (pos >= position || pos + length - 1 >= position) {
-            ids.insert(clp.first);
+        ids.insert(it->second);
+    }
+    for (it = first; it != m_clipsByPosition.end(); ++it) {
+        if (end > -1 && it->first >= end) {
+            break;
         }
+        ids.insert(it->second);
     }
     return ids;
 }
@@ -934,7 +998,7 @@ int TrackModel::getRowfromClip(int clipId) const
 {
     READ_LOCK();
     Q_ASSERT(m_allClips.count(clipId) > 0);
-    return int(std::distance(m_allClips.begin(), m_allClips.find(clipId)));
+    return m_clipRows.row(clipId);
 }
 
 std::unordered_set<int> TrackModel::getCompositionsInRange(int position, int end)
@@ -942,16 +1006,19 @@ std::unordered_set<int> TrackModel::getCompositionsInRange(int position, int end
     READ_LOCK();
     // TODO: this function doesn't take into accounts the fact that there are two tracks
     std::unordered_set<int> ids;
-    for (const auto &compo : m_allCompositions) {
-        int pos = compo.second->getPosition();
-        int length = compo.second->getPlaytime();
-        if (end > -1 && pos >= end) {
-            continue;
+    auto it = m_compoPos.lower_bound(position);
+    if (it != m_compoPos.begin()) {
+        // Compositions don't overlap, only the previous one can end in the range
+        auto previous = std::prev(it);
+        if (previous->first + m_allCompositions.at(previous->second)->getPlaytime() - 1 >= position) {
+            ids.insert(previous->second);
         }
-        if (pos >= position || pos + length - 1 >= position) {
-
-            ids.insert(compo.first);
+    }
+    for (; it != m_compoPos.end(); ++it) {
+        if (end > -1 && it->first >= end) {
+            break;
         }
+        ids.insert(it->second);
     }
     return ids;
 }
@@ -960,7 +1027,7 @@ int TrackModel::getRowfromComposition(int tid) const
 {
     READ_LOCK();
     Q_ASSERT(m_allCompositions.count(tid) > 0);
-    return int(m_allClips.size()) + int(std::distance(m_allCompositions.begin(), m_allCompositions.find(tid)));
+    return m_clipRows.size() + m_compositionRows.row(tid);
 }
 
 QVariant TrackModel::getProperty(const QString &name) const
@@ -1011,6 +1078,14 @@ bool TrackModel::checkConsistency()
         clips.emplace_back(c.second->getPosition(), c.first);
     }
     std::sort(clips.begin(), clips.end());
+    if (!std::equal(clips.begin(), clips.end(), m_clipsByPosition.begin(), m_clipsByPosition.end())) {
+        qDebug() << "Error: clips position index doesn't match the clips";
+        return false;
+    }
+    if (m_clipRows.size() != int(m_allClips.size()) || m_compositionRows.size() != int(m_allCompositions.size())) {
+        qDebug() << "Error: the rows index doesn't match the number of items";
+        return false;
+    }
     int last_out = 0;
     for (size_t i = 0; i < clips.size(); ++i) {
         auto cur_clip = m_allClips[clips[i].second];
@@ -1480,6 +1555,7 @@ Fun TrackModel::requestCompositionDeletion_lambda(int compoId, bool updateView,
         }
         m_allCompositions[compoId]->setCurrentTrackId(-1);
         m_allCompositions.erase(compoId);
+        m_compositionRows.remove(compoId);
         m_compoPos.erase(old_in);
         ptr->m_snaps->removePoint(old_in);
         ptr->m_snaps->removePoint(old_out);
@@ -1497,9 +1573,7 @@ int TrackModel::getCompositionByRow(int row) const
         return -1;
     }
     Q_ASSERT(row <= int(m_allClips.size() + m_allCompositions.size()));
-    auto it = m_allCompositions.cbegin();
-    std::advance(it, row - int(m_allClips.size()));
-    return (*it).first;
+    return m_compositionRows.at(row - m_clipRows.size());
 }
 
 int TrackModel::getCompositionsCount() const
@@ -1523,6 +1597,7 @@ Fun TrackModel::requestCompositionInsertion_lambda(int compoId, int position, bo
             if (auto ptr = m_parent.lock()) {
                 std::shared_ptr<CompositionModel> composition = ptr->getCompositionPtr(compoId);
                 m_allCompositions[composition->getId()] = composition; // store clip
+                m_compositionRows.insert(compoId);
                 // update clip position and track
                 composition->setCurrentTrackId(getId());
                 int new_in = position;
@@ -1670,6 +1745,66 @@ void TrackModel::unlock()
     }
 }
 
+void TrackModel::beginPlaylistBatch()
+{
+    if (m_batchDepth++ > 0) {
+        return;
+    }
+    m_batchModified = false;
+    m_batchField.reset(m_track->field());
+    m_batchField->block();
+    for (auto &playlist : m_playlists) {
+        playlist.lock();
+    }
+}
+
+void TrackModel::endPlaylistBatch()
+{
+    Q_ASSERT(m_batchDepth > 0);
+    if (--m_batchDepth > 0) {
+        return;
+    }
+    for (auto &playlist : m_playlists) {
+        if (m_batchModified) {
+            playlist.consolidate_blanks();
+        }
+        playlist.unlock();
+    }
+    m_batchField->unblock();
+    m_batchField.reset();
+}
+
+void TrackModel::mergeBlanksAround(int playlist, int index)
+{
+    Mlt::Playlist &pl = m_playlists[playlist];
+    if (index + 1 < pl.count() && pl.is_blank(index + 1)) {
+        pl.resize_clip(index, 0, pl.clip_length(index) + pl.clip_length(index + 1) - 1);
+        pl.remove(index + 1);
+    }
+    if (index > 0 && pl.is_blank(index - 1)) {
+        pl.resize_clip(index - 1, 0, pl.clip_length(index - 1) + pl.clip_length(index) - 1);
+        pl.remove(index);
+        index--;
+    }
+    if (index == pl.count() - 1) {
+        // Don't keep a blank at the end of the playlist
+        pl.remove(index);
+    }
+}
+
+PlaylistBatch::~PlaylistBatch()
+{
+    for (auto it = m_tracks.rbegin(); it != m_tracks.rend(); ++it) {
+        (*it)->endPlaylistBatch();
+    }
+}
+
+void PlaylistBatch::addTrack(const std::shared_ptr<TrackModel> &track)
+{
+    track->beginPlaylistBatch();
+    m_tracks.push_back(track);
+}
+
 bool TrackModel::isAvailable(int position, int duration, int playlist)
 {
     if (playlist == -1) {
@@ -7,14 +7,18 @@
 
 #include "definitions.h"
 #include "undohelper.hpp"
+#include "utils/rowindex.hpp"
 #include <QReadWriteLock>
 #include <QSharedPointer>
 #include <memory>
+#include <mlt++/MltField.h>
 #include <mlt++/MltPlaylist.h>
 #include <mlt++/MltProfile.h>
 #include <mlt++/MltTractor.h>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 class TimelineModel;
 class ClipModel;
@@ -56,6 +60,7 @@ public:
     friend class TimelineItemModel;
     friend class TimelineModel;
     friend class OtioExport;
+    friend class PlaylistBatch;
 
 private:
     /** This constructor is private, call the static construct instead */
@@ -171,6 +176,14 @@ protected:
     void lock();
     void unlock();
 
+    /** @brief Open a batch of playlist mutations on this track, used to move many clips at once.
+       The playlists stay locked until the batch ends, so that the producer never sees an intermediate state.
+       Clip insertions don't consolidate the blanks and clip deletions only merge the blanks around the deleted clip,
+       a single consolidation per playlist is done when the batch ends. Batches can be nested.
+       Prefer using the PlaylistBatch guard. */
+    void beginPlaylistBatch();
+    void endPlaylistBatch();
+
     /** @brief Returns a lambda that performs a resize of the given clip.
        The lambda returns true if the operation succeeded, and otherwise nothing is modified
        This method is protected because it shouldn't be called directly. Call the function in the timeline instead.
@@ -194,6 +207,10 @@ protected:
     */
     bool requestClipInsertion(int clipId, int position, bool updateView, bool finalMove, Fun &undo, Fun &redo, bool groupMove = false, bool newInsertion = true,
                               const QList<int> &allowedClipMixes = {}, bool bypassLock = false);
+    /** @brief Performs the insertion of a newly constructed clip while the timeline is bulk loading.
+       Same as requestClipInsertion(), but no undo operation is built since loading is never undone.
+    */
+    bool requestClipBulkInsertion(int clipId, int position);
     /** @brief This function returns a lambda that performs the requested operation */
     Fun requestClipInsertion_lambda(int clipId, int position, bool updateView, bool finalMove, bool groupMove = false, const QList<int> &allowedClipMixes = {});
 
@@ -367,6 +384,16 @@ private:
     /** This is important to keep an ordered structure to store the compositions, since we use their ids order as row order*/
     std::map<int, std::shared_ptr<CompositionModel>> m_allCompositions;
 
+    /** Clips ordered by position, as {position, clip id}, for range queries. Clips of the two playlists overlap in mixes,
+     *  but a clip never contains another one, so the clips ends are in the same order as their starts
+     */
+    std::set<std::pair<int, int>> m_clipsByPosition;
+    /** Rows of the clips and compositions in the model, mirroring the ids of m_allClips and m_allCompositions */
+    RowIndex m_clipRows;
+    RowIndex m_compositionRows;
+    /** @brief Set the position of a clip stored in m_allClips, keeping m_clipsByPosition in sync */
+    void setClipPosition(int clipId, int position);
+
     /** We store the positions of the compositions. In Melt, the compositions are not inserted at the track level, but we keep
      *  those positions here to check for moves and resize
      */
@@ -374,6 +401,14 @@ private:
 
     /// This is a lock that ensures safety in case of concurrent access
     mutable QReadWriteLock m_lock;
+    /** @brief Nesting level of playlist batches, see beginPlaylistBatch() */
+    int m_batchDepth{0};
+    /** @brief True if a playlist was modified in the current batch */
+    bool m_batchModified{false};
+    std::unique_ptr<Mlt::Field> m_batchField;
+    /** @brief Merge the blank at @p index, which just replaced a clip, with its blank neighbours, and remove it if it ends the playlist.
+       This gives the same result as consolidate_blanks() on a playlist that had its blanks consolidated */
+    void mergeBlanksAround(int playlist, int index);
     void reverseCompositionXml(const QString &composition, QDomElement xml);
     void updateCompositionDirection(Mlt::Transition &transition, bool reverse);
 
@@ -383,3 +418,19 @@ protected:
     /// A list of same track transitions for this track, in the form: {second_clip_id, transition}
     std::unordered_map<int, std::shared_ptr<AssetParameterModel>> m_sameCompositions;
 };
+
+/** @class PlaylistBatch
+    @brief Keeps a playlist batch open on a set of tracks until it goes out of scope, see TrackModel::beginPlaylistBatch()
+ */
+class PlaylistBatch
+{
+public:
+    PlaylistBatch() = default;
+    ~PlaylistBatch();
+    PlaylistBatch(const PlaylistBatch &) = delete;
+    PlaylistBatch &operator=(const PlaylistBatch &) = delete;
+    void addTrack(const std::shared_ptr<TrackModel> &track);
+
+private:
+    std::vector<std::shared_ptr<TrackModel>> m_tracks;
+};
@@ -13,18 +13,27 @@
 #include "kdenlivesettings.h"
 #include "mainwindow.h"
 #include "monitor/monitor.h"
+#include "monitor/monitormanager.h"
 #include "profiles/profilemodel.hpp"
 #include "timeline2/view/timelinecontroller.h"
 #include "timeline2/view/timelinewidget.h"
+#include "utils/cachemanager.hpp"
 #include "xml/xml.hpp"
 
 #include <KLocalizedString>
+#include <kmemoryinfo.h>
 #include <KMessageBox>
 #include <QCollator>
 #include <QCryptographicHash>
 #include <QMutexLocker>
 #include <QSaveFile>
 #include <QStandardPaths>
+#include <QThread>
+
+namespace {
+// Maximum number of neighbour chunks a render process renders in a row before the next process
+constexpr int MAX_CHUNK_BLOCK = 4;
+} // namespace
 
 PreviewManager::PreviewManager(Mlt::Tractor *tractor, QUuid uuid, QObject *parent)
     : QObject(parent)
@@ -39,7 +48,6 @@ PreviewManager::PreviewManager(Mlt::Tractor *tractor, QUuid uuid, QObject *paren
 {
     m_previewGatherTimer.setSingleShot(true);
     m_previewGatherTimer.setInterval(200);
-    QObject::connect(&m_previewProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &PreviewManager::processEnded);
 
     if (KdenliveSettings::kdenliverendererpath().isEmpty() || !QFileInfo::exists(KdenliveSettings::kdenliverendererpath())) {
         KdenliveSettings::setKdenliverendererpath(QString());
@@ -49,9 +57,6 @@ PreviewManager::PreviewManager(Mlt::Tractor *tractor, QUuid uuid, QObject *paren
                                i18n("Could not find the kdenlive_render application, something is wrong with your installation. Rendering will not work"));
         }
     }
-
-    connect(this, &PreviewManager::abortPreview, &m_previewProcess, &QProcess::kill, Qt::DirectConnection);
-    connect(&m_previewProcess, &QProcess::readyReadStandardError, this, &PreviewManager::receivedStderr);
 }
 
 PreviewManager::~PreviewManager()
@@ -525,7 +530,7 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
     }
     if (add) {
         Q_EMIT dirtyChunksChanged();
-        if (m_previewProcess.state() == QProcess::NotRunning && KdenliveSettings::autopreview()) {
+        if (!processRunning() && KdenliveSettings::autopreview()) {
             m_previewTimer.start();
         }
     } else {
@@ -534,7 +539,7 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
             // Nothing to do, abort
             return;
         }
-        bool isRendering = m_previewProcess.state() != QProcess::NotRunning;
+        bool isRendering = processRunning();
         Fun undo = [this, dirty = toRemove]() {
             for (int ix : std::as_const(dirty)) {
                 m_dirtyChunks << ix;
@@ -583,21 +588,39 @@ void PreviewManager::addPreviewRange(const QPoint zone, bool add)
 
 void PreviewManager::abortRendering()
 {
-    if (m_previewProcess.state() == QProcess::NotRunning) {
+    m_resumeRender = false;
+    if (!processRunning()) {
         return;
     }
     // Don't display error message on voluntary abort
     m_warnOnCrash = false;
-    Q_EMIT abortPreview();
-    m_previewProcess.waitForFinished();
-    if (m_previewProcess.state() != QProcess::NotRunning) {
-        m_previewProcess.kill();
-        m_previewProcess.waitForFinished();
-    }
+    killProcesses();
     // Re-init time estimation
     Q_EMIT previewRender(-1, QString(), 1000);
 }
 
+bool PreviewManager::processRunning() const
+{
+    for (const auto &process : m_previewProcesses) {
+        if (process->state() != QProcess::NotRunning) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PreviewManager::killProcesses()
+{
+    Q_EMIT abortPreview();
+    for (const auto &process : m_previewProcesses) {
+        process->waitForFinished();
+        if (process->state() != QProcess::NotRunning) {
+            process->kill();
+            process->waitForFinished();
+        }
+    }
+}
+
 bool PreviewManager::hasDefinedRange() const
 {
     return (!m_renderedChunks.isEmpty() || !m_dirtyChunks.isEmpty());
@@ -630,24 +653,164 @@ void PreviewManager::startPreviewRender()
     }
 }
 
-void PreviewManager::receivedStderr()
+void PreviewManager::receivedStderr(QProcess *process)
 {
-    QStringList resultList = QString::fromLocal8Bit(m_previewProcess.readAllStandardError()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    bool chunkDone = false;
+    QStringList resultList = QString::fromLocal8Bit(process->readAllStandardError()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
     for (auto &result : resultList) {
         if (result.startsWith(QLatin1String("START:"))) {
-            if (m_previewProcess.state() == QProcess::Running) {
-                workingPreview = result.section(QLatin1String("START:"), 1).simplified().toInt();
-                Q_EMIT workingPreviewChanged();
+            if (process->state() == QProcess::Running) {
+                m_workingChunks.insert(process, result.section(QLatin1String("START:"), 1).simplified().toInt());
+                updateWorkingPreview();
             }
         } else if (result.startsWith(QLatin1String("DONE:"))) {
             int chunk = result.section(QLatin1String("DONE:"), 1).simplified().toInt();
+            m_workingChunks.remove(process);
+            m_processQueues[process].removeOne(chunk);
+            updateWorkingPreview();
+            // Progress is aggregated over all render processes
             m_processedChunks++;
             QString fileName = QStringLiteral("%1.%2").arg(chunk).arg(m_extension);
             Q_EMIT previewRender(chunk, m_cacheDir.absoluteFilePath(fileName), 1000 * m_processedChunks / m_chunksToRender);
+            chunkDone = true;
         } else {
             m_errorLog.append(result);
         }
     }
+    if (chunkDone) {
+        // A process is between two chunks, good time to follow the playhead
+        checkPriority();
+    }
+}
+
+void PreviewManager::checkPriority()
+{
+    if (!pCore->window() || pCore->monitorManager()->projectMonitor()->isPlaying()) {
+        // Don't chase the playhead during playback, the render would restart all the time
+        return;
+    }
+    const int chunkSize = KdenliveSettings::timelinechunks();
+    const int playhead = pCore->getMonitorPosition();
+    if (qAbs(playhead - m_scheduledPosition) < chunkSize * int(m_previewProcesses.size())) {
+        return;
+    }
+    QList<int> remaining;
+    for (const QList<int> &queue : std::as_const(m_processQueues)) {
+        remaining << queue;
+    }
+    if (remaining.isEmpty()) {
+        return;
+    }
+    // The chunk that should be rendered first: the first one from the playhead, or the closest one behind it
+    const int playheadChunk = playhead - playhead % chunkSize;
+    int target = -1;
+    for (int chunk : std::as_const(remaining)) {
+        const bool ahead = chunk >= playheadChunk;
+        const bool targetAhead = target >= playheadChunk;
+        if (target < 0 || (ahead && (!targetAhead || chunk < target)) || (!ahead && !targetAhead && chunk > target)) {
+            target = chunk;
+        }
+    }
+    for (const QList<int> &queue : std::as_const(m_processQueues)) {
+        // The first chunk of a queue is usually being rendered, the next one is about to start
+        if (queue.mid(0, 2).contains(target)) {
+            m_scheduledPosition = playhead;
+            return;
+        }
+    }
+    // The playhead moved to a region that would only be rendered later, start again from there
+    m_rescheduling = true;
+    killProcesses();
+    m_rescheduling = false;
+    startProcesses(remaining);
+}
+
+void PreviewManager::updateWorkingPreview()
+{
+    // Show the chunk closest to the playhead as working chunk
+    const int playhead = pCore->getMonitorPosition();
+    int working = -1;
+    for (int chunk : std::as_const(m_workingChunks)) {
+        if (working < 0 || qAbs(chunk - playhead) < qAbs(working - playhead)) {
+            working = chunk;
+        }
+    }
+    if (working != workingPreview) {
+        workingPreview = working;
+        Q_EMIT workingPreviewChanged();
+    }
+}
+
+int PreviewManager::previewWorkers()
+{
+    if (KdenliveSettings::previewworkers() > 0) {
+        return KdenliveSettings::previewworkers();
+    }
+    // The encoders are already multithreaded, so one process for 4 cores keeps the machine busy
+    int workers = QThread::idealThreadCount() / 4;
+    KMemoryInfo memInfo;
+    if (!memInfo.isNull()) {
+        // Each process loads its own copy of the timeline, count 1GB of available memory per process
+        workers = qMin(workers, int(memInfo.availablePhysical() / 1024 / 1024 / 1024));
+    }
+    return qBound(1, workers, 8);
+}
+
+QList<QList<int>> PreviewManager::scheduleChunks(QList<int> chunks, int playhead, int workers)
+{
+    if (chunks.isEmpty()) {
+        return {};
+    }
+    const int chunkSize = KdenliveSettings::timelinechunks();
+    const int playheadChunk = playhead - playhead % chunkSize;
+    // Chunks from the playhead onwards first, then going backwards from the playhead
+    std::sort(chunks.begin(), chunks.end(), [playheadChunk](int c1, int c2) {
+        const bool ahead1 = c1 >= playheadChunk;
+        const bool ahead2 = c2 >= playheadChunk;
+        if (ahead1 != ahead2) {
+            return ahead1;
+        }
+        return ahead1 ? c1 < c2 : c1 > c2;
+    });
+    workers = qBound(1, workers, int(chunks.size()));
+    // Cut the chunks into blocks of neighbour chunks, a process renders a block in a row, reusing its
+    // decoders. Blocks don't cross the playhead and are rendered forward, even behind the playhead.
+    const int blockSize = qBound(1, int((chunks.size() + workers - 1) / workers), MAX_CHUNK_BLOCK);
+    QList<QList<int>> blocks;
+    for (int i = 0; i < chunks.size(); ++i) {
+        const bool ahead = chunks.at(i) >= playheadChunk;
+        if (blocks.isEmpty() || blocks.constLast().size() >= blockSize || (blocks.constLast().constFirst() >= playheadChunk) != ahead) {
+            blocks << QList<int>();
+        }
+        if (ahead) {
+            blocks.last().append(chunks.at(i));
+        } else {
+            blocks.last().prepend(chunks.at(i));
+        }
+    }
+    // Deal blocks in turn, so that all processes progress together from the playhead
+    QList<QList<int>> queues(workers);
+    for (int i = 0; i < blocks.size(); ++i) {
+        queues[i % workers] << blocks.at(i);
+    }
+    return queues;
+}
+
+QList<QStringList> PreviewManager::partitionChunks(const QList<int> &chunks, int playhead, int workers, QList<QList<int>> *queues)
+{
+    QList<QStringList> result;
+    const QList<QList<int>> scheduled = scheduleChunks(chunks, playhead, workers);
+    for (const QList<int> &queue : scheduled) {
+        QVariantList items;
+        for (int chunk : queue) {
+            items << chunk;
+        }
+        result << getCompressedList(items);
+    }
+    if (queues) {
+        *queues = scheduled;
+    }
+    return result;
 }
 
 void PreviewManager::doPreviewRender(const QString &scene)
@@ -657,43 +820,95 @@ void PreviewManager::doPreviewRender(const QString &scene)
         return;
     }
     QMutexLocker lock(&m_dirtyMutex);
-    Q_ASSERT(m_previewProcess.state() == QProcess::NotRunning);
+    Q_ASSERT(!processRunning());
     std::sort(m_dirtyChunks.begin(), m_dirtyChunks.end(), chunkSort);
-    const QStringList dirtyChunks = getCompressedList(m_dirtyChunks);
+    QList<int> chunks;
+    for (const QVariant &chunk : std::as_const(m_dirtyChunks)) {
+        chunks << chunk.toInt();
+    }
     m_chunksToRender = m_dirtyChunks.count();
     m_processedChunks = 0;
-    int chunkSize = KdenliveSettings::timelinechunks();
-    QStringList args{QStringLiteral("preview-chunks"),
-                     scene,
-                     m_cacheDir.absolutePath(),
-                     dirtyChunks.join(QLatin1Char(',')),
-                     QString::number(chunkSize - 1),
-                     pCore->getCurrentProfilePath(),
-                     m_extension,
-                     m_consumerParams.join(QLatin1Char(' '))};
+    m_renderFailed = false;
+    m_renderScene = scene;
     pCore->currentDoc()->previewProgress(0);
-    m_previewProcess.start(KdenliveSettings::kdenliverendererpath(), args);
-    if (m_previewProcess.waitForStarted()) {
-        qDebug() << " -  - -STARTING PREVIEW JOBS . . . STARTED: " << args;
+    startProcesses(chunks);
+}
+
+void PreviewManager::startProcesses(const QList<int> &chunks)
+{
+    // Finished processes may still be emitting signals, don't delete them right away
+    for (auto &process : m_previewProcesses) {
+        process->disconnect(this);
+        disconnect(this, nullptr, process.get(), nullptr);
+        process.release()->deleteLater();
+    }
+    m_previewProcesses.clear();
+    m_workingChunks.clear();
+    m_processQueues.clear();
+    m_scheduledPosition = pCore->getMonitorPosition();
+    QList<QList<int>> queues;
+    const QList<QStringList> shares = partitionChunks(chunks, m_scheduledPosition, previewWorkers(), &queues);
+    int chunkSize = KdenliveSettings::timelinechunks();
+    for (int i = 0; i < shares.size(); ++i) {
+        const QList<int> &queue = queues.at(i);
+        QStringList args{QStringLiteral("preview-chunks"),
+                         m_renderScene,
+                         m_cacheDir.absolutePath(),
+                         shares.at(i).join(QLatin1Char(',')),
+                         QString::number(chunkSize - 1),
+                         pCore->getCurrentProfilePath(),
+                         m_extension,
+                         m_consumerParams.join(QLatin1Char(' '))};
+        auto *process = new QProcess();
+        m_previewProcesses.emplace_back(process);
+        m_processQueues.insert(process, queue);
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+                [this, process](int exitCode, QProcess::ExitStatus status) { processEnded(process, exitCode, status); });
+        connect(process, &QProcess::readyReadStandardError, this, [this, process]() { receivedStderr(process); });
+        connect(this, &PreviewManager::abortPreview, process, &QProcess::kill, Qt::DirectConnection);
+        process->start(KdenliveSettings::kdenliverendererpath(), args);
+        if (process->waitForStarted()) {
+            qDebug() << " -  - -STARTING PREVIEW JOBS . . . STARTED: " << args;
+        }
     }
 }
 
-void PreviewManager::processEnded(int exitCode, QProcess::ExitStatus status)
+void PreviewManager::processEnded(QProcess *process, int exitCode, QProcess::ExitStatus status)
 {
-    const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
-    QFile::remove(sceneList);
-    if (pCore->window() && (status == QProcess::QProcess::CrashExit || exitCode != 0)) {
-        Q_EMIT previewRender(0, m_errorLog, -1);
-        if (workingPreview >= 0) {
-            const QString fileName = QStringLiteral("%1.%2").arg(workingPreview).arg(m_extension);
+    const int workingChunk = m_workingChunks.contains(process) ? m_workingChunks.take(process) : -1;
+    if (m_rescheduling) {
+        // Killed to render in another order, the partial chunk is not valid
+        if (workingChunk >= 0) {
+            m_cacheDir.remove(QStringLiteral("%1.%2").arg(workingChunk).arg(m_extension));
+        }
+        return;
+    }
+    if (pCore->window() && (status == QProcess::CrashExit || exitCode != 0)) {
+        // Only report the first failure
+        if (!m_renderFailed) {
+            m_renderFailed = true;
+            Q_EMIT previewRender(0, m_errorLog, -1);
+        }
+        if (workingChunk >= 0) {
+            const QString fileName = QStringLiteral("%1.%2").arg(workingChunk).arg(m_extension);
             if (m_cacheDir.exists(fileName)) {
                 m_cacheDir.remove(fileName);
             }
         }
-    } else {
+    }
+    if (processRunning()) {
+        updateWorkingPreview();
+        return;
+    }
+    // All processes are done
+    const QString sceneList = m_cacheDir.absoluteFilePath(QStringLiteral("preview.mlt"));
+    QFile::remove(sceneList);
+    if (!m_renderFailed) {
         // Normal exit and exit code 0: everything okay
         pCore->currentDoc()->previewProgress(1000);
     }
+    m_workingChunks.clear();
+    m_processQueues.clear();
     workingPreview = -1;
     m_warnOnCrash = true;
     Q_EMIT workingPreviewChanged();
@@ -705,7 +920,8 @@ void PreviewManager::slotProcessDirtyChunks()
         return;
     }
     invalidatePreviews();
-    if (KdenliveSettings::autopreview()) {
+    if (KdenliveSettings::autopreview() || m_resumeRender) {
+        m_resumeRender = false;
         m_previewTimer.start();
     }
 }
@@ -739,7 +955,7 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
     int end = endFrame - endFrame % chunkSize;
     bool timerWasRunning = m_previewGatherTimer.isActive();
     m_previewGatherTimer.stop();
-    bool previewWasRunning = m_previewProcess.state() == QProcess::Running;
+    bool previewWasRunning = processRunning();
     bool alreadyRendered = false;
     bool wasInDirtyZone = false;
     if (!m_renderedChunks.isEmpty()) {
@@ -747,8 +963,13 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
         std::sort(m_renderedChunks.begin(), m_renderedChunks.end(), chunkSort);
         if (start <= m_renderedChunks.last().toInt() && end >= m_renderedChunks.first().toInt()) {
             alreadyRendered = true;
-        } else if (workingPreview >= start && workingPreview <= end) {
-            alreadyRendered = true;
+        } else {
+            for (int chunk : std::as_const(m_workingChunks)) {
+                if (chunk >= start && chunk <= end) {
+                    alreadyRendered = true;
+                    break;
+                }
+            }
         }
     }
     if (!alreadyRendered && !m_dirtyChunks.isEmpty()) {
@@ -760,7 +981,9 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
     }
     if (alreadyRendered) {
         if (previewWasRunning) {
+            // Preempt the render, it will resume with the new timeline once the edits are gathered
             abortRendering();
+            m_resumeRender = true;
         }
         m_tractor->lock();
         bool chunksChanged = false;
@@ -791,6 +1014,7 @@ void PreviewManager::invalidatePreview(int startFrame, int endFrame)
         // Abort rendering, playlist needs to be recreated
         if (previewWasRunning) {
             abortRendering();
+            m_resumeRender = true;
         }
     } else if (!timerWasRunning) {
         // Invalidated zone outside our rendered zones
@@ -850,6 +1074,7 @@ void PreviewManager::gotPreviewRender(int frame, const QString &file, int progre
             m_dirtyChunks.removeAll(QVariant(frame));
             m_dirtyMutex.unlock();
             m_renderedChunks << frame;
+            CacheManager::get()->recordWrite(file);
             Q_EMIT renderedChunksChanged();
             prod.set("mlt_service", "avformat-novalidate");
             m_tractor->lock();
@@ -869,8 +1094,7 @@ void PreviewManager::gotPreviewRender(int frame, const QString &file, int progre
 
 void PreviewManager::corruptedChunk(int frame, const QString &fileName)
 {
-    Q_EMIT abortPreview();
-    m_previewProcess.waitForFinished();
+    killProcesses();
     if (workingPreview >= 0) {
         workingPreview = -1;
         Q_EMIT workingPreviewChanged();
@@ -910,7 +1134,7 @@ QPair<QStringList, QStringList> PreviewManager::previewChunks()
     return {renderedChunks, dirtyChunks};
 }
 
-const QStringList PreviewManager::getCompressedList(const QVariantList items) const
+const QStringList PreviewManager::getCompressedList(const QVariantList items)
 {
     QStringList resultString;
     int lastFrame = -1;
@@ -971,5 +1195,5 @@ int PreviewManager::addedTracks() const
 
 bool PreviewManager::isRunning() const
 {
-    return workingPreview >= 0 || m_previewProcess.state() != QProcess::NotRunning;
+    return workingPreview >= 0 || processRunning();
 }
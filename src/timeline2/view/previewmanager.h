@@ -10,11 +10,15 @@
 
 #include <QDir>
 #include <QFuture>
+#include <QHash>
 #include <QMutex>
 #include <QProcess>
 #include <QTimer>
 #include <QUuid>
 
+#include <memory>
+#include <vector>
+
 class TimelineController;
 
 namespace Mlt {
@@ -38,6 +42,7 @@ class PreviewManager : public QObject
 public:
     friend class TimelineModel;
     friend class TimelineController;
+    friend class KdenliveTests;
 
     explicit PreviewManager(Mlt::Tractor *tractor, QUuid uuid, QObject *parent = nullptr);
     ~PreviewManager() override;
@@ -79,6 +84,13 @@ public:
     bool hasDefinedRange() const;
     /** @brief Returns true if the render process is still running */
     bool isRunning() const;
+    /** @brief Number of kdenlive_render processes used for preview rendering, from settings or machine resources */
+    static int previewWorkers();
+    /** @brief Split chunks between render processes: chunks from @p playhead onwards first, then backwards from the playhead.
+     *  Each process gets blocks of neighbour chunks, so that it renders contiguous ranges.
+     *  @returns one list of chunks per process, each in rendering order
+     */
+    static QList<QList<int>> scheduleChunks(QList<int> chunks, int playhead, int workers);
 
 private:
     Mlt::Tractor *m_tractor;
@@ -87,8 +99,22 @@ private:
     Mlt::Playlist *m_overlayTrack;
     bool m_warnOnCrash;
     int m_previewTrackIndex;
-    /** @brief: The kdenlive timeline preview process. */
-    QProcess m_previewProcess;
+    /** @brief: The kdenlive timeline preview processes, each one rendering a share of the dirty chunks. */
+    std::vector<std::unique_ptr<QProcess>> m_previewProcesses;
+    /** @brief: The chunk currently rendered by each process. */
+    QHash<QProcess *, int> m_workingChunks;
+    /** @brief: The chunks each process still has to render, in rendering order. */
+    QHash<QProcess *, QList<int>> m_processQueues;
+    /** @brief: True if one of the render processes crashed or failed. */
+    bool m_renderFailed{false};
+    /** @brief: The playlist rendered by the processes. */
+    QString m_renderScene;
+    /** @brief: Playhead position the rendering order was computed for. */
+    int m_scheduledPosition{-1};
+    /** @brief: True while processes are killed to restart rendering from the playhead. */
+    bool m_rescheduling{false};
+    /** @brief: True if rendering was interrupted by an edit and should restart once the changes are processed. */
+    bool m_resumeRender{false};
     /** @brief: The directory used to store the preview files. */
     QDir m_cacheDir;
     /** @brief: The directory used to store undo history of preview files (child of m_cacheDir). */
@@ -114,7 +140,21 @@ private:
     /** @brief: A chunk failed to render, abort. */
     void corruptedChunk(int workingPreview, const QString &fileName);
     /** @brief: Get a compressed list of chunks, like: "0-500,525,575". */
-    const QStringList getCompressedList(const QVariantList items) const;
+    static const QStringList getCompressedList(const QVariantList items);
+    /** @brief Compressed chunk lists for each render process, see scheduleChunks()
+     *  @param queues If not null, receives the matching chunk queues
+     */
+    static QList<QStringList> partitionChunks(const QList<int> &chunks, int playhead, int workers, QList<QList<int>> *queues = nullptr);
+    /** @brief: Returns true if one of the render processes is running. */
+    bool processRunning() const;
+    /** @brief: Kill all render processes and wait for them. */
+    void killProcesses();
+    /** @brief: Set workingPreview to the chunk being rendered closest to the playhead. */
+    void updateWorkingPreview();
+    /** @brief: Start render processes for @p chunks, ordered from the current playhead. */
+    void startProcesses(const QList<int> &chunks);
+    /** @brief: Restart rendering from the playhead if it moved to a region that would only be rendered later. */
+    void checkPriority();
 
     /** @brief Compare two chunks for usage by std::sort
      * @returns true if @param c1 is less than @param c2
@@ -131,8 +171,8 @@ private Q_SLOTS:
     /** @brief: When the timer collecting invalid zones is done, process. */
     void slotProcessDirtyChunks();
     /** @brief: Process preview rendering output. */
-    void receivedStderr();
-    void processEnded(int exitCode, QProcess::ExitStatus status);
+    void receivedStderr(QProcess *process);
+    void processEnded(QProcess *process, int exitCode, QProcess::ExitStatus status);
 
 public Q_SLOTS:
     /** @brief: Prepare and start rendering. */
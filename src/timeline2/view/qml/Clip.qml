@@ -56,6 +56,8 @@ Rectangle {
     property int clipId: -1     //Id of the clip in the model
     property int trackId: -1 // Id of the parent track in the model
     property int fakeTid: -1
+    // Parent of the item before it was moved to the drag container for a fake move
+    property var parentBeforeDrag
     property int fakePosition: 0
     property int originalTrackId: -1
     property int originalX: x
@@ -177,6 +179,7 @@ Rectangle {
         if (clipRoot.fakeTid > -1 && parentTrack) {
             if (clipRoot.parent != dragContainer) {
                 var pos = clipRoot.mapToGlobal(clipRoot.x, clipRoot.y);
+                clipRoot.parentBeforeDrag = clipRoot.parent
                 clipRoot.parent = dragContainer
                 pos = clipRoot.mapFromGlobal(pos.x, pos.y)
                 clipRoot.x = pos.x
@@ -185,6 +188,13 @@ Rectangle {
             clipRoot.y = Logic.getTrackById(clipRoot.fakeTid).y
             clipRoot.height = Logic.getTrackById(clipRoot.fakeTid).height
         } else if (parentTrack) {
+            if (clipRoot.parent == dragContainer && clipRoot.parentBeforeDrag) {
+                // Ghost drag ended without recreating the item, put it back in its track
+                clipRoot.parent = clipRoot.parentBeforeDrag
+                clipRoot.parentBeforeDrag = undefined
+                clipRoot.x = clipRoot.modelStart * clipRoot.timeScale
+                clipRoot.y = 0
+            }
             clipRoot.height = Qt.binding(function () {
                 return parentTrack.height
             })
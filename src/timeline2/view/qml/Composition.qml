@@ -36,6 +36,8 @@ Item {
     property int trackIndex //Index in track repeater
     property int trackId: -42    //Id in the model
     property int fakeTid: -1
+    // Parent of the item before it was moved to the drag container for a fake move
+    property var parentBeforeDrag
     property int fakePosition: 0
     property int aTrack: -1
     property int clipId     //Id of the clip in the model
@@ -97,6 +99,7 @@ Item {
         if (compositionRoot.fakeTid > -1 && parentTrack) {
             if (compositionRoot.parent != dragContainer) {
                 var pos = compositionRoot.mapToGlobal(compositionRoot.x, compositionRoot.y);
+                compositionRoot.parentBeforeDrag = compositionRoot.parent
                 compositionRoot.parent = dragContainer
                 pos = compositionRoot.mapFromGlobal(pos.x, pos.y)
                 compositionRoot.x = pos.x
@@ -105,6 +108,15 @@ Item {
             compositionRoot.y = Logic.getTrackById(compositionRoot.fakeTid).y
             compositionRoot.height = Logic.getTrackById(compositionRoot.fakeTid).height
         } else {
+            if (compositionRoot.parent == dragContainer && compositionRoot.parentBeforeDrag) {
+                // Ghost drag ended without recreating the item, put it back in its track
+                compositionRoot.parent = compositionRoot.parentBeforeDrag
+                compositionRoot.parentBeforeDrag = undefined
+                compositionRoot.x = compositionRoot.modelStart * compositionRoot.timeScale
+                compositionRoot.y = Qt.binding(function () {
+                    return compositionRoot.trackOffset
+                })
+            }
             compositionRoot.height = Qt.binding(function () {
                 return parentTrack.height
             })
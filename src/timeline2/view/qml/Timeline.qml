@@ -557,6 +557,18 @@ Rectangle {
         onTriggered: timeline.autofitTrackHeight(scrollView.height - subtitleTrack.height, root.collapsedHeight)
     }
 
+    Timer {
+        // Generate the thumbnails that will be shown next, at most once per interval while scrolling
+        id: thumbPrefetchTimer
+        interval: 150; running: false; repeat: false
+        property real lastContentX: 0
+        onTriggered: {
+            var direction = scrollView.contentX > lastContentX ? 1 : scrollView.contentX < lastContentX ? -1 : 0
+            lastContentX = scrollView.contentX
+            timeline.prefetchThumbnails(root.scrollMin, root.scrollMax, direction)
+        }
+    }
+
     onHeightChanged: {
         if (root.autoTrackHeight) {
             trackHeightTimer.restart()
@@ -1626,6 +1638,9 @@ Rectangle {
                         pixelAligned: true
                         onContentXChanged: {
                             root.mousePosChanged(scrollView.contentX - trackHeaders.width)
+                            if (!thumbPrefetchTimer.running) {
+                                thumbPrefetchTimer.start()
+                            }
                         }
                         /*
                          // Replaced by our custom ZoomBar
@@ -1700,6 +1715,8 @@ Rectangle {
                                     property int dragFrame
                                     property int snapping: root.snapping
                                     property bool moveMirrorTracks: true
+                                    // Clips are only moved in the model on release, the view displays ghosts while dragging
+                                    property bool ghostMove: false
                                     cursorShape: {
                                         if (root.activeTool === K.ToolType.SelectTool) {
                                             return dragProxyArea.drag.active ? Qt.ClosedHandCursor : Qt.OpenHandCursor
@@ -1769,6 +1786,7 @@ Rectangle {
                                                 dragProxy.masterObject.originalX = dragProxy.masterObject.x
                                                 dragProxy.masterObject.originalTrackId = dragProxy.masterObject.trackId
                                                 dragProxy.sourceFrame = dragProxy.masterObject.modelStart
+                                                ghostMove = K.KdenliveSettings.ghostdrag && controller.normalEdit() && !dragProxy.isComposition
                                                 dragProxy.masterObject.forceActiveFocus();
                                             } else {
                                                 root.mainItemId = -1
@@ -1816,7 +1834,7 @@ Rectangle {
                                                     dragProxy.masterObject.x = pos.x
                                                     dragProxy.masterObject.y = pos.y
                                                 }
-                                                var moveData = controller.suggestClipMove(dragProxy.draggedItem, tId, posx, root.consumerPosition, dragProxyArea.snapping, moveMirrorTracks)
+                                                var moveData = controller.suggestClipMove(dragProxy.draggedItem, tId, posx, root.consumerPosition, dragProxyArea.snapping, moveMirrorTracks, ghostMove)
                                                 dragProxyArea.dragFrame = moveData[0]
                                                 timeline.activeTrack = moveData[1]
                                                 //timeline.getItemMovingTrack(dragProxy.draggedItem)
@@ -1853,7 +1871,10 @@ Rectangle {
                                                     timeline.endFakeMove(itemId, dragFrame, true, true, true)
                                                 }
                                             } else {
-                                                if (controller.normalEdit()) {
+                                                if (ghostMove) {
+                                                    // Nothing was moved yet, process the move to the ghost position
+                                                    controller.endGhostMove(itemId, dragFrame, moveMirrorTracks)
+                                                } else if (controller.normalEdit()) {
                                                     // Move clip back to original position
                                                     controller.requestClipMove(itemId, sourceTrack, sourceFrame, moveMirrorTracks, true, false, false, true)
                                                     // Move clip to final pos
@@ -83,20 +83,20 @@ void TimelineWaveform::drawWaveformPath(QPainter *painter, const int ch, const i
 
 void TimelineWaveform::compute()
 {
-    QVector<int16_t> levels;
+    AudioLevelsPyramid pyramid;
     if (m_binId.isEmpty()) {
         return;
     }
     if (m_stream >= 0) {
-        levels = pCore->projectItemModel()->getAudioLevelsByBinID(m_binId, m_stream);
-        if (levels.isEmpty()) {
+        pyramid = pCore->projectItemModel()->getAudioLevelsByBinID(m_binId, m_stream);
+        if (pyramid.isEmpty()) {
             return;
         }
     }
 
     const auto inPoint = static_cast<int>(m_inPoint);
     auto outPoint = static_cast<int>(m_outPoint);
-    const auto clipLength = levels.size() / AUDIOLEVELS_POINTS_PER_FRAME / m_channels;
+    const auto clipLength = pyramid.frames();
 
     if (inPoint < 0 || outPoint < 0 || outPoint <= inPoint || inPoint >= clipLength) {
         return;
@@ -108,22 +108,41 @@ void TimelineWaveform::compute()
     }
 
     const double timescale = m_scale / std::abs(m_speed);
-    const int length = outPoint - inPoint;
-    const int inputPoints = AUDIOLEVELS_POINTS_PER_FRAME * length;
     const bool reverse = m_speed < 0;
-    m_pointsPerPixel = static_cast<double>(AUDIOLEVELS_POINTS_PER_FRAME) / timescale;
+
+    // Use the coarsest resolution that still has one point per pixel, so that the work only depends on the displayed width
+    const int level = pyramid.levelForScale(timescale);
+    // Levels are read in place, usually from the memory mapped cache file
+    const int16_t *levels = pyramid.levelData(level);
+    const qsizetype levelSize = pyramid.levelSize(level);
+    const double pointsPerFrame = AudioLevelsPyramid::pointsPerFrame(level);
+    const int levelPoints = int(levelSize / m_channels);
+    const int startPoint = std::min(static_cast<int>(std::floor(inPoint * pointsPerFrame)), levelPoints - 1);
+    const int endPoint = std::max(startPoint + 1, std::min(static_cast<int>(std::ceil(outPoint * pointsPerFrame)), levelPoints));
+    const int inputPoints = endPoint - startPoint;
+    m_pointsPerPixel = pointsPerFrame / timescale;
+    // The first point may start before the in point on coarse levels
+    m_drawOffset = (m_inPoint - startPoint / pointsPerFrame) * timescale;
+
+    QVector<int16_t> visibleLevels;
     if (reverse) {
-        std::reverse(levels.begin(), levels.end());
+        // Same as reversing all levels and extracting the displayed part, without processing the whole clip
+        const int16_t *first = levels + levelSize - endPoint * m_channels;
+        visibleLevels = QVector<int16_t>(first, first + inputPoints * m_channels);
+        std::reverse(visibleLevels.begin(), visibleLevels.end());
+    } else {
+        const int16_t *first = levels + startPoint * m_channels;
+        visibleLevels = QVector<int16_t>(first, first + inputPoints * m_channels);
     }
 
     if (m_pointsPerPixel > 1) {
         // Resample the levels and store them
-        const int outputPoints = std::round(length * timescale);
+        const int outputPoints = std::max(1, static_cast<int>(std::round(inputPoints / m_pointsPerPixel)));
         m_audioLevels.resize(outputPoints * m_channels);
-        computePeaks(&levels[inPoint * AUDIOLEVELS_POINTS_PER_FRAME * m_channels], m_audioLevels.data(), m_channels, inputPoints, outputPoints);
+        computePeaks(visibleLevels.constData(), m_audioLevels.data(), m_channels, inputPoints, outputPoints);
     } else {
         // Just extract the part to be displayed
-        m_audioLevels = levels.mid(inPoint * AUDIOLEVELS_POINTS_PER_FRAME * m_channels, inputPoints * m_channels);
+        m_audioLevels = visibleLevels;
     }
 
     if (!m_separateChannels) {
@@ -155,8 +174,8 @@ void TimelineWaveform::paint(QPainter *painter)
     const auto channels = m_separateChannels ? m_channels : 1;
     const QStringList channelNames{"L", "R", "C", "LFE", "BL", "BR"};
 
-    // if the inpoint is not an integer, start drawing a bit further back so that the visible window is correct
-    const double frac = (m_inPoint - std::floor(m_inPoint)) / m_pointsPerPixel * AUDIOLEVELS_POINTS_PER_FRAME;
+    // if the inpoint does not fall on a point, start drawing a bit further back so that the visible window is correct
+    const double frac = m_drawOffset;
     painter->translate(-frac, 0);
 
     for (int ch = 0; ch < channels; ch++) {
@@ -59,6 +59,8 @@ private:
     bool m_needRecompute{true};
     bool m_drawChannelNames{false};
     double m_pointsPerPixel{1};
+    /** @brief Horizontal offset in pixels between the first computed point and the in point */
+    double m_drawOffset{0};
 
     void drawWaveformLines(QPainter *painter, int ch, int channels, qreal yMiddle, qreal channelHeight);
     void drawWaveformPath(QPainter *painter, int ch, int channels, qreal yMiddle, qreal channelHeight);
@@ -0,0 +1,65 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "thumbnailprefetcher.h"
+#include "bin/projectclip.h"
+#include "bin/projectitemmodel.h"
+#include "core.h"
+#include "thumbnailprovider.h"
+#include "utils/thumbnailcache.hpp"
+
+ThumbnailPrefetcher::ThumbnailPrefetcher()
+{
+    // Leave most of the cores to playback and to the thumbnails requested by QML
+    m_pool.setMaxThreadCount(2);
+    m_pool.setThreadPriority(QThread::LowPriority);
+}
+
+ThumbnailPrefetcher::~ThumbnailPrefetcher()
+{
+    cancel();
+    m_pool.waitForDone();
+}
+
+void ThumbnailPrefetcher::cancel()
+{
+    m_generation++;
+    m_pool.clear();
+}
+
+void ThumbnailPrefetcher::prefetch(const std::vector<std::pair<QString, QList<int>>> &requests)
+{
+    cancel();
+    const int generation = m_generation;
+    for (const auto &request : requests) {
+        const QString binId = request.first;
+        const QList<int> frames = request.second;
+        m_pool.start([this, generation, binId, frames]() {
+            auto outdated = [this, generation]() { return m_generation != generation; };
+            if (outdated() || pCore->projectItemModel()->closing) {
+                return;
+            }
+            std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
+            if (!binClip || !binClip->statusReady()) {
+                return;
+            }
+            QList<int> positions;
+            for (int frame : frames) {
+                const int pos = ThumbnailProvider::clipFrame(binClip, frame);
+                if (!positions.contains(pos)) {
+                    positions << pos;
+                }
+            }
+            const QList<int> missing = ThumbnailCache::get()->loadThumbnails(binId, positions);
+            if (missing.isEmpty() || outdated()) {
+                return;
+            }
+            const QMap<int, QImage> images = ThumbnailProvider::makeThumbnails(binClip, missing, outdated);
+            for (auto it = images.constBegin(); it != images.constEnd(); ++it) {
+                ThumbnailCache::get()->storeThumbnail(binId, it.key(), it.value(), false);
+            }
+        });
+    }
+}
@@ -0,0 +1,40 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+/** @class ThumbnailPrefetcher
+    @brief Produces timeline thumbnails in a background pool before QML asks for them.
+
+    The timeline sends the thumbnails that will be shown next in its scroll direction.
+    Thumbnails found in the persistent cache are decoded to the volatile cache, missing
+    ones are generated with one thumb producer per clip. A new request replaces the
+    previous one, whose pending work is dropped.
+ */
+class ThumbnailPrefetcher
+{
+public:
+    ThumbnailPrefetcher();
+    ~ThumbnailPrefetcher();
+
+    /** @brief Replace the pending requests
+        @param requests list of bin clip id and frames, the most urgent first
+    */
+    void prefetch(const std::vector<std::pair<QString, QList<int>>> &requests);
+    /** @brief Drop all pending requests */
+    void cancel();
+
+private:
+    QThreadPool m_pool;
+    // Incremented on each new request so that outdated jobs stop early
+    std::atomic<int> m_generation{0};
+};
@@ -26,6 +26,7 @@ ThumbnailProvider::~ThumbnailProvider() = default;
 
 QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
 {
+    Q_UNUSED(requestedSize)
     QImage result;
     // id is binID/#frameNumber
     QString binId = id.section('/', 0, 0);
@@ -34,29 +35,15 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
     if (ok) {
         std::shared_ptr<ProjectClip> binClip = pCore->projectItemModel()->getClipByBinID(binId);
         if (binClip) {
-            int duration = binClip->frameDuration();
-            if (frameNumber > duration) {
-                // for endless loopable clips, we rewrite the position
-                frameNumber = frameNumber - ((frameNumber / duration) * duration);
-            }
+            frameNumber = clipFrame(binClip, frameNumber);
             result = ThumbnailCache::get()->getThumbnail(binClip->hashForThumbs(), binId, frameNumber);
             if (!result.isNull()) {
 
                 *size = result.size();
                 return result;
             }
-            std::unique_ptr<Mlt::Producer> prod = binClip->getThumbProducer();
-            if (prod && prod->is_valid()) {
-                if (binClip->clipType() != ClipType::Timeline && binClip->clipType() != ClipType::Playlist) {
-                    Mlt::Profile *prodProfile = &pCore->thumbProfile();
-                    Mlt::Filter scaler(*prodProfile, "swscale");
-                    Mlt::Filter padder(*prodProfile, "resize");
-                    Mlt::Filter converter(*prodProfile, "avcolor_space");
-                    prod->attach(scaler);
-                    prod->attach(padder);
-                    prod->attach(converter);
-                }
-                result = makeThumbnail(std::move(prod), frameNumber, requestedSize);
+            result = makeThumbnails(binClip, {frameNumber}).value(frameNumber);
+            if (!result.isNull()) {
                 ThumbnailCache::get()->storeThumbnail(binId, frameNumber, result, false);
             }
         }
@@ -65,9 +52,46 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
     return result;
 }
 
-QImage ThumbnailProvider::makeThumbnail(std::unique_ptr<Mlt::Producer> producer, int frameNumber, const QSize &requestedSize)
+int ThumbnailProvider::clipFrame(const std::shared_ptr<ProjectClip> &binClip, int frameNumber)
+{
+    int duration = binClip->frameDuration();
+    if (duration > 0 && frameNumber > duration) {
+        // for endless loopable clips, we rewrite the position
+        frameNumber = frameNumber - ((frameNumber / duration) * duration);
+    }
+    return frameNumber;
+}
+
+QMap<int, QImage> ThumbnailProvider::makeThumbnails(const std::shared_ptr<ProjectClip> &binClip, const QList<int> &frames, const std::function<bool()> &cancelled)
+{
+    QMap<int, QImage> result;
+    std::unique_ptr<Mlt::Producer> prod = binClip->getThumbProducer();
+    if (!prod || !prod->is_valid()) {
+        return result;
+    }
+    if (binClip->clipType() != ClipType::Timeline && binClip->clipType() != ClipType::Playlist) {
+        Mlt::Profile *prodProfile = &pCore->thumbProfile();
+        Mlt::Filter scaler(*prodProfile, "swscale");
+        Mlt::Filter padder(*prodProfile, "resize");
+        Mlt::Filter converter(*prodProfile, "avcolor_space");
+        prod->attach(scaler);
+        prod->attach(padder);
+        prod->attach(converter);
+    }
+    for (int frameNumber : frames) {
+        if (cancelled && cancelled()) {
+            break;
+        }
+        QImage img = makeThumbnail(prod.get(), frameNumber);
+        if (!img.isNull()) {
+            result.insert(frameNumber, img);
+        }
+    }
+    return result;
+}
+
+QImage ThumbnailProvider::makeThumbnail(Mlt::Producer *producer, int frameNumber)
 {
-    Q_UNUSED(requestedSize)
     producer->seek(frameNumber);
     std::unique_ptr<Mlt::Frame> frame(producer->get_frame());
     if (frame == nullptr || !frame->is_valid()) {
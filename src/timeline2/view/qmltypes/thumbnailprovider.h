@@ -9,11 +9,15 @@
 
 #include <KImageCache>
 #include <QCache>
+#include <QMap>
 #include <QQuickImageProvider>
+#include <functional>
 #include <memory>
 #include <mlt++/MltProducer.h>
 #include <mlt++/MltProfile.h>
 
+class ProjectClip;
+
 class ThumbnailProvider : public QQuickImageProvider
 {
 public:
@@ -21,7 +25,16 @@ public:
     ~ThumbnailProvider() override;
     QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
 
+    /** @brief Returns the clip frame shown for a requested timeline frame, wrapping positions of endless clips */
+    static int clipFrame(const std::shared_ptr<ProjectClip> &binClip, int frameNumber);
+    /** @brief Generates thumbnails of a clip, reusing the same thumb producer for all frames
+     *  @param frames the frames to generate, in production order
+     *  @param cancelled if set, checked before each frame to abort the generation
+     */
+    static QMap<int, QImage> makeThumbnails(const std::shared_ptr<ProjectClip> &binClip, const QList<int> &frames,
+                                            const std::function<bool()> &cancelled = nullptr);
+
 private:
     Mlt::Profile m_profile;
-    QImage makeThumbnail(std::unique_ptr<Mlt::Producer> producer, int frameNumber, const QSize &requestedSize);
+    static QImage makeThumbnail(Mlt::Producer *producer, int frameNumber);
 };
@@ -39,6 +39,7 @@
 #include "timeline2/view/dialogs/speeddialog.h"
 #include "timeline2/view/dialogs/trackdialog.h"
 #include "timeline2/view/previewmanager.h"
+#include "timeline2/view/qmltypes/thumbnailprefetcher.h"
 #include "timeline2/view/timelinewidget.h"
 #include "transitions/transitionsrepository.hpp"
 
@@ -68,6 +69,7 @@ TimelineController::TimelineController(QObject *parent)
     , m_snapStackIndex(-1)
     , m_effectZone({0, 0})
     , m_autotrackHeight(KdenliveSettings::autotrackheight())
+    , m_thumbPrefetcher(new ThumbnailPrefetcher())
 {
     m_disablePreview = pCore->currentDoc()->getAction(QStringLiteral("disable_preview"));
     connect(m_disablePreview, &QAction::triggered, this, &TimelineController::disablePreview);
@@ -95,6 +97,7 @@ void TimelineController::prepareClose()
     disconnect(m_model.get(), &TimelineModel::selectedMixChanged, this, &TimelineController::selectedMixChanged);
     m_ready = false;
     m_root = nullptr;
+    m_thumbPrefetcher->cancel();
     //  Delete timeline preview before resetting model so that removing clips from timeline doesn't invalidate
     m_model->resetPreviewManager();
     m_model.reset();
@@ -334,6 +337,95 @@ int TimelineController::fullDuration() const
     return m_duration + TimelineModel::seekDuration;
 }
 
+void TimelineController::prefetchThumbnails(int startFrame, int endFrame, int direction)
+{
+    if (!m_model || endFrame <= startFrame) {
+        return;
+    }
+    // Prefetch one screen ahead in the scroll direction, or half a screen on each side when still
+    const int span = endFrame - startFrame;
+    std::vector<std::pair<int, int>> ranges;
+    if (direction >= 0) {
+        ranges.emplace_back(endFrame, endFrame + (direction > 0 ? span : span / 2));
+    }
+    if (direction <= 0) {
+        ranges.emplace_back(qMax(0, startFrame - (direction < 0 ? span : span / 2)), startFrame);
+    }
+    const double dar = pCore->getCurrentDar();
+    // Sorted by distance to the visible area
+    std::vector<std::pair<int, std::pair<QString, QList<int>>>> requests;
+    for (int tid : m_model->getAllTracksIds()) {
+        auto track = m_model->getTrackById_const(tid);
+        const int format = track->getProperty(QStringLiteral("kdenlive:thumbs_format")).toInt();
+        if (track->isAudioTrack() || format == 3) {
+            continue;
+        }
+        // Mirrors the thumbnail layout of ClipThumbs.qml, where thumbnails fill the clip height inside a 2 pixels border
+        const int height = m_model->data(m_model->makeTrackIndexFromID(tid), TimelineModel::HeightRole).toInt();
+        const int thumbWidth = int((height - 4) * dar);
+        if (thumbWidth <= 0) {
+            continue;
+        }
+        for (const auto &range : ranges) {
+            for (int cid : m_model->getItemsInRange(tid, range.first, range.second, false)) {
+                if (!m_model->isClip(cid)) {
+                    continue;
+                }
+                std::shared_ptr<ClipModel> clip = m_model->getClipPtr(cid);
+                const ClipType::ProducerType type = clip->clipType();
+                if (type == ClipType::Color || type == ClipType::Audio || clip->isAudioOnly()) {
+                    continue;
+                }
+                const int position = clip->getPosition();
+                const int distance = range.first >= endFrame ? qMax(0, position - endFrame) : qMax(0, startFrame - (position + clip->getPlaytime()));
+                QList<int> frames;
+                if (type == ClipType::Image || type == ClipType::Text || type == ClipType::TextTemplate) {
+                    frames << 0;
+                } else {
+                    const double speed = clip->getSpeed();
+                    auto boundFrame = [&clip, speed](int frame) {
+                        return speed >= 0 ? qRound(frame * speed) : qRound((clip->getMaxDuration() - frame) * -speed - 1);
+                    };
+                    int count = 1;
+                    if (format == 0) {
+                        count = clip->getPlaytime() * m_scale > thumbWidth ? 2 : 1;
+                    } else if (format == 1) {
+                        count = qCeil((clip->getPlaytime() * m_scale - 4) / thumbWidth);
+                    }
+                    if (count < 3) {
+                        frames << boundFrame(clip->getIn());
+                        if (count == 2) {
+                            frames << boundFrame(clip->getOut());
+                        }
+                    } else {
+                        // Only the thumbnails inside the prefetch range
+                        for (int i = 0; i < count; ++i) {
+                            const double x = position + i * thumbWidth / m_scale;
+                            if (x + thumbWidth / m_scale < range.first || x > range.second) {
+                                continue;
+                            }
+                            frames << qFloor(clip->getIn() * speed + qRound(i * thumbWidth / m_scale) * speed);
+                        }
+                    }
+                }
+                if (!frames.isEmpty()) {
+                    requests.push_back({distance, {clip->binId(), frames}});
+                }
+            }
+        }
+    }
+    std::stable_sort(requests.begin(), requests.end(),
+                     [](const std::pair<int, std::pair<QString, QList<int>>> &a, const std::pair<int, std::pair<QString, QList<int>>> &b) {
+                         return a.first < b.first;
+                     });
+    std::vector<std::pair<QString, QList<int>>> ordered;
+    ordered.reserve(requests.size());
+    for (auto &request : requests) {
+        ordered.push_back(std::move(request.second));
+    }
+    m_thumbPrefetcher->prefetch(ordered);
+}
+
 void TimelineController::checkDuration()
 {
     int currentLength = m_model->duration();
@@ -5114,6 +5206,8 @@ void TimelineController::exportSubtitle()
         srcFile.remove();
     }
     if (url.endsWith(".ass")) {
+        // Write the edits still waiting for the work file update
+        m_model->getSubtitleModel()->flushWorkFile();
         QFile src(currentSub);
         if (!src.copy(srcFile.fileName())) {
             KMessageBox::error(qApp->activeWindow(), i18n("Cannot write to file %1", srcFile.fileName()));
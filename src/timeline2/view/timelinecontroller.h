@@ -16,6 +16,7 @@
 
 class QAction;
 class QQuickItem;
+class ThumbnailPrefetcher;
 
 // see https://bugreports.qt.io/browse/QTBUG-57714, don't expose a QWidget as a context property
 class TimelineController : public QObject
@@ -169,6 +170,12 @@ public:
      */
     Q_INVOKABLE int duration() const;
     Q_INVOKABLE int fullDuration() const;
+    /** @brief Generate in the background the clip thumbnails that will be shown next
+     *  @param startFrame first visible frame
+     *  @param endFrame last visible frame
+     *  @param direction scroll direction: 1 to the right, -1 to the left, 0 when the view is still
+     */
+    Q_INVOKABLE void prefetchThumbnails(int startFrame, int endFrame, int direction);
     /** @brief Returns the current cursor position (frame currently displayed by MLT)
      */
     /** @brief Returns the seek request position (-1 = no seek pending)
@@ -786,6 +793,7 @@ private:
     int m_trimmingMainClip;
     /** @brief The position of the active subtitle in the menu list*/
     int m_activeSubPosition{-1};
+    std::unique_ptr<ThumbnailPrefetcher> m_thumbPrefetcher;
 
     int getMenuOrTimelinePos() const;
     /** @brief Prepare the preview manager */
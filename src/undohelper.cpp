@@ -10,12 +10,92 @@
 #include <QDebug>
 #include <QTime>
 #include <utility>
+
+OperationLog::OperationLog(Mode mode)
+    : m_mode(mode)
+{
+}
+
+OperationLog::Mode OperationLog::mode() const
+{
+    return m_mode;
+}
+
+void OperationLog::append(Fun operation)
+{
+    m_operations.push_back(std::move(operation));
+}
+
+size_t OperationLog::size() const
+{
+    return m_operations.size();
+}
+
+void OperationLog::squeeze()
+{
+    m_operations.shrink_to_fit();
+}
+
+bool OperationLog::operator()() const
+{
+    bool result = true;
+    switch (m_mode) {
+    case Forward:
+        for (const Fun &operation : m_operations) {
+            result = operation() && result;
+        }
+        break;
+    case Backward:
+        for (auto it = m_operations.crbegin(); it != m_operations.crend(); ++it) {
+            result = (*it)() && result;
+        }
+        break;
+    case ForwardUntilFailure:
+        for (const Fun &operation : m_operations) {
+            if (!operation()) {
+                return false;
+            }
+        }
+        break;
+    case BackwardUntilFailure:
+        for (auto it = m_operations.crbegin(); it != m_operations.crend(); ++it) {
+            if (!(*it)()) {
+                return false;
+            }
+        }
+        break;
+    }
+    return result;
+}
+
+void appendOperation(Fun &lambda, Fun operation, OperationLog::Mode mode)
+{
+    auto *log = lambda.target<OperationLog>();
+    if (log == nullptr || log->mode() != mode) {
+        // Start a new log, the current function becomes its first operation
+        OperationLog newLog(mode);
+        if (lambda) {
+            newLog.append(std::move(lambda));
+        }
+        lambda = std::move(newLog);
+        log = lambda.target<OperationLog>();
+    }
+    log->append(std::move(operation));
+}
+
 FunctionalUndoCommand::FunctionalUndoCommand(Fun undo, Fun redo, const QString &text, QUndoCommand *parent)
     : QUndoCommand(parent)
     , m_undo(std::move(undo))
     , m_redo(std::move(redo))
     , m_undone(false)
 {
+    // The functions are not extended anymore, don't keep spare capacity in the undo stack
+    if (auto *log = m_undo.target<OperationLog>()) {
+        log->squeeze();
+    }
+    if (auto *log = m_redo.target<OperationLog>()) {
+        log->squeeze();
+    }
     setText(QStringLiteral("%1 %2").arg(QTime::currentTime().toString("hh:mm")).arg(text));
 }
 
@@ -6,24 +6,58 @@
 #pragma once
 
 #include <functional>
+#include <vector>
 
 using Fun = std::function<bool(void)>;
 
-/** @brief this macro executes an operation after a given lambda
+/** @class OperationLog
+    @brief A flat list of operations, executed in sequence when called.
+
+    Undo and redo functions are built by appending one operation at a time. Wrapping the
+    previous function in a new lambda for each operation creates a chain of closures as
+    deep as the number of operations (a group move of thousands of clips), which is slow to
+    build, recursive to execute and heavy to keep in the undo stack.
+    Instead, the first append turns the function into an OperationLog, stored inside the
+    Fun, and further appends are added to its vector in place. See appendOperation().
+    The log is copied with the Fun holding it, so it keeps value semantics.
  */
-#define PUSH_LAMBDA(operation, lambda)                                                                                                                         \
-    lambda = [lambda, operation]() {                                                                                                                           \
-        bool v = lambda();                                                                                                                                     \
-        return v && operation();                                                                                                                               \
+class OperationLog
+{
+public:
+    enum Mode {
+        /** Run all operations in order, fail if one of them failed (redo) */
+        Forward,
+        /** Run all operations from the last one, fail if one of them failed (undo) */
+        Backward,
+        /** Run operations in order, stop on the first failure */
+        ForwardUntilFailure,
+        /** Run operations from the last one, stop on the first failure */
+        BackwardUntilFailure
     };
+    explicit OperationLog(Mode mode);
+    Mode mode() const;
+    void append(Fun operation);
+    /** @brief Number of operations */
+    size_t size() const;
+    /** @brief Release the memory reserved for further appends */
+    void squeeze();
+    bool operator()() const;
+
+private:
+    std::vector<Fun> m_operations;
+    Mode m_mode;
+};
+
+/** @brief Add @p operation to @p lambda, turning it into an OperationLog with the given mode if needed */
+void appendOperation(Fun &lambda, Fun operation, OperationLog::Mode mode);
+
+/** @brief this macro executes an operation after a given lambda
+ */
+#define PUSH_LAMBDA(operation, lambda) appendOperation(lambda, operation, OperationLog::ForwardUntilFailure);
 
 /** @brief this macro executes an operation before a given lambda
  */
-#define PUSH_FRONT_LAMBDA(operation, lambda)                                                                                                                   \
-    lambda = [lambda, operation]() {                                                                                                                           \
-        bool v = operation();                                                                                                                                  \
-        return v && lambda();                                                                                                                                  \
-    };
+#define PUSH_FRONT_LAMBDA(operation, lambda) appendOperation(lambda, operation, OperationLog::BackwardUntilFailure);
 
 #include <QUndoCommand>
 
@@ -0,0 +1,525 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "cachemanager.hpp"
+#include "kdenlive_debug.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+std::unique_ptr<CacheManager> CacheManager::instance;
+std::once_flag CacheManager::m_onceFlag;
+
+namespace {
+constexpr char INDEX_MAGIC[8] = {'K', 'D', 'E', 'N', 'C', 'I', 'D', 'X'};
+const QString INDEX_FILE = QStringLiteral(".cacheindex");
+// Folders of the cache root that are not written by Kdenlive
+const QStringList FOREIGN_FOLDERS = {QStringLiteral("knewstuff"), QStringLiteral("attica")};
+constexpr qint64 SECONDS_PER_DAY = 86400;
+// Minimum delay between two evictions triggered by cache writes
+constexpr qint64 EVICTION_INTERVAL = 600;
+} // namespace
+
+CacheManager::CacheManager(const QDir &root)
+    : m_root(root)
+    , m_indexPath(root.absoluteFilePath(INDEX_FILE))
+    , m_sessionStart(QDateTime::currentSecsSinceEpoch())
+{
+    m_root.makeAbsolute();
+}
+
+CacheManager::~CacheManager()
+{
+    if (!m_closed) {
+        close();
+    }
+}
+
+std::unique_ptr<CacheManager> &CacheManager::get()
+{
+    std::call_once(m_onceFlag, [] { instance.reset(new CacheManager(QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)))); });
+    return instance;
+}
+
+void CacheManager::shutdown()
+{
+    // Keep the instance, tasks and thumbnail archives may still report cache changes until they are deleted
+    if (instance) {
+        instance->close();
+    }
+}
+
+void CacheManager::close()
+{
+    QFuture<void> indexLoad;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        indexLoad = m_indexLoad;
+    }
+    indexLoad.waitForFinished();
+    waitForEviction();
+    saveIndex();
+}
+
+const QDir &CacheManager::root() const
+{
+    return m_root;
+}
+
+void CacheManager::setBudget(qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_budget = std::max<qint64>(0, bytes);
+}
+
+qint64 CacheManager::budget() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_budget;
+}
+
+qint64 CacheManager::totalSize()
+{
+    waitForIndex();
+    QMutexLocker locker(&m_mutex);
+    return m_total;
+}
+
+QFuture<void> CacheManager::scheduleIndexLoad()
+{
+    QMutexLocker locker(&m_mutex);
+    return startIndexLoad();
+}
+
+QFuture<void> CacheManager::startIndexLoad()
+{
+    if (!m_indexLoaded && !m_indexLoadStarted) {
+        m_indexLoadStarted = true;
+        m_indexLoad = QtConcurrent::run([this]() { loadIndex(); });
+    }
+    return m_indexLoad;
+}
+
+void CacheManager::waitForIndex()
+{
+    QFuture<void> indexLoad;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_indexLoaded) {
+            return;
+        }
+        indexLoad = startIndexLoad();
+    }
+    indexLoad.waitForFinished();
+}
+
+QString CacheManager::relativePath(const QString &path) const
+{
+    const QString relative = m_root.relativeFilePath(path);
+    if (relative.isEmpty() || relative == QLatin1String(".") || relative.startsWith(QLatin1String("..")) || QDir::isAbsolutePath(relative) ||
+        relative == INDEX_FILE) {
+        return QString();
+    }
+    const QString topFolder = relative.section(QLatin1Char('/'), 0, 0);
+    if (FOREIGN_FOLDERS.contains(topFolder)) {
+        return QString();
+    }
+    return relative;
+}
+
+void CacheManager::recordWrite(const QString &path)
+{
+    if (m_closed) {
+        return;
+    }
+    const QString relative = relativePath(path);
+    if (relative.isEmpty()) {
+        return;
+    }
+    const qint64 size = QFileInfo(path).size();
+    QMutexLocker locker(&m_mutex);
+    if (!m_indexLoaded) {
+        m_pendingChanges.append({PendingChange::Write, relative, size, QDateTime::currentSecsSinceEpoch()});
+        startIndexLoad();
+        return;
+    }
+    applyWrite(relative, size, QDateTime::currentSecsSinceEpoch());
+    const bool overBudget = needsEviction();
+    locker.unlock();
+    if (overBudget) {
+        scheduleEviction();
+    }
+}
+
+void CacheManager::applyWrite(const QString &relativePath, qint64 size, qint64 time)
+{
+    auto it = m_entries.find(relativePath);
+    if (it != m_entries.end()) {
+        m_total -= it->size;
+        it->size = size;
+        it->lastUse = time;
+    } else {
+        m_entries.insert(relativePath, {size, time});
+    }
+    m_total += size;
+    m_dirty = true;
+}
+
+bool CacheManager::needsEviction() const
+{
+    return m_budget > 0 && m_total > m_budget && QDateTime::currentSecsSinceEpoch() - m_lastEviction > EVICTION_INTERVAL;
+}
+
+void CacheManager::recordAccess(const QString &path)
+{
+    if (m_closed) {
+        return;
+    }
+    const QString relative = relativePath(path);
+    if (relative.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    if (!m_indexLoaded) {
+        m_pendingChanges.append({PendingChange::Access, relative, 0, QDateTime::currentSecsSinceEpoch()});
+        startIndexLoad();
+        return;
+    }
+    if (!applyAccess(relative, QDateTime::currentSecsSinceEpoch())) {
+        locker.unlock();
+        // Not indexed yet, for example restored by the user
+        recordWrite(path);
+    }
+}
+
+bool CacheManager::applyAccess(const QString &relativePath, qint64 time)
+{
+    auto it = m_entries.find(relativePath);
+    if (it == m_entries.end()) {
+        return false;
+    }
+    it->lastUse = time;
+    m_dirty = true;
+    return true;
+}
+
+void CacheManager::recordRemoval(const QString &path)
+{
+    if (m_closed) {
+        return;
+    }
+    const QString relative = relativePath(path);
+    if (relative.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    if (!m_indexLoaded) {
+        m_pendingChanges.append({PendingChange::Removal, relative, 0, QDateTime::currentSecsSinceEpoch()});
+        startIndexLoad();
+        return;
+    }
+    applyRemoval(relative);
+}
+
+void CacheManager::applyRemoval(const QString &relativePath)
+{
+    const QString folderPrefix = relativePath + QLatin1Char('/');
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it.key() == relativePath || it.key().startsWith(folderPrefix)) {
+            m_total -= it->size;
+            it = m_entries.erase(it);
+            m_dirty = true;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void CacheManager::setProtected(const QStringList &prefixes)
+{
+    QStringList relativePrefixes;
+    for (const QString &prefix : prefixes) {
+        const QString relative = m_root.relativeFilePath(prefix);
+        if (relative.startsWith(QLatin1String("..")) || QDir::isAbsolutePath(relative)) {
+            continue;
+        }
+        // Keep the trailing separator of folders so that "abc/" does not match "abcd/"
+        relativePrefixes << (prefix.endsWith(QLatin1Char('/')) ? relative + QLatin1Char('/') : relative);
+    }
+    QMutexLocker locker(&m_mutex);
+    m_protected = relativePrefixes;
+    if (m_indexLoaded) {
+        touchProtected();
+    }
+}
+
+void CacheManager::touchProtected()
+{
+    if (m_protected.isEmpty()) {
+        return;
+    }
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        for (const QString &prefix : std::as_const(m_protected)) {
+            if (it.key().startsWith(prefix)) {
+                it->lastUse = now;
+                m_dirty = true;
+                break;
+            }
+        }
+    }
+}
+
+bool CacheManager::isEvictable(const QString &relativePath, const Entry &entry) const
+{
+    if (entry.lastUse >= m_sessionStart) {
+        return false;
+    }
+    for (const QString &prefix : m_protected) {
+        if (relativePath.startsWith(prefix)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CacheManager::loadIndex()
+{
+    QHash<QString, Entry> entries;
+    const bool scanned = !readIndex(entries);
+    if (scanned) {
+        entries.clear();
+        scanFolder(entries);
+    }
+    bool overBudget = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_entries = entries;
+        m_total = 0;
+        for (const Entry &entry : std::as_const(m_entries)) {
+            m_total += entry.size;
+        }
+        m_dirty = scanned;
+        m_indexLoaded = true;
+        // Apply the changes reported while loading, in order
+        for (const PendingChange &change : std::as_const(m_pendingChanges)) {
+            switch (change.type) {
+            case PendingChange::Write:
+                applyWrite(change.relativePath, change.size, change.time);
+                break;
+            case PendingChange::Access:
+                if (!applyAccess(change.relativePath, change.time)) {
+                    const QFileInfo info(m_root.absoluteFilePath(change.relativePath));
+                    if (info.exists()) {
+                        applyWrite(change.relativePath, info.size(), change.time);
+                    }
+                }
+                break;
+            case PendingChange::Removal:
+                applyRemoval(change.relativePath);
+                break;
+            }
+        }
+        m_pendingChanges.clear();
+        touchProtected();
+        overBudget = !m_closed && needsEviction();
+    }
+    if (overBudget) {
+        scheduleEviction();
+    }
+}
+
+bool CacheManager::readIndex(QHash<QString, Entry> &entries) const
+{
+    QFile file(m_indexPath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    char magic[sizeof(INDEX_MAGIC)];
+    quint32 version = 0;
+    if (in.readRawData(magic, sizeof(magic)) != int(sizeof(magic)) || memcmp(magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        return false;
+    }
+    in >> version;
+    if (version != INDEX_VERSION) {
+        return false;
+    }
+    qint32 count = 0;
+    in >> count;
+    entries.reserve(std::max(0, count));
+    for (qint32 i = 0; i < count; ++i) {
+        QString relative;
+        Entry entry;
+        in >> relative >> entry.size >> entry.lastUse;
+        if (in.status() != QDataStream::Ok) {
+            qWarning() << "Corrupted cache index" << m_indexPath;
+            return false;
+        }
+        entries.insert(relative, entry);
+    }
+    return true;
+}
+
+bool CacheManager::saveIndex()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_indexLoaded || !m_dirty) {
+        return true;
+    }
+    if (!m_root.exists()) {
+        return false;
+    }
+    QSaveFile file(m_indexPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write cache index" << m_indexPath;
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out.writeRawData(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    out << INDEX_VERSION << qint32(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        out << it.key() << it->size << it->lastUse;
+    }
+    if (!file.commit()) {
+        return false;
+    }
+    m_dirty = false;
+    return true;
+}
+
+void CacheManager::scanFolder(QHash<QString, Entry> &entries) const
+{
+    QDirIterator it(m_root.absolutePath(), QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QString relative = relativePath(it.filePath());
+        if (relative.isEmpty()) {
+            continue;
+        }
+        const QFileInfo info = it.fileInfo();
+        // Use the modification date for files we never saw
+        entries.insert(relative, {info.size(), info.lastModified().toSecsSinceEpoch()});
+    }
+}
+
+void CacheManager::rescan()
+{
+    // Keep the last use dates of the saved index
+    waitForIndex();
+    QHash<QString, Entry> scanned;
+    scanFolder(scanned);
+    QMutexLocker locker(&m_mutex);
+    m_total = 0;
+    for (auto it = scanned.begin(); it != scanned.end(); ++it) {
+        auto known = m_entries.constFind(it.key());
+        if (known != m_entries.constEnd()) {
+            it->lastUse = std::max(it->lastUse, known->lastUse);
+        }
+        m_total += it->size;
+    }
+    m_entries = scanned;
+    m_indexLoaded = true;
+    m_dirty = true;
+    touchProtected();
+}
+
+qint64 CacheManager::evict()
+{
+    std::vector<std::pair<QString, Entry>> candidates;
+    qint64 excess = 0;
+    waitForIndex();
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_budget <= 0 || m_total <= m_budget) {
+            return 0;
+        }
+        excess = m_total - m_budget;
+        for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+            if (isEvictable(it.key(), it.value())) {
+                candidates.emplace_back(it.key(), it.value());
+            }
+        }
+    }
+    // Oldest day first, then the largest files to delete as few files as possible
+    std::sort(candidates.begin(), candidates.end(), [](const std::pair<QString, Entry> &a, const std::pair<QString, Entry> &b) {
+        const qint64 dayA = a.second.lastUse / SECONDS_PER_DAY;
+        const qint64 dayB = b.second.lastUse / SECONDS_PER_DAY;
+        if (dayA != dayB) {
+            return dayA < dayB;
+        }
+        return a.second.size > b.second.size;
+    });
+    qint64 freed = 0;
+    for (const auto &candidate : candidates) {
+        if (freed >= excess) {
+            break;
+        }
+        QMutexLocker locker(&m_mutex);
+        auto it = m_entries.find(candidate.first);
+        if (it == m_entries.end() || !isEvictable(it.key(), it.value())) {
+            // Used or removed since we listed the candidates
+            continue;
+        }
+        const QString path = m_root.absoluteFilePath(candidate.first);
+        if (!QFile::remove(path) && QFile::exists(path)) {
+            qWarning() << "Cannot delete cached file" << path;
+            continue;
+        }
+        freed += it->size;
+        m_total -= it->size;
+        m_entries.erase(it);
+        m_dirty = true;
+        // Drop the folder if it is now empty, rmdir fails otherwise
+        const QString folder = QFileInfo(path).absolutePath();
+        if (folder != m_root.absolutePath()) {
+            m_root.rmdir(folder);
+        }
+    }
+    if (freed > 0) {
+        qCDebug(KDENLIVE_LOG) << "Cache eviction freed" << freed << "bytes";
+    }
+    saveIndex();
+    return freed;
+}
+
+QFuture<void> CacheManager::scheduleEviction(bool rescanFirst)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_closed || m_eviction.isRunning()) {
+        return m_eviction;
+    }
+    m_lastEviction = QDateTime::currentSecsSinceEpoch();
+    m_eviction = QtConcurrent::run([this, rescanFirst]() {
+        if (rescanFirst) {
+            rescan();
+        }
+        evict();
+    });
+    return m_eviction;
+}
+
+void CacheManager::waitForEviction()
+{
+    QFuture<void> eviction;
+    {
+        QMutexLocker locker(&m_mutex);
+        eviction = m_eviction;
+    }
+    eviction.waitForFinished();
+}
@@ -0,0 +1,152 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QDateTime>
+#include <QDir>
+#include <QFuture>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+/** @class CacheManager
+    @brief Keeps track of the size and last use of the files in the Kdenlive cache folder.
+
+    Proxies, timeline previews, thumbnail archives and audio levels all live below the
+    cache root. The manager holds an index of these files (relative path, size and last
+    use) that is saved in the cache root, so that checking the cache size does not walk
+    the whole folder. The index is updated by the tasks writing or reading cache files,
+    a full scan is only needed when the index is missing or was outdated by an external
+    cleanup. The index is loaded (or the folder scanned) in a worker thread, changes
+    reported before it is ready are queued and applied once it is loaded.
+
+    When a budget is set, evict() deletes the least recently used files until the cache
+    fits in it, larger files first among the ones used on the same day. Files used during
+    the current session and the protected paths of the open project are never deleted.
+    All methods are thread safe.
+ */
+class CacheManager
+{
+public:
+    static constexpr quint32 INDEX_VERSION = 1;
+
+    /** @param root the cache folder to manage */
+    explicit CacheManager(const QDir &root);
+    ~CacheManager();
+
+    /** @brief Manager of the system cache folder (QStandardPaths::CacheLocation) */
+    static std::unique_ptr<CacheManager> &get();
+    /** @brief Close the manager of the system cache folder, called on exit */
+    static void shutdown();
+    /** @brief Wait for the running eviction and save the index. Changes reported afterwards are ignored */
+    void close();
+
+    const QDir &root() const;
+
+    /** @brief Maximum size of the cache in bytes, 0 disables eviction */
+    void setBudget(qint64 bytes);
+    qint64 budget() const;
+    /** @brief Size of the indexed files in bytes, waits for the index to be loaded */
+    qint64 totalSize();
+    /** @brief Load the index in a worker thread, scanning the folder if it is missing or corrupted.
+        Does nothing if the index is already loaded or loading
+        @return the running load
+    */
+    QFuture<void> scheduleIndexLoad();
+
+    /** @brief A cache file was created or replaced. Paths outside of the cache root are ignored.
+        Schedules an eviction if the cache exceeds its budget */
+    void recordWrite(const QString &path);
+    /** @brief A cache file was used, making it recently used */
+    void recordAccess(const QString &path);
+    /** @brief A cache file or folder was deleted */
+    void recordRemoval(const QString &path);
+
+    /** @brief Set the files used by the open project, that are never evicted.
+        @param prefixes absolute paths, every file whose path starts with one of them is protected
+    */
+    void setProtected(const QStringList &prefixes);
+
+    /** @brief Walk the cache folder to rebuild the index, keeping the known last use dates */
+    void rescan();
+    /** @brief Delete the least recently used files until the cache fits in the budget
+        @return the number of bytes freed
+    */
+    qint64 evict();
+    /** @brief Run evict() in a worker thread, does nothing if an eviction is already running
+        @param rescanFirst rebuild the index before, to account for files changed outside of Kdenlive
+        @return the running eviction
+    */
+    QFuture<void> scheduleEviction(bool rescanFirst = false);
+    /** @brief Wait for a scheduled eviction to finish */
+    void waitForEviction();
+
+    /** @brief Write the index to the cache root */
+    bool saveIndex();
+
+private:
+    struct Entry
+    {
+        qint64 size;
+        // Seconds since epoch
+        qint64 lastUse;
+    };
+    static std::unique_ptr<CacheManager> instance;
+    static std::once_flag m_onceFlag;
+
+    /** @brief A change reported before the index was loaded */
+    struct PendingChange
+    {
+        enum Type { Write, Access, Removal };
+        Type type;
+        QString relativePath;
+        qint64 size;
+        qint64 time;
+    };
+    /** @brief Start loading the index if needed. Called with m_mutex locked */
+    QFuture<void> startIndexLoad();
+    /** @brief Block until the index is loaded, must not be called with m_mutex locked */
+    void waitForIndex();
+    /** @brief Read the index file or scan the folder, then apply the queued changes. Runs in a worker thread */
+    void loadIndex();
+    bool readIndex(QHash<QString, Entry> &entries) const;
+    /** @brief The following functions update the loaded index. Called with m_mutex locked */
+    void applyWrite(const QString &relativePath, qint64 size, qint64 time);
+    /** @return false if the file is not indexed */
+    bool applyAccess(const QString &relativePath, qint64 time);
+    void applyRemoval(const QString &relativePath);
+    /** @return true if the cache exceeds the budget and no eviction ran recently */
+    bool needsEviction() const;
+    /** @brief Path relative to the root, empty if the file is not managed */
+    QString relativePath(const QString &path) const;
+    /** @brief Called with m_mutex locked */
+    bool isEvictable(const QString &relativePath, const Entry &entry) const;
+    /** @brief Mark the protected files as used now. Called with m_mutex locked */
+    void touchProtected();
+    void scanFolder(QHash<QString, Entry> &entries) const;
+
+    QDir m_root;
+    QString m_indexPath;
+    mutable QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    qint64 m_total{0};
+    qint64 m_budget{0};
+    qint64 m_sessionStart;
+    qint64 m_lastEviction{0};
+    QStringList m_protected;
+    QVector<PendingChange> m_pendingChanges;
+    QFuture<void> m_indexLoad;
+    bool m_indexLoadStarted{false};
+    bool m_indexLoaded{false};
+    bool m_dirty{false};
+    std::atomic<bool> m_closed{false};
+    QFuture<void> m_eviction;
+};
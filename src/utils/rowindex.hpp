@@ -0,0 +1,58 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+/** @class RowIndex
+    @brief Sorted list of item ids, giving the row of an item in O(log n).
+
+    The timeline models use the order of the ids in a std::map as row order, and
+    computing a row with std::distance walks the map. This index mirrors the map keys
+    in a sorted vector: it must be updated when items are added to or removed from the map.
+    Updates only move a block of integers, new items usually having the highest id.
+ */
+class RowIndex
+{
+public:
+    void insert(int id)
+    {
+        auto it = std::lower_bound(m_ids.begin(), m_ids.end(), id);
+        if (it == m_ids.end() || *it != id) {
+            m_ids.insert(it, id);
+        }
+    }
+    void remove(int id)
+    {
+        auto it = std::lower_bound(m_ids.begin(), m_ids.end(), id);
+        if (it != m_ids.end() && *it == id) {
+            m_ids.erase(it);
+        }
+    }
+    void clear() { m_ids.clear(); }
+    /** @brief Row of an item, or -1 if it is not in the index */
+    int row(int id) const
+    {
+        auto it = std::lower_bound(m_ids.cbegin(), m_ids.cend(), id);
+        if (it == m_ids.cend() || *it != id) {
+            return -1;
+        }
+        return int(it - m_ids.cbegin());
+    }
+    /** @brief Id of the item at @p row, or -1 if out of bounds */
+    int at(int row) const
+    {
+        if (row < 0 || row >= size()) {
+            return -1;
+        }
+        return m_ids[size_t(row)];
+    }
+    int size() const { return int(m_ids.size()); }
+
+private:
+    std::vector<int> m_ids;
+};
@@ -0,0 +1,392 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#include "thumbnailarchive.hpp"
+#include "cachemanager.hpp"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QFile>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+constexpr char ARCHIVE_MAGIC[8] = {'K', 'D', 'E', 'N', 'T', 'H', 'M', 'B'};
+// Magic, version and a reserved field
+constexpr qint64 HEADER_SIZE = 16;
+// Position and data size of a record, little endian
+constexpr qint64 RECORD_HEADER_SIZE = 8;
+// Don't bother compacting small archives
+constexpr qint64 COMPACT_THRESHOLD = 1024 * 1024;
+
+QByteArray archiveHeader()
+{
+    QByteArray header(HEADER_SIZE, '\0');
+    memcpy(header.data(), ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    qToLittleEndian<quint32>(ThumbnailArchive::VERSION, header.data() + sizeof(ARCHIVE_MAGIC));
+    return header;
+}
+
+void appendRecord(QByteArray &buffer, int pos, const QByteArray &data)
+{
+    char recordHeader[RECORD_HEADER_SIZE];
+    qToLittleEndian<qint32>(pos, recordHeader);
+    qToLittleEndian<quint32>(quint32(data.size()), recordHeader + 4);
+    buffer.append(recordHeader, RECORD_HEADER_SIZE);
+    buffer.append(data);
+}
+} // namespace
+
+ThumbnailArchive::ThumbnailArchive(const QDir &folder, const QString &hash)
+    : m_folder(folder)
+    , m_hash(hash)
+    , m_path(folder.absoluteFilePath(hash + QStringLiteral(".thumbs")))
+{
+}
+
+ThumbnailArchive::~ThumbnailArchive()
+{
+    waitForImport();
+}
+
+const QString &ThumbnailArchive::path() const
+{
+    return m_path;
+}
+
+void ThumbnailArchive::ensureIndex() const
+{
+    if (m_indexLoaded) {
+        return;
+    }
+    m_index.clear();
+    m_end = 0;
+    m_deadBytes = 0;
+    QFile file(m_path);
+    if (file.open(QIODevice::ReadOnly)) {
+        const QByteArray header = file.read(HEADER_SIZE);
+        if (header != archiveHeader()) {
+            qWarning() << "Discarding thumbnail archive with unknown format" << m_path;
+            file.close();
+            file.remove();
+        } else {
+            const qint64 size = file.size();
+            qint64 offset = HEADER_SIZE;
+            while (offset + RECORD_HEADER_SIZE <= size) {
+                char recordHeader[RECORD_HEADER_SIZE];
+                if (!file.seek(offset) || file.read(recordHeader, RECORD_HEADER_SIZE) != RECORD_HEADER_SIZE) {
+                    break;
+                }
+                const int pos = qFromLittleEndian<qint32>(recordHeader);
+                const quint32 dataSize = qFromLittleEndian<quint32>(recordHeader + 4);
+                if (offset + RECORD_HEADER_SIZE + dataSize > size) {
+                    // Interrupted write, the record will be overwritten by the next append
+                    break;
+                }
+                auto previous = m_index.constFind(pos);
+                if (previous != m_index.constEnd()) {
+                    m_deadBytes += RECORD_HEADER_SIZE + previous->size;
+                }
+                m_index.insert(pos, {offset + RECORD_HEADER_SIZE, dataSize});
+                offset += RECORD_HEADER_SIZE + dataSize;
+            }
+            m_end = offset;
+            CacheManager::get()->recordAccess(m_path);
+        }
+    }
+    m_indexLoaded = true;
+    if (!m_legacyScheduled) {
+        // Thumbnails stored as individual files by previous versions, listing and reading them can be slow
+        m_legacyScheduled = true;
+        m_legacyPending = true;
+        m_legacyImport = QtConcurrent::run([this]() { importLegacy(); });
+    }
+}
+
+void ThumbnailArchive::importLegacy() const
+{
+    const QString prefix = m_hash + QLatin1Char('#');
+    const QStringList legacyFiles = m_folder.entryList({prefix + QStringLiteral("*.jpg")}, QDir::Files);
+    QMap<int, QByteArray> images;
+    for (const QString &fileName : legacyFiles) {
+        bool ok = false;
+        const int pos = fileName.mid(prefix.size(), fileName.size() - prefix.size() - 4).toInt(&ok);
+        if (!ok) {
+            continue;
+        }
+        QFile legacy(m_folder.absoluteFilePath(fileName));
+        if (legacy.open(QIODevice::ReadOnly)) {
+            images.insert(pos, legacy.readAll());
+        }
+    }
+    QMutexLocker locker(&m_mutex);
+    if (!m_legacyPending) {
+        // The archive was cleared meanwhile
+        return;
+    }
+    if (legacyFiles.isEmpty()) {
+        m_legacyPending = false;
+        return;
+    }
+    ensureIndex();
+    // Thumbnails stored since the index was loaded are more recent
+    for (auto it = images.begin(); it != images.end();) {
+        if (m_index.contains(it.key())) {
+            it = images.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (!writeRecords(images)) {
+        // Keep reading the legacy files until they are imported
+        return;
+    }
+    m_legacyPending = false;
+    for (const QString &fileName : legacyFiles) {
+        m_folder.remove(fileName);
+    }
+}
+
+QString ThumbnailArchive::legacyPath(int pos) const
+{
+    return m_folder.absoluteFilePath(m_hash + QLatin1Char('#') + QString::number(pos) + QStringLiteral(".jpg"));
+}
+
+void ThumbnailArchive::waitForImport() const
+{
+    QFuture<void> import;
+    {
+        QMutexLocker locker(&m_mutex);
+        import = m_legacyImport;
+    }
+    import.waitForFinished();
+}
+
+bool ThumbnailArchive::writeRecords(const QMap<int, QByteArray> &images) const
+{
+    if (images.isEmpty()) {
+        return true;
+    }
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Cannot write thumbnail archive" << m_path;
+        return false;
+    }
+    if (file.size() < m_end) {
+        // The archive was deleted behind our back (cache cleanup)
+        m_index.clear();
+        m_end = 0;
+        m_deadBytes = 0;
+    }
+    if (m_end == 0) {
+        file.resize(0);
+        if (file.write(archiveHeader()) != HEADER_SIZE) {
+            return false;
+        }
+        m_end = HEADER_SIZE;
+    } else if (file.size() != m_end) {
+        // Drop an incomplete trailing record
+        file.resize(m_end);
+    }
+
+    QByteArray buffer;
+    for (auto it = images.constBegin(); it != images.constEnd(); ++it) {
+        buffer.reserve(buffer.size() + RECORD_HEADER_SIZE + it.value().size());
+        appendRecord(buffer, it.key(), it.value());
+    }
+    if (!file.seek(m_end) || file.write(buffer) != buffer.size()) {
+        qWarning() << "Error writing thumbnail archive" << m_path;
+        file.resize(m_end);
+        return false;
+    }
+    file.close();
+
+    qint64 offset = m_end;
+    for (auto it = images.constBegin(); it != images.constEnd(); ++it) {
+        auto previous = m_index.constFind(it.key());
+        if (previous != m_index.constEnd()) {
+            m_deadBytes += RECORD_HEADER_SIZE + previous->size;
+        }
+        m_index.insert(it.key(), {offset + RECORD_HEADER_SIZE, quint32(it.value().size())});
+        offset += RECORD_HEADER_SIZE + it.value().size();
+    }
+    m_end = offset;
+    if (m_deadBytes > COMPACT_THRESHOLD && m_deadBytes > m_end - m_deadBytes) {
+        compact();
+    }
+    CacheManager::get()->recordWrite(m_path);
+    return true;
+}
+
+bool ThumbnailArchive::compact() const
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QList<int> positions = m_index.keys();
+    std::sort(positions.begin(), positions.end());
+    QByteArray buffer = archiveHeader();
+    buffer.reserve(int(m_end - m_deadBytes));
+    QHash<int, Entry> index;
+    for (int pos : std::as_const(positions)) {
+        const Entry entry = m_index.value(pos);
+        if (!file.seek(entry.offset)) {
+            return false;
+        }
+        const QByteArray data = file.read(entry.size);
+        if (data.size() != qsizetype(entry.size)) {
+            return false;
+        }
+        index.insert(pos, {buffer.size() + RECORD_HEADER_SIZE, entry.size});
+        appendRecord(buffer, pos, data);
+    }
+    file.close();
+    // Readers open the archive for each access, so replacing the file is safe
+    QSaveFile output(m_path);
+    if (!output.open(QIODevice::WriteOnly) || output.write(buffer) != buffer.size() || !output.commit()) {
+        qWarning() << "Cannot compact thumbnail archive" << m_path;
+        return false;
+    }
+    m_index = index;
+    m_end = buffer.size();
+    m_deadBytes = 0;
+    return true;
+}
+
+bool ThumbnailArchive::contains(int pos) const
+{
+    QMutexLocker locker(&m_mutex);
+    ensureIndex();
+    return m_index.contains(pos) || (m_legacyPending && QFile::exists(legacyPath(pos)));
+}
+
+QList<int> ThumbnailArchive::positions() const
+{
+    QMutexLocker locker(&m_mutex);
+    ensureIndex();
+    QList<int> result = m_index.keys();
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+bool ThumbnailArchive::append(int pos, const QImage &img)
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!img.save(&buffer, "JPG")) {
+        qWarning() << "Cannot encode thumbnail for" << m_path;
+        return false;
+    }
+    return appendEncoded({{pos, data}});
+}
+
+bool ThumbnailArchive::appendEncoded(const QMap<int, QByteArray> &images)
+{
+    QMutexLocker locker(&m_mutex);
+    ensureIndex();
+    return writeRecords(images);
+}
+
+QImage ThumbnailArchive::read(int pos) const
+{
+    const QMap<int, QImage> result = read(QList<int>{pos});
+    return result.value(pos);
+}
+
+QMap<int, QImage> ThumbnailArchive::read(const QList<int> &positions) const
+{
+    QMap<int, QByteArray> encoded;
+    QMutexLocker locker(&m_mutex);
+    ensureIndex();
+    std::vector<std::pair<int, Entry>> entries;
+    entries.reserve(size_t(positions.size()));
+    QList<int> legacyPositions;
+    for (int pos : positions) {
+        auto it = m_index.constFind(pos);
+        if (it != m_index.constEnd()) {
+            entries.emplace_back(pos, it.value());
+        } else if (m_legacyPending) {
+            legacyPositions << pos;
+        }
+    }
+    if (entries.empty() && legacyPositions.isEmpty()) {
+        return {};
+    }
+    // Read in file order to keep disk access sequential
+    std::sort(entries.begin(), entries.end(), [](const std::pair<int, Entry> &a, const std::pair<int, Entry> &b) { return a.second.offset < b.second.offset; });
+    QFile file(m_path);
+    if (!entries.empty() && !file.open(QIODevice::ReadOnly)) {
+        // Removed by a cache cleanup, reload on next access
+        m_indexLoaded = false;
+        entries.clear();
+    }
+    for (const auto &entry : entries) {
+        if (!file.seek(entry.second.offset)) {
+            break;
+        }
+        const QByteArray data = file.read(entry.second.size);
+        if (data.size() != qsizetype(entry.second.size)) {
+            m_indexLoaded = false;
+            break;
+        }
+        encoded.insert(entry.first, data);
+    }
+    file.close();
+    locker.unlock();
+
+    // Not imported yet, read them from their own file
+    for (int pos : std::as_const(legacyPositions)) {
+        QFile legacy(legacyPath(pos));
+        if (legacy.open(QIODevice::ReadOnly)) {
+            encoded.insert(pos, legacy.readAll());
+        }
+    }
+
+    // Decode without blocking other users of the archive
+    QMap<int, QImage> result;
+    for (auto it = encoded.constBegin(); it != encoded.constEnd(); ++it) {
+        QImage img = QImage::fromData(it.value(), "JPG");
+        if (!img.isNull()) {
+            result.insert(it.key(), img);
+        }
+    }
+    return result;
+}
+
+void ThumbnailArchive::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_legacyScheduled || m_legacyPending) {
+        // Legacy files were not imported yet
+        const QStringList legacyFiles = m_folder.entryList({m_hash + QStringLiteral("#*.jpg")}, QDir::Files);
+        for (const QString &fileName : legacyFiles) {
+            m_folder.remove(fileName);
+        }
+        m_legacyScheduled = true;
+        m_legacyPending = false;
+    }
+    QFile::remove(m_path);
+    CacheManager::get()->recordRemoval(m_path);
+    m_index.clear();
+    m_end = 0;
+    m_deadBytes = 0;
+    m_indexLoaded = true;
+}
+
+void ThumbnailArchive::invalidate()
+{
+    QMutexLocker locker(&m_mutex);
+    m_index.clear();
+    m_end = 0;
+    m_deadBytes = 0;
+    m_indexLoaded = false;
+}
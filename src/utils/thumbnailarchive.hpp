@@ -0,0 +1,102 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QDir>
+#include <QFuture>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+
+/** @class ThumbnailArchive
+    @brief Packed persistent storage for the video thumbnails of one clip.
+
+    All the thumbnails of a clip hash are appended as JPEG records to a single
+    "<hash>.thumbs" file in the thumbnail cache folder, instead of one file per frame.
+    The file starts with a small versioned header, each record is made of the frame
+    position, the size of the encoded image and the image data. The index (position to
+    offset) is rebuilt by walking the record headers the first time the archive is used.
+    Storing a position again appends a new record that supersedes the previous one, the
+    file is compacted when superseded records take more space than the live ones.
+
+    Thumbnails from the former layout ("<hash>#<pos>.jpg" files) are imported into the
+    archive and deleted by a background task, started when the index is first loaded.
+    Until the import is finished, they are read from their own files.
+    All methods are thread safe.
+ */
+class ThumbnailArchive
+{
+public:
+    static constexpr quint32 VERSION = 1;
+
+    /** @param folder the thumbnail cache folder
+        @param hash the clip hash used to name the archive, as returned by ProjectClip::hashForThumbs()
+    */
+    ThumbnailArchive(const QDir &folder, const QString &hash);
+    ~ThumbnailArchive();
+
+    /** @brief Path of the archive file */
+    const QString &path() const;
+
+    /** @brief Check whether a thumbnail is stored for a given position */
+    bool contains(int pos) const;
+    /** @brief All stored positions, sorted. Legacy thumbnails are listed once imported */
+    QList<int> positions() const;
+    /** @brief Wait for the import of the legacy thumbnails to finish */
+    void waitForImport() const;
+
+    /** @brief Encode and append a thumbnail, replacing a previous one at the same position */
+    bool append(int pos, const QImage &img);
+    /** @brief Append already encoded thumbnails in one write */
+    bool appendEncoded(const QMap<int, QByteArray> &images);
+
+    /** @brief Decode the thumbnail stored at @p pos, or return a null image */
+    QImage read(int pos) const;
+    /** @brief Decode several thumbnails with a single open of the archive, reading in file order.
+        Missing positions are not part of the result. */
+    QMap<int, QImage> read(const QList<int> &positions) const;
+
+    /** @brief Delete the whole archive */
+    void clear();
+    /** @brief Forget the index, it is loaded again from the file on next access */
+    void invalidate();
+
+protected:
+    struct Entry
+    {
+        qint64 offset; // offset of the image data
+        quint32 size;
+    };
+    /** @brief Load the index if needed, and start the import of legacy files. Called with m_mutex locked */
+    void ensureIndex() const;
+    /** @brief Import the legacy files in the archive, run in a worker thread */
+    void importLegacy() const;
+    /** @brief Path of the thumbnail at @p pos in the legacy layout */
+    QString legacyPath(int pos) const;
+    /** @brief Write records at the end of the archive. Called with m_mutex locked */
+    bool writeRecords(const QMap<int, QByteArray> &images) const;
+    /** @brief Rewrite the archive without superseded records. Called with m_mutex locked */
+    bool compact() const;
+
+    QDir m_folder;
+    QString m_hash;
+    QString m_path;
+    mutable QMutex m_mutex;
+    mutable bool m_indexLoaded{false};
+    mutable QHash<int, Entry> m_index;
+    // End of the last valid record, where new records are written
+    mutable qint64 m_end{0};
+    // Bytes used by superseded records
+    mutable qint64 m_deadBytes{0};
+    mutable QFuture<void> m_legacyImport;
+    mutable bool m_legacyScheduled{false};
+    // Legacy files may exist that are not imported yet
+    mutable bool m_legacyPending{false};
+};
@@ -9,13 +9,21 @@
 #include "core.h"
 #include "doc/kdenlivedoc.h"
 #include "project/projectmanager.h"
+#include "thumbnailarchive.hpp"
+#include <QBuffer>
 #include <QDir>
 #include <QMutexLocker>
 #include <list>
+#include <unordered_set>
 
 std::unique_ptr<ThumbnailCache> ThumbnailCache::instance;
 std::once_flag ThumbnailCache::m_onceFlag;
 
+namespace {
+// Memory used by the volatile thumbnails, in bytes
+constexpr int VOLATILE_BUDGET = 10000000;
+} // namespace
+
 class ThumbnailCache::Cache_t
 {
 public:
@@ -39,10 +47,13 @@ public:
         m_data.erase(it);
     }
 
-    void insert(const QString &key, const QImage &img, int cost)
+    int maxCost() const { return m_maxCost; }
+
+    /** @brief Returns false if the image is larger than the cache */
+    bool insert(const QString &key, const QImage &img, int cost)
     {
         if (cost > m_maxCost) {
-            return;
+            return false;
         }
         m_data.push_front({key, {img, cost}});
         auto it = m_data.begin();
@@ -51,6 +62,7 @@ public:
         while (m_currentCost > m_maxCost) {
             remove(m_data.back().first);
         }
+        return true;
     }
 
     QImage get(const QString &key)
@@ -100,50 +112,127 @@ protected:
     std::unordered_map<QString, decltype(m_data.begin())> m_cache;
 };
 
+class ThumbnailCache::Shard
+{
+public:
+    explicit Shard(int maxCost)
+        : cache(maxCost)
+    {
+    }
+    QMutex mutex;
+    Cache_t cache;
+    // Positions of each clip stored in this shard.
+    // Note that we don't track deletions due to items dropped from the cache. So the maps can contain more items that are currently stored.
+    std::unordered_map<QString, std::vector<int>> storedVolatile;
+    // Keys of this shard whose thumbnail was too large and went to the overflow shard, only these are looked up there
+    std::unordered_set<QString> oversized;
+};
+
 ThumbnailCache::ThumbnailCache()
-    : m_volatileCache(new Cache_t(10000000))
 {
+    // Half of the memory budget is split evenly between the shards, keys are spread uniformly over them.
+    // Large thumbnails (for example of the Clip Monitor) don't fit in a shard, they use the other half
+    m_shards.reserve(SHARDS + 1);
+    for (int i = 0; i < SHARDS; ++i) {
+        m_shards.emplace_back(new Shard(VOLATILE_BUDGET / 2 / SHARDS));
+    }
+    m_shards.emplace_back(new Shard(VOLATILE_BUDGET / 2));
 }
 
+ThumbnailCache::~ThumbnailCache() = default;
+
 std::unique_ptr<ThumbnailCache> &ThumbnailCache::get()
 {
     std::call_once(m_onceFlag, [] { instance.reset(new ThumbnailCache()); });
     return instance;
 }
 
+ThumbnailCache::Shard &ThumbnailCache::shard(const QString &key) const
+{
+    return *m_shards[qHash(key) % SHARDS];
+}
+
+ThumbnailCache::Shard &ThumbnailCache::overflow() const
+{
+    return *m_shards[SHARDS];
+}
+
+bool ThumbnailCache::volatileContains(const QString &key) const
+{
+    Shard &s = shard(key);
+    QMutexLocker locker(&s.mutex);
+    if (s.cache.contains(key)) {
+        return true;
+    }
+    if (s.oversized.count(key) == 0) {
+        return false;
+    }
+    locker.unlock();
+    Shard &o = overflow();
+    QMutexLocker overflowLocker(&o.mutex);
+    return o.cache.contains(key);
+}
+
+QImage ThumbnailCache::volatileGet(const QString &key) const
+{
+    Shard &s = shard(key);
+    QMutexLocker locker(&s.mutex);
+    if (s.cache.contains(key)) {
+        return s.cache.get(key);
+    }
+    if (s.oversized.count(key) == 0) {
+        return QImage();
+    }
+    locker.unlock();
+    Shard &o = overflow();
+    QMutexLocker overflowLocker(&o.mutex);
+    return o.cache.get(key);
+}
+
 bool ThumbnailCache::hasThumbnail(const QString &binId, int pos, bool volatileOnly) const
 {
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
-    auto key = pos < 0 ? getAudioKey(binId, &ok).constFirst() : getKey(binId, pos, &ok);
-    if (ok && m_volatileCache->contains(key)) {
+    if (pos < 0) {
+        auto key = getAudioKey(binId, &ok).constFirst();
+        if (!ok) {
+            return false;
+        }
+        if (volatileContains(key)) {
+            return true;
+        }
+        if (volatileOnly) {
+            return false;
+        }
+        QDir thumbFolder = getDir(true, &ok);
+        return ok && thumbFolder.exists(key);
+    }
+    const QString hash = getClipHash(binId, &ok);
+    if (!ok) {
+        return false;
+    }
+    if (volatileContains(thumbKey(hash, pos))) {
         return true;
     }
-    if (!ok || volatileOnly) {
+    if (volatileOnly) {
         return false;
     }
-    locker.unlock();
-    QDir thumbFolder = getDir(pos < 0, &ok);
-    return ok && thumbFolder.exists(key);
+    auto archive = getArchive(binId, hash, &ok);
+    return ok && archive->contains(pos);
 }
 
 QImage ThumbnailCache::getAudioThumbnail(const QString &binId, bool volatileOnly) const
 {
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
     auto key = getAudioKey(binId, &ok).constFirst();
-    if (ok && m_volatileCache->contains(key)) {
-        return m_volatileCache->get(key);
-    }
-    if (!ok || volatileOnly) {
+    if (!ok) {
         return QImage();
     }
+    const QImage img = volatileGet(key);
+    if (!img.isNull() || volatileOnly) {
+        return img;
+    }
     QDir thumbFolder = getDir(true, &ok);
     if (ok && thumbFolder.exists(key)) {
-        if (std::find(m_storedOnDisk[binId].begin(), m_storedOnDisk[binId].end(), -1) != m_storedOnDisk[binId].end()) {
-            m_storedOnDisk[binId].push_back(-1);
-        }
-        locker.unlock();
         return QImage(thumbFolder.absoluteFilePath(key));
     }
     return QImage();
@@ -170,49 +259,110 @@ QImage ThumbnailCache::getThumbnail(QString hash, const QString &binId, int pos,
     if (hash.isEmpty()) {
         return QImage();
     }
-    hash.append(QStringLiteral("#%1.jpg").arg(pos));
-    QMutexLocker locker(&m_mutex);
-    if (m_volatileCache->contains(hash)) {
-        return m_volatileCache->get(hash);
+    const QImage img = volatileGet(thumbKey(hash, pos));
+    if (!img.isNull() || volatileOnly) {
+        return img;
     }
-    if (volatileOnly) {
+    bool ok = false;
+    auto archive = getArchive(binId, hash, &ok);
+    return ok ? archive->read(pos) : QImage();
+}
+
+QImage ThumbnailCache::getThumbnail(const QString &binId, int pos, bool volatileOnly) const
+{
+    bool ok = false;
+    const QString hash = getClipHash(binId, &ok);
+    if (!ok) {
         return QImage();
     }
+    return getThumbnail(hash, binId, pos, volatileOnly);
+}
+
+QMap<int, QImage> ThumbnailCache::getThumbnails(const QString &binId, const QList<int> &positions) const
+{
+    QMap<int, QImage> result;
     bool ok = false;
-    QDir thumbFolder = getDir(false, &ok);
-    if (ok && thumbFolder.exists(hash)) {
-        if (m_storedOnDisk.find(binId) == m_storedOnDisk.end() ||
-            std::find(m_storedOnDisk[binId].begin(), m_storedOnDisk[binId].end(), pos) == m_storedOnDisk[binId].end()) {
-            m_storedOnDisk[binId].push_back(pos);
+    const QString hash = getClipHash(binId, &ok);
+    if (!ok) {
+        return result;
+    }
+    QList<int> missing;
+    for (int pos : positions) {
+        const QImage img = volatileGet(thumbKey(hash, pos));
+        if (!img.isNull()) {
+            result.insert(pos, img);
+        } else {
+            missing << pos;
         }
-        locker.unlock();
-        return QImage(thumbFolder.absoluteFilePath(hash));
     }
-    locker.unlock();
-    return QImage();
+    if (missing.isEmpty()) {
+        return result;
+    }
+    auto archive = getArchive(binId, hash, &ok);
+    if (ok) {
+        result.insert(archive->read(missing));
+    }
+    return result;
 }
 
-QImage ThumbnailCache::getThumbnail(const QString &binId, int pos, bool volatileOnly) const
+QList<int> ThumbnailCache::loadThumbnails(const QString &binId, const QList<int> &positions)
 {
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
-    auto key = getKey(binId, pos, &ok);
-    if (ok && m_volatileCache->contains(key)) {
-        return m_volatileCache->get(key);
+    const QString hash = getClipHash(binId, &ok);
+    if (!ok) {
+        return {};
     }
-    if (!ok || volatileOnly) {
-        return QImage();
+    QList<int> missing;
+    for (int pos : positions) {
+        if (!volatileContains(thumbKey(hash, pos))) {
+            missing << pos;
+        }
     }
-    QDir thumbFolder = getDir(false, &ok);
-    if (ok && thumbFolder.exists(key)) {
-        if (m_storedOnDisk.find(binId) == m_storedOnDisk.end() ||
-            std::find(m_storedOnDisk[binId].begin(), m_storedOnDisk[binId].end(), pos) == m_storedOnDisk[binId].end()) {
-            m_storedOnDisk[binId].push_back(pos);
+    if (missing.isEmpty()) {
+        return missing;
+    }
+    auto archive = getArchive(binId, hash, &ok);
+    if (!ok) {
+        return missing;
+    }
+    const QMap<int, QImage> stored = archive->read(missing);
+    for (auto it = stored.constBegin(); it != stored.constEnd(); ++it) {
+        insertVolatile(binId, hash, it.key(), it.value());
+        missing.removeOne(it.key());
+    }
+    return missing;
+}
+
+void ThumbnailCache::insertVolatile(const QString &binId, const QString &hash, int pos, const QImage &img)
+{
+    const QString key = thumbKey(hash, pos);
+    const int cost = int(img.sizeInBytes());
+    Shard &keyShard = shard(key);
+    const bool large = cost > keyShard.cache.maxCost();
+    Shard &s = large ? overflow() : keyShard;
+    {
+        QMutexLocker locker(&keyShard.mutex);
+        if (large) {
+            keyShard.oversized.insert(key);
+            // The previous image of this thumbnail may have had another size, drop it from the key shard
+            keyShard.cache.remove(key);
+        } else if (keyShard.oversized.erase(key) > 0) {
+            locker.unlock();
+            QMutexLocker overflowLocker(&overflow().mutex);
+            overflow().cache.remove(key);
         }
-        locker.unlock();
-        return QImage(thumbFolder.absoluteFilePath(key));
     }
-    return QImage();
+    QMutexLocker locker(&s.mutex);
+    // if volatile cache also contains this entry, update it
+    bool known = false;
+    if (s.cache.contains(key)) {
+        s.cache.remove(key);
+        known = true;
+    }
+    // Only record the thumbnails that were stored, so that invalidation finds them in this shard
+    if (s.cache.insert(key, img, cost) && !known) {
+        s.storedVolatile[binId].push_back(pos);
+    }
 }
 
 void ThumbnailCache::storeThumbnail(const QString &binId, int pos, const QImage &img, bool persistent)
@@ -220,120 +370,159 @@ void ThumbnailCache::storeThumbnail(const QString &binId, int pos, const QImage
     if (pCore->projectItemModel()->closing) {
         return;
     }
-    QMutexLocker locker(&m_mutex);
     bool ok = false;
-    const QString key = getKey(binId, pos, &ok);
+    const QString hash = getClipHash(binId, &ok);
     if (!ok) {
         return;
     }
-    // if volatile cache also contains this entry, update it
-    if (m_volatileCache->contains(key)) {
-        m_volatileCache->remove(key);
-    } else {
-        m_storedVolatile[binId].push_back(pos);
-    }
-    m_volatileCache->insert(key, img, (int)img.sizeInBytes());
+    insertVolatile(binId, hash, pos, img);
     if (persistent) {
-        QDir thumbFolder = getDir(false, &ok);
-        if (ok) {
-            if (m_storedOnDisk.find(binId) == m_storedOnDisk.end() ||
-                std::find(m_storedOnDisk[binId].begin(), m_storedOnDisk[binId].end(), pos) == m_storedOnDisk[binId].end()) {
-                m_storedOnDisk[binId].push_back(pos);
-            }
-            locker.unlock();
-            if (!img.save(thumbFolder.absoluteFilePath(key))) {
-                qDebug() << ".............\n!!!!!!!! ERROR SAVING THUMB in: " << thumbFolder.absoluteFilePath(key);
-            }
+        auto archive = getArchive(binId, hash, &ok);
+        if (ok && !archive->append(pos, img)) {
+            qDebug() << ".............\n!!!!!!!! ERROR SAVING THUMB in: " << archive->path();
         }
     }
 }
 
 bool ThumbnailCache::checkIntegrity() const
 {
-    return m_volatileCache->checkIntegrity();
+    for (const auto &s : m_shards) {
+        QMutexLocker locker(&s->mutex);
+        if (!s->cache.checkIntegrity()) {
+            return false;
+        }
+    }
+    return true;
 }
 
 void ThumbnailCache::saveCachedThumbs(const std::unordered_map<QString, std::vector<int>> &keys)
 {
-    bool ok;
-    QDir thumbFolder = getDir(false, &ok);
-    if (!ok) {
-        return;
-    }
-    QMutexLocker locker(&m_mutex);
     for (auto &key : keys) {
         bool ok;
+        const QString hash = getClipHash(key.first, &ok);
+        if (!ok) {
+            continue;
+        }
+        auto archive = getArchive(key.first, hash, &ok);
+        if (!ok) {
+            return;
+        }
+        // Encode the thumbs missing on disk and write them in one batch per clip
+        QMap<int, QByteArray> encoded;
         for (const auto &pos : key.second) {
-            if (m_storedOnDisk.find(key.first) == m_storedOnDisk.end() ||
-                std::find(m_storedOnDisk[key.first].begin(), m_storedOnDisk[key.first].end(), pos) == m_storedOnDisk[key.first].end()) {
-                const QString thumbKey = getKey(key.first, pos, &ok);
-                if (!ok) {
-                    continue;
-                }
-                if (!thumbFolder.exists(thumbKey) && m_volatileCache->contains(thumbKey)) {
-                    QImage img = m_volatileCache->get(thumbKey);
-                    if (!img.save(thumbFolder.absoluteFilePath(thumbKey))) {
-                        qDebug() << "// Error writing thumbnails to " << thumbFolder.absolutePath();
-                        break;
-                    } else {
-                        m_storedOnDisk[key.first].push_back(pos);
-                    }
-                }
+            if (archive->contains(pos)) {
+                continue;
+            }
+            const QImage img = volatileGet(thumbKey(hash, pos));
+            if (img.isNull()) {
+                continue;
             }
+            QByteArray data;
+            QBuffer buffer(&data);
+            buffer.open(QIODevice::WriteOnly);
+            if (img.save(&buffer, "JPG")) {
+                encoded.insert(pos, data);
+            }
+        }
+        if (!archive->appendEncoded(encoded)) {
+            qDebug() << "// Error writing thumbnails to " << archive->path();
+            break;
         }
     }
 }
 
 void ThumbnailCache::invalidateThumbsForClip(const QString &binId)
 {
-    QMutexLocker locker(&m_mutex);
-    if (m_storedVolatile.find(binId) != m_storedVolatile.end()) {
-        bool ok = false;
-        for (int pos : m_storedVolatile.at(binId)) {
-            auto key = getKey(binId, pos, &ok);
-            if (ok) {
-                m_volatileCache->remove(key);
-            }
-        }
-        m_storedVolatile.erase(binId);
-    }
     bool ok = false;
-    // Video thumbs
-    QStringList files;
-    if (m_storedOnDisk.find(binId) != m_storedOnDisk.end()) {
-        // Remove persistent cache
-        for (const auto &pos : m_storedOnDisk.at(binId)) {
-            if (pos >= 0) {
-                auto key = getKey(binId, pos, &ok);
-                if (ok) {
-                    files << key;
-                }
-            }
+    const QString hash = getClipHash(binId, &ok);
+    // Volatile thumbs of a clip are spread over all shards
+    for (const auto &s : m_shards) {
+        QMutexLocker locker(&s->mutex);
+        auto stored = s->storedVolatile.find(binId);
+        if (stored == s->storedVolatile.end()) {
+            continue;
         }
-        m_storedOnDisk.erase(binId);
-    }
-    // Release mutex before deleting files
-    locker.unlock();
-    if (!files.isEmpty()) {
-        QDir thumbFolder = getDir(false, &ok);
         if (ok) {
-            while (!files.isEmpty()) {
-                thumbFolder.remove(files.takeFirst());
+            for (int pos : stored->second) {
+                s->cache.remove(thumbKey(hash, pos));
             }
         }
+        s->storedVolatile.erase(stored);
+    }
+    // Video thumbs: the whole archive of the clip is dropped at once
+    std::shared_ptr<ThumbnailArchive> archive;
+    QMutexLocker locker(&m_archiveMutex);
+    auto it = m_clipArchives.find(binId);
+    if (it != m_clipArchives.end()) {
+        archive = it->second;
+        m_clipArchives.erase(it);
+    }
+    locker.unlock();
+    if (!archive && ok) {
+        archive = getArchive(QString(), hash, &ok);
+    }
+    // Delete files without holding any lock
+    if (archive) {
+        archive->clear();
     }
 }
 
 void ThumbnailCache::clearCache()
 {
-    QMutexLocker locker(&m_mutex);
-    m_volatileCache->clear();
-    m_storedVolatile.clear();
-    m_storedOnDisk.clear();
+    for (const auto &s : m_shards) {
+        QMutexLocker locker(&s->mutex);
+        s->cache.clear();
+        s->storedVolatile.clear();
+        s->oversized.clear();
+    }
+    // Archives may still be used by running tasks, keep a single object per file
+    std::vector<std::shared_ptr<ThumbnailArchive>> archives;
+    QMutexLocker locker(&m_archiveMutex);
+    archives.reserve(m_archives.size());
+    for (const auto &archive : m_archives) {
+        archives.push_back(archive.second);
+    }
+    m_clipArchives.clear();
+    locker.unlock();
+    for (const auto &archive : archives) {
+        archive->invalidate();
+    }
+}
+
+std::shared_ptr<ThumbnailArchive> ThumbnailCache::getArchive(const QString &binId, const QString &hash, bool *ok) const
+{
+    QDir thumbFolder = getDir(false, ok);
+    if (!*ok) {
+        return nullptr;
+    }
+    const QString path = thumbFolder.absoluteFilePath(hash + QStringLiteral(".thumbs"));
+    QMutexLocker locker(&m_archiveMutex);
+    auto it = m_archives.find(path);
+    std::shared_ptr<ThumbnailArchive> archive;
+    if (it != m_archives.end()) {
+        archive = it->second;
+    } else {
+        archive = std::make_shared<ThumbnailArchive>(thumbFolder, hash);
+        m_archives[path] = archive;
+    }
+    if (!binId.isEmpty()) {
+        m_clipArchives[binId] = archive;
+    }
+    return archive;
 }
 
 // static
 QString ThumbnailCache::getKey(const QString &binId, int pos, bool *ok)
+{
+    const QString hash = getClipHash(binId, ok);
+    if (!*ok) {
+        return QString();
+    }
+    return thumbKey(hash, pos);
+}
+
+// static
+QString ThumbnailCache::getClipHash(const QString &binId, bool *ok)
 {
     if (binId.isEmpty()) {
         *ok = false;
@@ -344,7 +533,13 @@ QString ThumbnailCache::getKey(const QString &binId, int pos, bool *ok)
     if (!*ok) {
         return QString();
     }
-    return binClip->hashForThumbs() + QLatin1Char('#') + QString::number(pos) + QStringLiteral(".jpg");
+    return binClip->hashForThumbs();
+}
+
+// static
+QString ThumbnailCache::thumbKey(const QString &hash, int pos)
+{
+    return hash + QLatin1Char('#') + QString::number(pos) + QStringLiteral(".jpg");
 }
 
 // static
@@ -8,6 +8,7 @@
 #include "definitions.h"
 #include <QDir>
 #include <QImage>
+#include <QMap>
 #include <QMutex>
 #include <QUrl>
 #include <memory>
@@ -15,10 +16,15 @@
 #include <unordered_map>
 #include <vector>
 
+class ThumbnailArchive;
+
 /** @class ThumbnailCache
     @brief This class class is an interface to the caches that store thumbnails.
     In Kdenlive, we use two such caches, a persistent that is stored on disk to allow thumbnails to be reused when reopening.
-    The other one is a volatile LRU cache that lives in memory.
+    The persistent cache packs all the video thumbnails of a clip in one archive file, see ThumbnailArchive.
+    The other one is a volatile LRU cache that lives in memory. It is split in shards with their own lock, selected by the
+    thumbnail key, so that the many threads loading timeline thumbnails don't wait on each other. Thumbnails larger than a
+    shard budget are kept in an overflow shard instead, which is only locked for the keys known to be stored there.
     Note that for the volatile cache uses a custom implementation.
     QCache is not suitable since it operates on pointers and since the object is removed from the cache when accessed.
     KImageCache is not suitable since it lacks a way to remove objects from the cache.
@@ -31,6 +37,7 @@ public:
     friend class KdenliveTests;
     // Returns the instance of the Singleton
     static std::unique_ptr<ThumbnailCache> &get();
+    ~ThumbnailCache();
 
     /** @brief Check whether a given thumbnail is in the cache
        @param binId is the id of the queried clip
@@ -56,6 +63,20 @@ public:
     */
     void storeThumbnail(const QString &binId, int pos, const QImage &img, bool persistent = false);
 
+    /** @brief Get several thumbnails of a clip at once, reading the persistent cache only once
+       @param binId is the id of the queried clip
+       @param positions are the positions where we query
+       @return the found thumbnails, missing positions are not part of the result
+    */
+    QMap<int, QImage> getThumbnails(const QString &binId, const QList<int> &positions) const;
+
+    /** @brief Make sure thumbnails are in the volatile cache, decoding the ones found in the persistent cache
+       @param binId is the id of the queried clip
+       @param positions are the wanted positions
+       @return the positions that are in no cache and have to be generated
+    */
+    QList<int> loadThumbnails(const QString &binId, const QList<int> &positions);
+
     /** @brief Removes all the thumbnails for a given clip */
     void invalidateThumbsForClip(const QString &binId);
 
@@ -74,20 +95,38 @@ protected:
 
     // Return the key associated to a thumbnail
     static QString getKey(const QString &binId, int pos, bool *ok);
+    // Return the hash naming the thumbnails of a clip
+    static QString getClipHash(const QString &binId, bool *ok);
+    static QString thumbKey(const QString &hash, int pos);
     static QStringList getAudioKey(const QString &binId, bool *ok);
 
     // Return the dir where the persistent cache lives
     static const QDir getDir(bool audio, bool *ok);
 
+    // Return the persistent archive for a clip hash
+    std::shared_ptr<ThumbnailArchive> getArchive(const QString &binId, const QString &hash, bool *ok) const;
+
     static std::unique_ptr<ThumbnailCache> instance;
     static std::once_flag m_onceFlag; // flag to create the repository only once;
 
     class Cache_t;
-    std::unique_ptr<Cache_t> m_volatileCache;
-    mutable QMutex m_mutex;
-
-    // the following maps keeps track of the positions that we store for each clip in volatile caches.
-    // Note that we don't track deletions due to items dropped from the cache. So the maps can contain more items that are currently stored.
-    std::unordered_map<QString, std::vector<int>> m_storedVolatile;
-    mutable std::unordered_map<QString, std::vector<int>> m_storedOnDisk;
+    class Shard;
+    static constexpr int SHARDS = 16;
+    // The SHARDS shards selected by key, followed by the overflow shard
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    // Return the shard selected by a thumbnail key
+    Shard &shard(const QString &key) const;
+    // Return the shard holding the thumbnails too large for the other shards
+    Shard &overflow() const;
+    // Check whether a thumbnail key is in the volatile cache
+    bool volatileContains(const QString &key) const;
+    // Return a thumbnail from the volatile cache, or a null image
+    QImage volatileGet(const QString &key) const;
+    void insertVolatile(const QString &binId, const QString &hash, int pos, const QImage &img);
+
+    mutable QMutex m_archiveMutex;
+    // Persistent archives by file path, never dropped so that a file is only written through one object,
+    // and the archive last used for each clip
+    mutable std::unordered_map<QString, std::shared_ptr<ThumbnailArchive>> m_archives;
+    mutable std::unordered_map<QString, std::shared_ptr<ThumbnailArchive>> m_clipArchives;
 };
@@ -0,0 +1,67 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+
+#pragma once
+
+#include "gentime.h"
+
+#include <QtGlobal>
+#include <cmath>
+
+/**
+ * @class TickTime
+ * @brief An exact time, stored as an integer number of ticks.
+ *
+ * A tick is 1/705600000 second (a "flick"). This divides evenly the usual frame
+ * rates (24, 25, 30, 48, 50, 60, 120) and their NTSC variants (23.976, 29.97, 59.94),
+ * so every frame starts at an exact number of ticks. Unlike GenTime, comparisons are
+ * exact, which makes TickTime suitable as a sorted container key.
+ *
+ * Conversions from and to GenTime are explicit and exact: a GenTime is converted to
+ * the nearest tick of its position in seconds, without rounding to a frame, so it does
+ * not depend on the fps set with GenTime::setFps. Containers that want one entry per
+ * frame (markers, subtitles) build their keys with fromFrames() instead, and these keys
+ * depend on the fps they were computed with.
+ */
+class TickTime
+{
+public:
+    static constexpr qint64 PER_SECOND = 705600000;
+
+    constexpr TickTime() = default;
+    constexpr explicit TickTime(qint64 ticks)
+        : m_ticks(ticks)
+    {
+    }
+    /** @brief Converts a GenTime to its nearest tick, independently of any fps. */
+    explicit TickTime(const GenTime &time)
+        : m_ticks(std::llround(time.seconds() * PER_SECOND))
+    {
+    }
+    static TickTime fromFrames(int frames, double fps) { return TickTime(std::llround(frames * (PER_SECOND / fps))); }
+    static TickTime fromSeconds(double seconds) { return TickTime(std::llround(seconds * PER_SECOND)); }
+
+    explicit operator GenTime() const { return GenTime(seconds()); }
+
+    constexpr qint64 ticks() const { return m_ticks; }
+    double seconds() const { return double(m_ticks) / PER_SECOND; }
+    int frames(double fps) const { return int(std::llround(double(m_ticks) * fps / PER_SECOND)); }
+
+    TickTime operator+(TickTime op) const { return TickTime(m_ticks + op.m_ticks); }
+    TickTime operator-(TickTime op) const { return TickTime(m_ticks - op.m_ticks); }
+
+    bool operator<(TickTime op) const { return m_ticks < op.m_ticks; }
+    bool operator>(TickTime op) const { return m_ticks > op.m_ticks; }
+    bool operator<=(TickTime op) const { return m_ticks <= op.m_ticks; }
+    bool operator>=(TickTime op) const { return m_ticks >= op.m_ticks; }
+    bool operator==(TickTime op) const { return m_ticks == op.m_ticks; }
+    bool operator!=(TickTime op) const { return m_ticks != op.m_ticks; }
+
+private:
+    qint64 m_ticks{0};
+};
+
+Q_DECLARE_TYPEINFO(TickTime, Q_PRIMITIVE_TYPE);
@@ -225,9 +225,108 @@ TEST_CASE("(de)serialize audio levels")
     const auto input = QVector<int16_t>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
     auto tmp = QTemporaryFile();
     REQUIRE(tmp.open());
-    AudioLevelsTask::saveLevelsToCache(tmp.fileName(), input);
-    const auto deserialized = AudioLevelsTask::getLevelsFromCache(tmp.fileName());
-    REQUIRE(deserialized == input);
+    REQUIRE(AudioLevelsTask::saveLevelsToCache(tmp.fileName(), AudioLevelsPyramid(input, 2), QByteArrayLiteral("0123456789abcdef")));
+    bool isLegacy = true;
+    const auto deserialized = AudioLevelsTask::getLevelsFromCache(tmp.fileName(), 2, QByteArrayLiteral("0123456789abcdef"), &isLegacy);
+    REQUIRE_FALSE(isLegacy);
+    REQUIRE(deserialized.isMapped());
+    REQUIRE(deserialized.levelCount() == AudioLevelsPyramid::LEVELS);
+    REQUIRE(deserialized.level(0) == input);
+    REQUIRE(deserialized.level(1) == QVector<int16_t>{9, 10});
+
+    SECTION("Cache is rejected if it does not match the source")
+    {
+        REQUIRE(AudioLevelsPyramid::loadFromFile(tmp.fileName(), 2, QByteArrayLiteral("fedcba9876543210")).isEmpty());
+        REQUIRE(AudioLevelsPyramid::loadFromFile(tmp.fileName(), 1, QByteArrayLiteral("0123456789abcdef")).isEmpty());
+        REQUIRE_FALSE(AudioLevelsPyramid::loadFromFile(tmp.fileName(), 2, QByteArray()).isEmpty());
+    }
+
+    SECTION("A stale cache is removed instead of being read as a previous format")
+    {
+        AudioLevelsPyramid::LoadResult result = AudioLevelsPyramid::Loaded;
+        REQUIRE(AudioLevelsPyramid::loadFromFile(tmp.fileName(), 2, QByteArrayLiteral("fedcba9876543210"), &result).isEmpty());
+        REQUIRE(result == AudioLevelsPyramid::Stale);
+        isLegacy = true;
+        REQUIRE(AudioLevelsTask::getLevelsFromCache(tmp.fileName(), 2, QByteArrayLiteral("fedcba9876543210"), &isLegacy).isEmpty());
+        REQUIRE_FALSE(isLegacy);
+        REQUIRE_FALSE(QFile::exists(tmp.fileName()));
+        // The levels mapped before stay readable
+        REQUIRE(deserialized.level(0) == input);
+    }
+}
+
+TEST_CASE("load audio levels cache without pyramid")
+{
+    // Cache files written before the levels pyramid only contain the full resolution levels
+    const auto input = QVector<int16_t>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    auto tmp = QTemporaryFile();
+    REQUIRE(tmp.open());
+    {
+        QDataStream out(&tmp);
+        out << input;
+        tmp.close();
+    }
+    AudioLevelsPyramid::LoadResult result = AudioLevelsPyramid::Loaded;
+    REQUIRE(AudioLevelsPyramid::loadFromFile(tmp.fileName(), 1, QByteArray(), &result).isEmpty());
+    REQUIRE(result == AudioLevelsPyramid::OtherFormat);
+    bool isLegacy = false;
+    const auto deserialized = AudioLevelsTask::getLevelsFromCache(tmp.fileName(), 1, QByteArray(), &isLegacy);
+    REQUIRE(isLegacy);
+    REQUIRE_FALSE(deserialized.isMapped());
+    REQUIRE(deserialized.levelCount() == AudioLevelsPyramid::LEVELS);
+    REQUIRE(deserialized.level(0) == input);
+    REQUIRE(deserialized.level(1) == QVector<int16_t>{5, 10, 12});
+    REQUIRE(deserialized.level(2) == QVector<int16_t>{12});
+}
+
+TEST_CASE("load invalid audio levels cache")
+{
+    // A list size larger than the file must not be allocated
+    auto tmp = QTemporaryFile();
+    REQUIRE(tmp.open());
+    tmp.write(QByteArray::fromHex("4b44454e00000010"));
+    tmp.close();
+    bool isLegacy = true;
+    REQUIRE(AudioLevelsTask::getLevelsFromCache(tmp.fileName(), 1, QByteArray(), &isLegacy).isEmpty());
+    REQUIRE_FALSE(isLegacy);
+}
+
+TEST_CASE("audio levels pyramid")
+{
+    // 2 channels, 16 frames
+    QVector<int16_t> base;
+    for (int i = 0; i < 16 * AUDIOLEVELS_POINTS_PER_FRAME; ++i) {
+        base << int16_t(i) << int16_t(1000 - i);
+    }
+    const AudioLevelsPyramid pyramid(base, 2);
+    REQUIRE(pyramid.channels() == 2);
+    REQUIRE(pyramid.frames() == 16);
+    REQUIRE(pyramid.maxLevel() == 1000);
+
+    SECTION("Each level keeps the peaks of the previous one")
+    {
+        REQUIRE(pyramid.level(1).size() == 16 * 2);
+        REQUIRE(pyramid.level(1).at(0) == 4);
+        REQUIRE(pyramid.level(1).at(1) == 1000);
+        REQUIRE(pyramid.level(2).size() == 2 * 2);
+        REQUIRE(pyramid.level(2).at(2) == 79);
+        REQUIRE(pyramid.level(2).at(3) == 1000 - 40);
+        REQUIRE(pyramid.level(3).size() == 2);
+        REQUIRE(pyramid.level(3) == QVector<int16_t>{79, 1000});
+    }
+
+    SECTION("Level selection depends on the zoom")
+    {
+        REQUIRE(AudioLevelsPyramid::pointsPerFrame(0) == AUDIOLEVELS_POINTS_PER_FRAME);
+        REQUIRE(AudioLevelsPyramid::pointsPerFrame(3) == 1. / 64);
+        // Zoomed in, full resolution
+        REQUIRE(pyramid.levelForScale(10) == 0);
+        REQUIRE(pyramid.levelForScale(2) == 0);
+        REQUIRE(pyramid.levelForScale(1) == 1);
+        REQUIRE(pyramid.levelForScale(0.1) == 2);
+        // Zoomed out, coarsest level
+        REQUIRE(pyramid.levelForScale(0.001) == 3);
+    }
 }
 
 TEST_CASE("MLT noise generator")
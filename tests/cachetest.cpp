@@ -15,7 +15,10 @@
 
 #include "core.h"
 #include "definitions.h"
+#include "utils/cachemanager.hpp"
+#include "utils/thumbnailarchive.hpp"
 #include "utils/thumbnailcache.hpp"
+#include <QTemporaryDir>
 
 TEST_CASE("Cache insert-remove", "[Cache]")
 {
@@ -48,6 +51,49 @@ TEST_CASE("Cache insert-remove", "[Cache]")
         ThumbnailCache::get()->storeThumbnail(binId, 0, img, false);
         REQUIRE(ThumbnailCache::get()->checkIntegrity());
     }
+    SECTION("Batched lookup across shards")
+    {
+        QImage img(100, 100, QImage::Format_ARGB32_Premultiplied);
+        img.fill(Qt::red);
+        for (int pos = 0; pos < 40; pos += 2) {
+            ThumbnailCache::get()->storeThumbnail(binId, pos, img, false);
+        }
+        REQUIRE(ThumbnailCache::get()->checkIntegrity());
+        REQUIRE(ThumbnailCache::get()->hasThumbnail(binId, 10, true));
+        REQUIRE_FALSE(ThumbnailCache::get()->hasThumbnail(binId, 11, true));
+        const QMap<int, QImage> found = ThumbnailCache::get()->getThumbnails(binId, {0, 1, 20, 38});
+        REQUIRE(found.keys() == QList<int>{0, 20, 38});
+        // Positions in no cache have to be generated
+        REQUIRE(ThumbnailCache::get()->loadThumbnails(binId, {2, 3, 4, 5}) == QList<int>{3, 5});
+        ThumbnailCache::get()->invalidateThumbsForClip(binId);
+        REQUIRE(ThumbnailCache::get()->checkIntegrity());
+        REQUIRE_FALSE(ThumbnailCache::get()->hasThumbnail(binId, 10, true));
+    }
+    SECTION("Thumbnails larger than a shard")
+    {
+        // Larger than a shard, but within the cache budget
+        QImage large(800, 600, QImage::Format_ARGB32_Premultiplied);
+        large.fill(Qt::red);
+        ThumbnailCache::get()->storeThumbnail(binId, 0, large, false);
+        REQUIRE(ThumbnailCache::get()->hasThumbnail(binId, 0, true));
+        REQUIRE(ThumbnailCache::get()->getThumbnail(binId, 0, true).size() == large.size());
+        // A smaller image replaces the large one
+        QImage small(100, 100, QImage::Format_ARGB32_Premultiplied);
+        small.fill(Qt::blue);
+        ThumbnailCache::get()->storeThumbnail(binId, 0, small, false);
+        REQUIRE(ThumbnailCache::get()->getThumbnail(binId, 0, true).size() == small.size());
+        ThumbnailCache::get()->storeThumbnail(binId, 0, large, false);
+        REQUIRE(ThumbnailCache::get()->getThumbnail(binId, 0, true).size() == large.size());
+        // Larger than the overflow budget, not stored
+        QImage huge(2000, 2000, QImage::Format_ARGB32_Premultiplied);
+        huge.fill(Qt::green);
+        ThumbnailCache::get()->storeThumbnail(binId, 1, huge, false);
+        REQUIRE_FALSE(ThumbnailCache::get()->hasThumbnail(binId, 1, true));
+        REQUIRE(ThumbnailCache::get()->checkIntegrity());
+        ThumbnailCache::get()->invalidateThumbsForClip(binId);
+        REQUIRE_FALSE(ThumbnailCache::get()->hasThumbnail(binId, 0, true));
+        REQUIRE(ThumbnailCache::get()->checkIntegrity());
+    }
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
 
@@ -90,3 +136,176 @@ TEST_CASE("getAudioKey() should dereference `ok` param", "ThumbnailCache") {
     }
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
+
+TEST_CASE("Packed thumbnail archive", "[Cache]")
+{
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    QDir folder(tmp.path());
+    const QString hash = QStringLiteral("0123456789abcdef");
+    QImage red(64, 36, QImage::Format_RGB32);
+    red.fill(Qt::red);
+    QImage blue(64, 36, QImage::Format_RGB32);
+    blue.fill(Qt::blue);
+
+    SECTION("Append and read in batch")
+    {
+        ThumbnailArchive archive(folder, hash);
+        REQUIRE(archive.positions().isEmpty());
+        REQUIRE(archive.append(0, red));
+        REQUIRE(archive.append(25, blue));
+        REQUIRE(archive.append(50, red));
+        REQUIRE(archive.contains(25));
+        REQUIRE_FALSE(archive.contains(10));
+        // Only one file for all the thumbnails
+        REQUIRE(folder.entryList(QDir::Files) == QStringList{hash + QStringLiteral(".thumbs")});
+
+        // A new instance rebuilds the index from the file
+        ThumbnailArchive reopened(folder, hash);
+        REQUIRE(reopened.positions() == QList<int>{0, 25, 50});
+        const QMap<int, QImage> images = reopened.read(QList<int>{50, 10, 25});
+        REQUIRE(images.keys() == QList<int>{25, 50});
+        REQUIRE(qBlue(images.value(25).pixel(10, 10)) > 200);
+        REQUIRE(qRed(images.value(50).pixel(10, 10)) > 200);
+    }
+
+    SECTION("Replaced thumbnails supersede older ones")
+    {
+        ThumbnailArchive archive(folder, hash);
+        REQUIRE(archive.append(5, red));
+        REQUIRE(archive.append(5, blue));
+        ThumbnailArchive reopened(folder, hash);
+        REQUIRE(reopened.positions() == QList<int>{5});
+        REQUIRE(qBlue(reopened.read(5).pixel(0, 0)) > 200);
+    }
+
+    SECTION("Interrupted write is ignored")
+    {
+        ThumbnailArchive archive(folder, hash);
+        REQUIRE(archive.append(1, red));
+        QFile file(archive.path());
+        REQUIRE(file.open(QIODevice::Append));
+        file.write(QByteArray("\x02\x00\x00\x00\xff\xff\x00\x00partial", 15));
+        file.close();
+        ThumbnailArchive reopened(folder, hash);
+        REQUIRE(reopened.positions() == QList<int>{1});
+        REQUIRE(reopened.append(2, blue));
+        ThumbnailArchive again(folder, hash);
+        REQUIRE(again.positions() == QList<int>{1, 2});
+        REQUIRE(qBlue(again.read(2).pixel(0, 0)) > 200);
+    }
+
+    SECTION("Legacy files are imported")
+    {
+        REQUIRE(red.save(folder.absoluteFilePath(hash + QStringLiteral("#3.jpg"))));
+        REQUIRE(blue.save(folder.absoluteFilePath(hash + QStringLiteral("#40.jpg"))));
+        // Thumbnails of another clip are left alone
+        REQUIRE(blue.save(folder.absoluteFilePath(QStringLiteral("fedcba#3.jpg"))));
+        ThumbnailArchive archive(folder, hash);
+        // Legacy thumbnails can be read while they are imported
+        REQUIRE(archive.contains(40));
+        REQUIRE(qBlue(archive.read(40).pixel(0, 0)) > 200);
+        archive.waitForImport();
+        REQUIRE(archive.positions() == QList<int>{3, 40});
+        REQUIRE(qBlue(archive.read(40).pixel(0, 0)) > 200);
+        QStringList files = folder.entryList(QDir::Files);
+        files.sort();
+        REQUIRE(files == QStringList{hash + QStringLiteral(".thumbs"), QStringLiteral("fedcba#3.jpg")});
+    }
+
+    SECTION("Clear removes the whole clip")
+    {
+        ThumbnailArchive archive(folder, hash);
+        REQUIRE(archive.append(0, red));
+        REQUIRE(archive.append(1, red));
+        archive.clear();
+        REQUIRE_FALSE(archive.contains(0));
+        REQUIRE(archive.read(1).isNull());
+        REQUIRE_FALSE(QFile::exists(archive.path()));
+        // The archive can be filled again
+        REQUIRE(archive.append(2, blue));
+        REQUIRE(ThumbnailArchive(folder, hash).positions() == QList<int>{2});
+    }
+
+    SECTION("Invalidated archive reloads its index")
+    {
+        ThumbnailArchive archive(folder, hash);
+        REQUIRE(archive.append(0, red));
+        ThumbnailArchive other(folder, hash);
+        REQUIRE(other.append(7, blue));
+        archive.invalidate();
+        REQUIRE(archive.positions() == QList<int>{0, 7});
+        // New records are written after the reloaded ones
+        REQUIRE(archive.append(8, red));
+        REQUIRE(ThumbnailArchive(folder, hash).positions() == QList<int>{0, 7, 8});
+    }
+}
+
+TEST_CASE("Cache budget eviction", "[Cache]")
+{
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    QDir root(tmp.path());
+    const QDateTime now = QDateTime::currentDateTime();
+    auto createFile = [&root](const QString &name, int size, const QDateTime &date) { KdenliveTests::createFile(root, name, QByteArray(size, 'a'), date); };
+    createFile(QStringLiteral("1/preview/0.mp4"), 4000, now.addDays(-30));
+    createFile(QStringLiteral("2/audiothumbs/a.levels"), 3000, now.addDays(-20));
+    createFile(QStringLiteral("2/videothumbs/b.thumbs"), 1000, now.addDays(-20));
+    createFile(QStringLiteral("proxy/hash1.mkv"), 2000, now.addDays(-40));
+    // Not written by Kdenlive
+    createFile(QStringLiteral("knewstuff/data"), 5000, now.addDays(-50));
+
+    {
+        CacheManager cache(root);
+        REQUIRE(cache.totalSize() == 10000);
+        cache.setProtected({root.absoluteFilePath(QStringLiteral("proxy/hash1"))});
+        // No budget, nothing is deleted
+        REQUIRE(cache.evict() == 0);
+
+        // Oldest first, then the largest of the same day
+        cache.setBudget(5000);
+        REQUIRE(cache.evict() == 7000);
+        REQUIRE(cache.totalSize() == 3000);
+        REQUIRE_FALSE(QFile::exists(root.absoluteFilePath(QStringLiteral("1/preview/0.mp4"))));
+        REQUIRE_FALSE(root.exists(QStringLiteral("1/preview")));
+        REQUIRE_FALSE(QFile::exists(root.absoluteFilePath(QStringLiteral("2/audiothumbs/a.levels"))));
+        REQUIRE(QFile::exists(root.absoluteFilePath(QStringLiteral("2/videothumbs/b.thumbs"))));
+        REQUIRE(QFile::exists(root.absoluteFilePath(QStringLiteral("proxy/hash1.mkv"))));
+        REQUIRE(QFile::exists(root.absoluteFilePath(QStringLiteral("knewstuff/data"))));
+
+        // Writing above the budget evicts older files, never the ones used in this session
+        createFile(QStringLiteral("3/preview/1.mp4"), 6000, now);
+        cache.recordWrite(root.absoluteFilePath(QStringLiteral("3/preview/1.mp4")));
+        cache.waitForEviction();
+        REQUIRE_FALSE(QFile::exists(root.absoluteFilePath(QStringLiteral("2/videothumbs/b.thumbs"))));
+        REQUIRE(QFile::exists(root.absoluteFilePath(QStringLiteral("3/preview/1.mp4"))));
+        REQUIRE(cache.totalSize() == 8000);
+
+        // Files outside of the cache root are ignored
+        cache.recordWrite(QDir::temp().absoluteFilePath(QStringLiteral("kdenlive-not-cached")));
+        REQUIRE(cache.totalSize() == 8000);
+    }
+
+    {
+        // The index is reused instead of walking the folder
+        createFile(QStringLiteral("4/audiothumbs/c.levels"), 500, now);
+        CacheManager cache(root);
+        REQUIRE(cache.totalSize() == 8000);
+        cache.rescan();
+        REQUIRE(cache.totalSize() == 8500);
+        cache.recordRemoval(root.absoluteFilePath(QStringLiteral("3")));
+        REQUIRE(cache.totalSize() == 2500);
+    }
+
+    {
+        // Without index the folder is scanned in the background (finding the files of "3" again),
+        // changes reported meanwhile are applied after it
+        REQUIRE(QFile::remove(root.absoluteFilePath(QStringLiteral(".cacheindex"))));
+        CacheManager cache(root);
+        createFile(QStringLiteral("5/preview/2.mp4"), 700, now);
+        cache.recordWrite(root.absoluteFilePath(QStringLiteral("5/preview/2.mp4")));
+        cache.recordRemoval(root.absoluteFilePath(QStringLiteral("4")));
+        cache.scheduleIndexLoad().waitForFinished();
+        REQUIRE(cache.totalSize() == 8700);
+    }
+}
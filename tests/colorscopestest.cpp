@@ -69,3 +69,105 @@ TEST_CASE("Colorscope RGB/BGR handling")
         CHECK(rgbScope == bgrScope);
     }
 }
+
+// The scope generators split the frame in bands processed in parallel, the
+// result must not depend on the band layout nor on the input pixel format.
+TEST_CASE("Colorscope kernels on large frames")
+{
+    // Horizontal gradient with some vertical variation, so that all scopes get populated
+    QImage inputImage(3840, 2160, QImage::Format_RGB32);
+    for (int y = 0; y < inputImage.height(); ++y) {
+        auto *line = reinterpret_cast<QRgb *>(inputImage.scanLine(y));
+        for (int x = 0; x < inputImage.width(); ++x) {
+            line[x] = qRgb(x * 255 / (inputImage.width() - 1), y * 255 / (inputImage.height() - 1), (x + y) % 256);
+        }
+    }
+    const QImage rgbaImage = inputImage.convertToFormat(QImage::Format_RGBA8888);
+
+    QSize scopeSize{720, 400};
+    qreal scalingFactor = 1.0;
+    const auto ALL_COMPONENTS = HistogramGenerator::Components::ComponentY | HistogramGenerator::Components::ComponentR |
+                                HistogramGenerator::Components::ComponentG | HistogramGenerator::Components::ComponentB |
+                                HistogramGenerator::Components::ComponentSum;
+
+    SECTION("Results do not depend on the pixel format")
+    {
+        WaveformGenerator waveform{};
+        CHECK(waveform.calculateWaveform(scopeSize, scalingFactor, inputImage, WaveformGenerator::PaintMode::PaintMode_Green, true, ITURec::Rec_709, 1) ==
+              waveform.calculateWaveform(scopeSize, scalingFactor, rgbaImage, WaveformGenerator::PaintMode::PaintMode_Green, true, ITURec::Rec_709, 1));
+        RGBParadeGenerator rgb{};
+        CHECK(rgb.calculateRGBParade(scopeSize, scalingFactor, inputImage, RGBParadeGenerator::PaintMode::PaintMode_RGB, true, true, 1) ==
+              rgb.calculateRGBParade(scopeSize, scalingFactor, rgbaImage, RGBParadeGenerator::PaintMode::PaintMode_RGB, true, true, 1));
+        HistogramGenerator hist{};
+        CHECK(hist.calculateHistogram(scopeSize, scalingFactor, inputImage, ALL_COMPONENTS, ITURec::Rec_601, false, false, 1) ==
+              hist.calculateHistogram(scopeSize, scalingFactor, rgbaImage, ALL_COMPONENTS, ITURec::Rec_601, false, false, 1));
+        VectorscopeGenerator vectorscope{};
+        CHECK(vectorscope.calculateVectorscope(scopeSize, scalingFactor, inputImage, 1, VectorscopeGenerator::PaintMode::PaintMode_Original,
+                                               VectorscopeGenerator::ColorSpace::ColorSpace_YUV, false, 1) ==
+              vectorscope.calculateVectorscope(scopeSize, scalingFactor, rgbaImage, 1, VectorscopeGenerator::PaintMode::PaintMode_Original,
+                                               VectorscopeGenerator::ColorSpace::ColorSpace_YUV, false, 1));
+    }
+
+    SECTION("Uniform frame fills a single waveform line")
+    {
+        QImage grey(3840, 2160, QImage::Format_RGB32);
+        grey.fill(qRgb(255, 255, 255));
+        WaveformGenerator waveform{};
+        QImage scope = waveform.calculateWaveform(scopeSize, scalingFactor, grey, WaveformGenerator::PaintMode::PaintMode_White, false, ITURec::Rec_709, 1);
+        // White is drawn on the top line, everything else stays transparent
+        for (int x = 0; x < scope.width(); ++x) {
+            CHECK(qAlpha(scope.pixel(x, 0)) > 0);
+            CHECK(qAlpha(scope.pixel(x, scope.height() / 2)) == 0);
+        }
+    }
+}
+
+// Run with: colorscopestest "[benchmark]"
+TEST_CASE("Colorscope generators benchmark", "[.][benchmark]")
+{
+    QImage inputImage(3840, 2160, QImage::Format_RGB32);
+    for (int y = 0; y < inputImage.height(); ++y) {
+        auto *line = reinterpret_cast<QRgb *>(inputImage.scanLine(y));
+        for (int x = 0; x < inputImage.width(); ++x) {
+            line[x] = qRgb(x % 256, y % 256, (x * y) % 256);
+        }
+    }
+    const QImage rgbaImage = inputImage.convertToFormat(QImage::Format_RGBA8888);
+    QSize scopeSize{720, 400};
+    qreal scalingFactor = 1.0;
+    const auto ALL_COMPONENTS = HistogramGenerator::Components::ComponentY | HistogramGenerator::Components::ComponentR |
+                                HistogramGenerator::Components::ComponentG | HistogramGenerator::Components::ComponentB;
+    WaveformGenerator waveform{};
+    RGBParadeGenerator rgb{};
+    HistogramGenerator hist{};
+    VectorscopeGenerator vectorscope{};
+
+    BENCHMARK("Waveform 4K, accelFactor 1")
+    {
+        return waveform.calculateWaveform(scopeSize, scalingFactor, inputImage, WaveformGenerator::PaintMode::PaintMode_Green, true, ITURec::Rec_709, 1);
+    };
+    BENCHMARK("Waveform 4K RGBA, accelFactor 1")
+    {
+        return waveform.calculateWaveform(scopeSize, scalingFactor, rgbaImage, WaveformGenerator::PaintMode::PaintMode_Green, true, ITURec::Rec_709, 1);
+    };
+    BENCHMARK("RGB Parade 4K, accelFactor 1")
+    {
+        return rgb.calculateRGBParade(scopeSize, scalingFactor, inputImage, RGBParadeGenerator::PaintMode::PaintMode_RGB, true, true, 1);
+    };
+    BENCHMARK("Histogram 4K, accelFactor 1")
+    {
+        return hist.calculateHistogram(scopeSize, scalingFactor, inputImage, ALL_COMPONENTS, ITURec::Rec_709, false, false, 1);
+    };
+    BENCHMARK("Vectorscope 4K, accelFactor 1")
+    {
+        return vectorscope.calculateVectorscope(scopeSize, scalingFactor, inputImage, 1, VectorscopeGenerator::PaintMode::PaintMode_Green2,
+                                                VectorscopeGenerator::ColorSpace::ColorSpace_YUV, false, 1);
+    };
+    // With a large scope and few samples, the per band plots and their merge dominate the cost
+    const QImage hdImage = inputImage.scaled(1920, 1080);
+    BENCHMARK("Vectorscope HD, 1024px scope, accelFactor 4")
+    {
+        return vectorscope.calculateVectorscope(QSize(1024, 1024), scalingFactor, hdImage, 1, VectorscopeGenerator::PaintMode::PaintMode_Original,
+                                                VectorscopeGenerator::ColorSpace::ColorSpace_YUV, false, 4);
+    };
+}
@@ -6,6 +6,9 @@
 #include "test_utils.hpp"
 // test specific headers
 #include "doc/documentchecker.h"
+#include "doc/mediasearchindex.h"
+#include <QAtomicInt>
+#include <QTemporaryDir>
 
 TEST_CASE("Basic tests of the document checker parts", "[DocumentChecker]")
 {
@@ -60,3 +63,62 @@ TEST_CASE("Missing project items", "[DocumentChecker]")
         CHECK(results.value(DocumentChecker::MissingType::Proxy) == 1);
     }
 }
+
+TEST_CASE("Missing media search index", "[DocumentChecker]")
+{
+    QTemporaryDir tmp;
+    REQUIRE(tmp.isValid());
+    QDir root(tmp.path());
+    const QString first = KdenliveTests::createFile(root, QStringLiteral("a.mp4"), QByteArray(100, 'a'));
+    const QString moved = KdenliveTests::createFile(root, QStringLiteral("sub/b/clip.mp4"), QByteArray(3000, 'b'));
+    // Same name and size, different content
+    const QString other = KdenliveTests::createFile(root, QStringLiteral("other/clip.mp4"), QByteArray(3000, 'c'));
+    KdenliveTests::createFile(root, QStringLiteral("z/image_0001.png"), QByteArray(10, 'd'));
+    KdenliveTests::createFile(root, QStringLiteral("z/image_0002.png"), QByteArray(10, 'e'));
+    auto hash = [](const QString &path) { return QString::fromLatin1(ProjectClip::calculateHash(path).first.toHex()); };
+
+    QAtomicInt progressCalls;
+    QAtomicInt lastTotal;
+    auto progress = [&progressCalls, &lastTotal](int, int total) {
+        progressCalls.ref();
+        lastTotal.storeRelaxed(total);
+    };
+    MediaSearchIndex index(root, progress);
+    CHECK(index.count() == 5);
+    // One call per first level subfolder
+    CHECK(progressCalls.loadRelaxed() == 3);
+    CHECK(lastTotal.loadRelaxed() == 3);
+
+    SECTION("Resolve several files at once by size and hash")
+    {
+        progressCalls.storeRelaxed(0);
+        const QStringList found = index.findFiles({{QStringLiteral("3000"), hash(moved)},
+                                                   {QStringLiteral("100"), hash(first)},
+                                                   {QStringLiteral("3000"), QStringLiteral("0123456789abcdef0123456789abcdef")},
+                                                   {QStringLiteral("42"), hash(first)}},
+                                                  progress);
+        CHECK(found == QStringList{moved, first, QString(), QString()});
+        // Each of the 3 candidates is hashed once
+        CHECK(progressCalls.loadRelaxed() == 3);
+        CHECK(lastTotal.loadRelaxed() == 3);
+        CHECK(DocumentChecker::searchFileRecursively(index, QStringLiteral("3000"), hash(other), QStringLiteral("/old/clip.mp4")) == other);
+    }
+
+    SECTION("Search by name follows the folder order")
+    {
+        CHECK(index.findPath(QStringLiteral("CLIP.mp4")) == other);
+        CHECK(index.findPath(QStringLiteral("a.mp4")) == first);
+        CHECK(index.findPath(QStringLiteral("missing.mp4")).isEmpty());
+        CHECK(DocumentChecker::searchPathRecursively(index, QStringLiteral("clip.mp4")) == other);
+    }
+
+    SECTION("Slideshows")
+    {
+        const QString sequence = root.absoluteFilePath(QStringLiteral("z/image_%04d.png"));
+        CHECK(index.findPath(QStringLiteral("image_%04d.png"), ClipType::SlideShow) == sequence);
+        const QDir folder(root.absoluteFilePath(QStringLiteral("z")));
+        const QString folderHash = QString::fromLatin1(ProjectClip::getFolderHash(folder, QStringLiteral("image_%04d.png")).toHex());
+        CHECK(index.findFolders({{folderHash, QStringLiteral("/old/place/image_%04d.png")}}) == QStringList{sequence});
+        CHECK(index.findFolders({{hash(first), QStringLiteral("/old/place/image_%04d.png")}}) == QStringList{QString()});
+    }
+}
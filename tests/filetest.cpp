@@ -10,6 +10,7 @@
 #include "timeline2/model/builders/meltBuilder.hpp"
 #include "xml/xml.hpp"
 
+#include <QBuffer>
 #include <QTemporaryFile>
 #include <QUndoGroup>
 
@@ -472,3 +473,83 @@ TEST_CASE("Opening File With Keyframes", "[OPENKFRS]")
         pCore->projectManager()->closeCurrentDocument(false, false);
     }
 }
+
+static QString sceneWithTracks(int playlists)
+{
+    QString scene = QStringLiteral("<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<mlt LC_NUMERIC=\"C\" version=\"7.0.0\">\n");
+    for (int i = 0; i < playlists; ++i) {
+        scene.append(QStringLiteral(" <playlist id=\"playlist%1\">\n  <property name=\"kdenlive:notes\">a &amp; b</property>\n"
+                                    "  <entry producer=\"producer0\" in=\"0\" out=\"%1\">\n   <filter id=\"filter%1\">\n"
+                                    "    <property name=\"kdenlive_id\">volume</property>\n   </filter>\n  </entry>\n </playlist>\n")
+                         .arg(i));
+    }
+    scene.append(QStringLiteral(" <tractor id=\"tractor0\" global_feed=\"1\">\n  <property name=\"meta.volume\">0.5</property>\n"
+                                "  <track producer=\"playlist0\"/>\n </tractor>\n</mlt>\n"));
+    return scene;
+}
+
+TEST_CASE("Project file post-processing", "[SF]")
+{
+    SECTION("Reset main tractor volume")
+    {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        REQUIRE(KdenliveDoc::writeSceneList(sceneWithTracks(2), &buffer));
+        QDomDocument doc;
+        REQUIRE(doc.setContent(data));
+        QDomElement tractor = doc.documentElement().firstChildElement(QStringLiteral("tractor"));
+        CHECK(Xml::getXmlProperty(tractor, QStringLiteral("meta.volume")) == QLatin1String("1"));
+        CHECK(doc.documentElement().elementsByTagName(QStringLiteral("playlist")).count() == 2);
+        CHECK(doc.documentElement().elementsByTagName(QStringLiteral("filter")).count() == 2);
+        QDomElement playlist = doc.documentElement().firstChildElement(QStringLiteral("playlist"));
+        CHECK(Xml::getXmlProperty(playlist, QStringLiteral("kdenlive:notes")) == QLatin1String("a & b"));
+    }
+    SECTION("Only reset the volume of the main tractor itself")
+    {
+        QString scene = sceneWithTracks(1);
+        scene.replace(QStringLiteral("global_feed=\"1\">\n"),
+                      QStringLiteral("global_feed=\"1\">\n  <filter id=\"mix\">\n   <property name=\"meta.volume\">0.3</property>\n  </filter>\n"));
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        REQUIRE(KdenliveDoc::writeSceneList(scene, &buffer));
+        QDomDocument doc;
+        REQUIRE(doc.setContent(data));
+        QDomElement tractor = doc.documentElement().firstChildElement(QStringLiteral("tractor"));
+        CHECK(Xml::getTagContentByAttribute(tractor, QStringLiteral("property"), QStringLiteral("name"), QStringLiteral("meta.volume"), QString(), true) ==
+              QLatin1String("1"));
+        QDomElement filter = tractor.firstChildElement(QStringLiteral("filter"));
+        CHECK(Xml::getXmlProperty(filter, QStringLiteral("meta.volume")) == QLatin1String("0.3"));
+    }
+    SECTION("Reject corrupted scenes")
+    {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        CHECK_FALSE(KdenliveDoc::writeSceneList(QString(), &buffer));
+        CHECK_FALSE(KdenliveDoc::writeSceneList(QStringLiteral("<mlt><playlist id=\"p\"/></mlt>"), &buffer));
+        CHECK_FALSE(KdenliveDoc::writeSceneList(QStringLiteral("<mlt><tractor><track producer=\"p\"/></tractor>"), &buffer));
+        CHECK_FALSE(KdenliveDoc::writeSceneList(QStringLiteral("<tractor><track producer=\"p\"/></tractor>"), &buffer));
+    }
+}
+
+// Run with: filetest "[benchmark]"
+TEST_CASE("Project file post-processing benchmark", "[.][benchmark]")
+{
+    const QString scene = sceneWithTracks(20000);
+    BENCHMARK("QDomDocument round trip")
+    {
+        QDomDocument doc;
+        doc.setContent(scene);
+        return doc.toString().toUtf8().size();
+    };
+    BENCHMARK("Streaming writeSceneList")
+    {
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        KdenliveDoc::writeSceneList(scene, &buffer);
+        return data.size();
+    };
+}
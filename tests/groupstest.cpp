@@ -927,6 +927,48 @@ TEST_CASE("Integration with timeline", "[GroupsModel]")
         REQUIRE(timeline->requestClipUngroup(clips[1]));
         state1();
     }
+    SECTION("Group move within and across tracks")
+    {
+        REQUIRE(timeline->requestClipMove(clips[0], tid1, 10));
+        REQUIRE(timeline->requestClipMove(clips[2], tid1, 20 + length));
+        auto g1 = std::unordered_set<int>({clips[0], clips[2]});
+        int gid = timeline->requestClipsGroup(g1);
+        REQUIRE(gid > 0);
+        auto check_state = [&](int tid, int pos) {
+            REQUIRE(timeline->getClipTrackId(clips[0]) == tid);
+            REQUIRE(timeline->getClipTrackId(clips[2]) == tid);
+            REQUIRE(timeline->getClipPosition(clips[0]) == pos);
+            REQUIRE(timeline->getClipPosition(clips[2]) == pos + 10 + length);
+            REQUIRE(timeline->checkConsistency());
+        };
+        check_state(tid1, 10);
+
+        // Move on the same track, leaving and filling blanks between the clips
+        REQUIRE(timeline->requestGroupMove(clips[0], gid, 0, 5));
+        check_state(tid1, 15);
+        REQUIRE(timeline->requestGroupMove(clips[0], gid, 0, -15));
+        check_state(tid1, 0);
+
+        // Move to another track
+        int delta_track = timeline->getTrackPosition(tid2) - timeline->getTrackPosition(tid1);
+        REQUIRE(timeline->requestGroupMove(clips[0], gid, delta_track, 30));
+        check_state(tid2, 30);
+        REQUIRE(KdenliveTests::getTrackById_const(timeline, tid1)->getClipsCount() == 0);
+        REQUIRE(KdenliveTests::getTrackById_const(timeline, tid2)->checkConsistency());
+
+        undoStack->undo();
+        check_state(tid1, 0);
+        undoStack->undo();
+        check_state(tid1, 15);
+        undoStack->undo();
+        check_state(tid1, 10);
+        undoStack->redo();
+        check_state(tid1, 15);
+        undoStack->redo();
+        check_state(tid1, 0);
+        undoStack->redo();
+        check_state(tid2, 30);
+    }
     SECTION("Ungroup multiple groups")
     {
         REQUIRE(timeline->requestClipMove(clips[0], tid1, 10));
@@ -260,6 +260,46 @@ TEST_CASE("Keyframe model", "[KeyframeModel]")
         undoStack->undo();
         state1(6.1);
     }
+
+    SECTION("Interpolated values")
+    {
+        const double fps = pCore->getCurrentFps();
+        REQUIRE(KdenliveTests::addKeyframe(model, GenTime(50, fps), KeyframeType::Linear, 42));
+        QVector<int> frames;
+        for (int i = 0; i <= 60; ++i) {
+            frames << i;
+        }
+        auto checkRange = [&]() {
+            const QVector<QVariant> values = model->getInterpolatedValues(frames);
+            REQUIRE(values.size() == 61);
+            for (int i = 0; i <= 60; ++i) {
+                REQUIRE(values.at(i) == model->getInterpolatedValue(i));
+            }
+            return values;
+        };
+        QVector<QVariant> values = checkRange();
+        REQUIRE(values.at(50).toDouble() == 42.);
+        REQUIRE(values.at(60).toDouble() == 42.);
+
+        // The cached animation must follow the changes of the parameter
+        undoStack->undo();
+        values = checkRange();
+        REQUIRE(qFuzzyCompare(values.at(50).toDouble(), values.at(0).toDouble()));
+        undoStack->redo();
+        values = checkRange();
+        REQUIRE(values.at(50).toDouble() == 42.);
+        REQUIRE(model->getInterpolatedValues({}).isEmpty());
+        // Frames don't need to be sorted
+        values = model->getInterpolatedValues({60, 0, 50});
+        REQUIRE(values.at(0).toDouble() == 42.);
+        REQUIRE(values.at(1) == model->getInterpolatedValue(0));
+        REQUIRE(values.at(2).toDouble() == 42.);
+
+        // A value written directly to the asset, without going through the keyframe model, is not hidden by the cache
+        const QString paramName = effect->data(index, AssetParameterModel::NameRole).toString();
+        effect->setParameter(paramName, QStringLiteral("0=10;50=10"), false, index);
+        REQUIRE(model->getInterpolatedValues({25}).at(0).toDouble() == 10.);
+    }
     clip.reset();
     timeline.reset();
     pCore->projectManager()->closeCurrentDocument(false, false);
@@ -260,6 +260,39 @@ TEST_CASE("Marker model", "[MarkerListModel]")
         undoStack->redo();
         checkMarkerList(model, list, snaps);
     }
+
+    SECTION("Import marker not on a frame boundary")
+    {
+        checkMarkerList(model, {}, snaps);
+        // Plain seconds, a third of a frame after frame 50
+        const GenTime position(2. + 1. / (3. * fps));
+        REQUIRE(position.frames(fps) == 50);
+        int type = KdenliveSettings::default_marker_type();
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        REQUIRE(model->importFromTxt(QStringLiteral("%1 imported marker").arg(position.seconds(), 0, 'f', 6), undo, redo));
+        std::vector<Marker> list;
+        list.emplace_back(position, QLatin1String("imported marker"), type);
+        checkMarkerList(model, list, snaps);
+
+        // The marker is found from its frame
+        REQUIRE(model->hasMarker(50));
+        int mid = model->markerIdAtFrame(50);
+        REQUIRE(mid > -1);
+        REQUIRE(model->getMarkerPos(mid) == 50);
+        REQUIRE(model->getMarkersIdInRange(50, 50).size() == 1);
+        // Adding a marker on the same frame edits the existing one
+        REQUIRE(model->addMarker(GenTime(50, fps), QLatin1String("same frame"), type));
+        REQUIRE(model->rowCount() == 1);
+        REQUIRE(model->marker(50).comment() == QLatin1String("same frame"));
+
+        // Moving and removing it keeps the index in sync
+        REQUIRE(model->editMarker(position, GenTime(4.), QLatin1String("moved"), type));
+        REQUIRE_FALSE(model->hasMarker(50));
+        REQUIRE(model->hasMarker(GenTime(4.)));
+        REQUIRE(model->removeMarker(GenTime(4.)));
+        checkMarkerList(model, {}, snaps);
+    }
     snaps.reset();
     // undoStack->clear();
     pCore->projectManager()->closeCurrentDocument(false, false);
@@ -281,6 +281,40 @@ TEST_CASE("Clip manipulation", "[ClipModel]")
 
     RESET(timMock);
 
+    SECTION("Range queries follow moves and resizes")
+    {
+        using Ids = std::unordered_set<int>;
+        int l = timeline->getClipPlaytime(cid2);
+        REQUIRE(timeline->requestClipMove(cid2, tid1, 10));
+        REQUIRE(timeline->requestClipMove(cid3, tid1, 10 + l + 5));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getItemsInRange(tid1, 0, 5) == Ids());
+        REQUIRE(timeline->getItemsInRange(tid1, 0, 11) == Ids{cid2});
+        REQUIRE(timeline->getItemsInRange(tid1, 10 + l - 1) == Ids{cid2, cid3});
+        REQUIRE(timeline->getItemsInRange(tid1, 10 + l, 10 + l + 5) == Ids());
+        REQUIRE(timeline->getItemsInRange(tid1, 10 + l, 10 + l + 6) == Ids{cid3});
+
+        // Resizing from the left moves the clip start
+        REQUIRE(timeline->requestItemResize(cid3, l - 3, false) == l - 3);
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getItemsInRange(tid1, 10 + l, 10 + l + 8) == Ids());
+        REQUIRE(timeline->getItemsInRange(tid1, 10 + l, 10 + l + 9) == Ids{cid3});
+        undoStack->undo();
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getItemsInRange(tid1, 10 + l, 10 + l + 6) == Ids{cid3});
+
+        // Moved clips leave the index of their previous track
+        REQUIRE(timeline->requestClipMove(cid2, tid2, 10));
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getItemsInRange(tid1, 0, 11) == Ids());
+        REQUIRE(timeline->getItemsInRange(tid2, 0, 11) == Ids{cid2});
+        undoStack->undo();
+        undoStack->undo();
+        undoStack->undo();
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(timeline->getItemsInRange(tid1, 0) == Ids());
+    }
+
     SECTION("Endless clips can be resized both sides")
     {
 
@@ -943,6 +977,47 @@ TEST_CASE("Clip manipulation", "[ClipModel]")
         check_undo(8, tid2, tid1);
     }
 
+    SECTION("Ghost group move")
+    {
+        REQUIRE(timeline->requestClipMove(cid1, tid1, 0));
+        REQUIRE(timeline->requestClipMove(cid2, tid1, length + 3));
+        REQUIRE(timeline->requestClipMove(cid3, tid2, 0));
+        REQUIRE(timeline->requestClipsGroup({cid1, cid2}));
+        int undoIndex = undoStack->index();
+
+        // Ghost moves only update the fake positions
+        QVariantList moveData = timeline->suggestClipMove(cid1, tid1, 5, -1, -1, true, true);
+        REQUIRE(moveData.at(0).toInt() == 5);
+        REQUIRE(moveData.at(1).toInt() == tid1);
+        REQUIRE(timeline->getItemFakePosition(cid1) == 5);
+        REQUIRE(timeline->getItemFakePosition(cid2) == length + 8);
+        REQUIRE(timeline->getClipPosition(cid1) == 0);
+        REQUIRE(timeline->getClipPosition(cid2) == length + 3);
+        REQUIRE(undoStack->index() == undoIndex);
+
+        // Overlapping a clip that is not moving keeps the last valid ghost position
+        moveData = timeline->suggestClipMove(cid1, tid2, 5, -1, -1, true, true);
+        REQUIRE(moveData.at(0).toInt() == 5);
+        REQUIRE(moveData.at(1).toInt() == tid1);
+        REQUIRE(timeline->getItemFakePosition(cid1) == 5);
+        REQUIRE(timeline->getItemFakePosition(cid2) == length + 8);
+
+        // The timeline is modified on drop only
+        REQUIRE(timeline->endGhostMove(cid1, 5));
+        REQUIRE(timeline->getItemFakePosition(cid1) == -1);
+        REQUIRE(timeline->getItemFakePosition(cid2) == -1);
+        REQUIRE(timeline->getClipTrackId(cid1) == tid1);
+        REQUIRE(timeline->getClipPosition(cid1) == 5);
+        REQUIRE(timeline->getClipPosition(cid2) == length + 8);
+        REQUIRE(timeline->checkConsistency());
+        REQUIRE(undoStack->index() == undoIndex + 1);
+
+        undoStack->undo();
+        REQUIRE(timeline->getClipPosition(cid1) == 0);
+        REQUIRE(timeline->getClipPosition(cid2) == length + 3);
+        REQUIRE(timeline->checkConsistency());
+    }
+
     SECTION("Group move to unavailable track")
     {
         REQUIRE(timeline->requestClipMove(cid1, tid1, 10));
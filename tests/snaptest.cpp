@@ -127,4 +127,25 @@ TEST_CASE("Snap points model test", "[SnapModel]")
         REQUIRE(snap.getClosestPoint(9) == 15);
         REQUIRE(snap.getClosestPoint(999) == 15);
     }
+
+    SECTION("Deferred points")
+    {
+        snap.addPoint(50);
+        snap.setDeferred(true);
+        for (int pos : {30, 10, 50, 20, 10}) {
+            snap.addPoint(pos);
+        }
+        // Queries see the queued points
+        REQUIRE(snap.getClosestPoint(12) == 10);
+        std::map<int, int> expected{{10, 2}, {20, 1}, {30, 1}, {50, 2}};
+        REQUIRE(snap._snaps() == expected);
+
+        snap.addPoint(40);
+        snap.removePoint(10);
+        snap.setDeferred(false);
+        expected = {{10, 1}, {20, 1}, {30, 1}, {40, 1}, {50, 2}};
+        REQUIRE(snap._snaps() == expected);
+        snap.addPoint(60);
+        REQUIRE(snap.getClosestPoint(58) == 60);
+    }
 }
@@ -11,6 +11,9 @@
 #include "doc/docundostack.hpp"
 #include "doc/kdenlivedoc.h"
 
+#include <QElapsedTimer>
+#include <QTemporaryDir>
+
 using namespace fakeit;
 
 TEST_CASE("Read subtitle file", "[Subtitles]")
@@ -195,6 +198,31 @@ TEST_CASE("Read subtitle file", "[Subtitles]")
         REQUIRE(subtitleModel->rowCount() == 0);
     }
 
+    SECTION("Ensure 2 subtitles cannot start within the same frame")
+    {
+        int subId = KdenliveTests::getNextId();
+        int subId2 = KdenliveTests::getNextId();
+        int subId3 = KdenliveTests::getNextId();
+        double fps = pCore->getCurrentFps();
+        // A start that is not on a frame boundary, as read from a subtitle file in milliseconds
+        const GenTime offFrame = GenTime(50, fps) + GenTime(0.3 / fps);
+        REQUIRE(offFrame.frames(fps) == 50);
+        REQUIRE(subtitleModel->addSubtitle(subId, {0, offFrame},
+                                           SubtitleEvent(true, GenTime(70, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Hello")), false, false));
+        REQUIRE(subtitleModel->addSubtitle(subId2, {0, GenTime(50, fps)},
+                                           SubtitleEvent(true, GenTime(90, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Hello2")), false, false) == false);
+        REQUIRE(subtitleModel->rowCount() == 1);
+        // The subtitle is found from its frame start
+        REQUIRE(subtitleModel->getSubtitle(0, GenTime(50, fps)).text() == QStringLiteral("Hello"));
+        REQUIRE(subtitleModel->addSubtitle(subId3, {0, GenTime(100, fps)},
+                                           SubtitleEvent(true, GenTime(140, fps), "Default", "", 0, 0, 0, "", QStringLiteral("Second")), false, false));
+        // Moving into the frame of another subtitle is refused too
+        REQUIRE(subtitleModel->moveSubtitle(subId3, 0, GenTime(50, fps) - GenTime(0.3 / fps), false, false) == false);
+        REQUIRE(subtitleModel->rowCount() == 2);
+        subtitleModel->removeAllSubtitles();
+        REQUIRE(subtitleModel->rowCount() == 0);
+    }
+
     SECTION("Ensure we cannot cut overlapping subtitles (it would create 2 subtitles at same frame position")
     {
         // In our current implementation, having 2 subtitles at same start time is not allowed
@@ -274,3 +302,101 @@ TEST_CASE("Read subtitle file", "[Subtitles]")
     binModel->clean();
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
+
+TEST_CASE("Subtitle work file", "[Subtitles]")
+{
+    auto binModel = pCore->projectItemModel();
+    binModel->clean();
+    std::shared_ptr<DocUndoStack> undoStack = std::make_shared<DocUndoStack>(nullptr);
+    KdenliveDoc document(undoStack);
+    pCore->projectManager()->testSetDocument(&document);
+    QDateTime documentDate = QDateTime::currentDateTime();
+    KdenliveTests::updateTimeline(false, QString(), QString(), documentDate, 0);
+    auto timeline = document.getTimeline(document.uuid());
+    pCore->projectManager()->testSetActiveTimeline(timeline);
+    KdenliveTests::resetNextId();
+    document.setDocumentProperty(QStringLiteral("documentid"), QString::number(QDateTime::currentMSecsSinceEpoch()));
+    std::shared_ptr<SubtitleModel> subtitleModel = timeline->createSubtitleModel();
+    const double fps = pCore->getCurrentFps();
+    const QString workPath = document.subTitlePath(timeline->uuid(), 0, false);
+
+    auto fileContains = [](const QString &path, const QString &text) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        return QString::fromUtf8(file.readAll()).contains(text);
+    };
+    auto processEvents = [](int ms) {
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < ms) {
+            qApp->processEvents();
+        }
+    };
+    // Index of the last created subtitle file
+    auto lastSubtitleIndex = [&subtitleModel]() {
+        int ix = 0;
+        const QList<std::pair<int, QString>> keys = subtitleModel->getSubtitlesList().keys();
+        for (const auto &key : keys) {
+            ix = qMax(ix, key.first);
+        }
+        return ix;
+    };
+    auto addSubtitle = [&](int frame, const QString &text) {
+        return subtitleModel->addSubtitle(KdenliveTests::getNextId(), {0, GenTime(frame, fps)},
+                                          SubtitleEvent(true, GenTime(frame + 10, fps), "Default", "", 0, 0, 0, "", text), false, true);
+    };
+
+    SECTION("Edits are written once they pause")
+    {
+        REQUIRE(addSubtitle(50, QStringLiteral("First")));
+        REQUIRE(addSubtitle(100, QStringLiteral("Second")));
+        REQUIRE_FALSE(fileContains(workPath, QStringLiteral("Second")));
+        processEvents(500);
+        REQUIRE(fileContains(workPath, QStringLiteral("First")));
+        REQUIRE(fileContains(workPath, QStringLiteral("Second")));
+    }
+
+    SECTION("Saving and duplicating write pending edits")
+    {
+        REQUIRE(addSubtitle(50, QStringLiteral("Saved")));
+        QTemporaryDir dir;
+        const QString savedPath = dir.filePath(QStringLiteral("saved.ass"));
+        subtitleModel->copySubtitle(savedPath, 0, false);
+        REQUIRE(fileContains(savedPath, QStringLiteral("Saved")));
+
+        REQUIRE(addSubtitle(100, QStringLiteral("Duplicated")));
+        subtitleModel->createNewSubtitle(QStringLiteral("Copy"), 0);
+        const int duplicate = lastSubtitleIndex();
+        REQUIRE(fileContains(document.subTitlePath(timeline->uuid(), duplicate, true), QStringLiteral("Duplicated")));
+        QFile::remove(document.subTitlePath(timeline->uuid(), duplicate, true));
+    }
+
+    SECTION("Activating another subtitle writes pending edits")
+    {
+        REQUIRE(addSubtitle(50, QStringLiteral("Before switch")));
+        subtitleModel->createNewSubtitle(QStringLiteral("Other"));
+        const int other = lastSubtitleIndex();
+        subtitleModel->activateSubtitle(other);
+        REQUIRE(fileContains(workPath, QStringLiteral("Before switch")));
+        REQUIRE(subtitleModel->rowCount() == 0);
+
+        SECTION("A deleted subtitle is not written back")
+        {
+            const QString otherPath = document.subTitlePath(timeline->uuid(), other, false);
+            REQUIRE(addSubtitle(50, QStringLiteral("Deleted")));
+            REQUIRE(subtitleModel->deleteSubtitle(other));
+            processEvents(500);
+            REQUIRE_FALSE(QFile::exists(otherPath));
+        }
+        subtitleModel->activateSubtitle(0);
+        REQUIRE(subtitleModel->rowCount() == 1);
+    }
+
+    subtitleModel->removeAllSubtitles();
+    subtitleModel->flushWorkFile();
+    QFile::remove(workPath);
+    binModel->clean();
+    pCore->projectManager()->closeCurrentDocument(false, false);
+}
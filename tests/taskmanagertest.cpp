@@ -0,0 +1,168 @@
+/*
+    SPDX-FileCopyrightText: 2026 agent <agent@local>
+    SPDX-License-Identifier: GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+*/
+#include "catch.hpp"
+#include "test_utils.hpp"
+// test specific headers
+#include "core.h"
+#include "jobs/abstracttask.h"
+#include "jobs/taskmanager.h"
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QThread>
+
+namespace {
+/** @brief A task that runs until it is released or canceled */
+class BlockingTask : public AbstractTask
+{
+public:
+    BlockingTask(int ownerId, AbstractTask::JOBTYPE type, const QString &resource, std::shared_ptr<QSemaphore> started, std::shared_ptr<QSemaphore> release)
+        : AbstractTask(ObjectId(KdenliveObjectType::BinClip, ownerId, QUuid()), type, nullptr)
+        , m_started(std::move(started))
+        , m_release(std::move(release))
+    {
+        m_resource = resource;
+    }
+
+protected:
+    void run() override
+    {
+        AbstractTaskDone whenFinished(m_owner.itemId, this);
+        QMutexLocker lock(&m_runMutex);
+        m_running = true;
+        m_started->release();
+        while (!m_isCanceled && !m_release->tryAcquire(1, 10)) {
+        }
+    }
+
+private:
+    std::shared_ptr<QSemaphore> m_started;
+    std::shared_ptr<QSemaphore> m_release;
+};
+
+/** @brief Wait until the tasks of a clip are removed from the task manager */
+bool waitForTasks(int ownerId)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (pCore->taskManager.hasPendingJob(ObjectId(KdenliveObjectType::BinClip, ownerId, QUuid()))) {
+        if (timer.elapsed() > 5000) {
+            return false;
+        }
+        QThread::msleep(10);
+    }
+    return true;
+}
+} // namespace
+
+TEST_CASE("Task coalescing", "[TaskManager]")
+{
+    auto started = std::make_shared<QSemaphore>();
+    auto release = std::make_shared<QSemaphore>();
+
+    SECTION("Tasks working on the same resource are not run concurrently")
+    {
+        pCore->taskManager.startTask(100001, new BlockingTask(100001, AbstractTask::AUDIOTHUMBJOB, QStringLiteral("samehash"), started, release));
+        REQUIRE(started->tryAcquire(1, 5000));
+        pCore->taskManager.startTask(100002, new BlockingTask(100002, AbstractTask::AUDIOTHUMBJOB, QStringLiteral("samehash"), started, release));
+        // The second task waits for the first one
+        REQUIRE_FALSE(started->tryAcquire(1, 300));
+        REQUIRE(pCore->taskManager.jobStatus(ObjectId(KdenliveObjectType::BinClip, 100002, QUuid())) == TaskManagerStatus::Pending);
+        release->release();
+        REQUIRE(started->tryAcquire(1, 5000));
+        release->release();
+        REQUIRE(waitForTasks(100001));
+        REQUIRE(waitForTasks(100002));
+    }
+
+    SECTION("Canceling a task while it starts does not block")
+    {
+        const ObjectId owner(KdenliveObjectType::BinClip, 100003, QUuid());
+        pCore->taskManager.startTask(owner.itemId, new BlockingTask(owner.itemId, AbstractTask::CACHEJOB, QStringLiteral("otherhash"), started, release));
+        pCore->taskManager.startTask(100004, new BlockingTask(100004, AbstractTask::CACHEJOB, QStringLiteral("otherhash"), started, release));
+        REQUIRE(started->tryAcquire(1, 5000));
+        // The running task holds its run mutex, discarding it waits for its run() method to return
+        QThread *thread = QThread::create([owner]() { pCore->taskManager.discardJobs(owner); });
+        thread->start();
+        REQUIRE(thread->wait(5000));
+        delete thread;
+        REQUIRE(waitForTasks(owner.itemId));
+        // The waiting task is started once the canceled one released the resource
+        REQUIRE(started->tryAcquire(1, 5000));
+        release->release();
+        REQUIRE(waitForTasks(100004));
+    }
+}
+
+TEST_CASE("Task lanes", "[TaskManager]")
+{
+    const int workers = KdenliveTests::taskWorkerCount();
+    auto started = std::make_shared<QSemaphore>();
+    auto release = std::make_shared<QSemaphore>();
+
+    SECTION("Tasks are queued by type and promoted with the displayed clip")
+    {
+        // Keep all workers busy with tasks of the displayed clip
+        pCore->taskManager.setDisplayedClip(200000);
+        for (int i = 0; i < workers; i++) {
+            pCore->taskManager.startTask(200000, new BlockingTask(200000, AbstractTask::ANALYSECLIPJOB, QString(), started, release));
+        }
+        REQUIRE(started->tryAcquire(workers, 5000));
+        pCore->taskManager.setDisplayedClip(-1);
+
+        auto promotedStarted = std::make_shared<QSemaphore>();
+        auto *load = new BlockingTask(200001, AbstractTask::LOADJOB, QString(), started, release);
+        auto *analysis = new BlockingTask(200002, AbstractTask::ANALYSECLIPJOB, QString(), promotedStarted, release);
+        auto proxyRelease = std::make_shared<QSemaphore>();
+        auto *proxy = new BlockingTask(200003, AbstractTask::PROXYJOB, QString(), started, proxyRelease);
+        pCore->taskManager.startTask(200001, load);
+        pCore->taskManager.startTask(200002, analysis);
+        REQUIRE(KdenliveTests::taskLane(load) == 1);
+        REQUIRE(KdenliveTests::taskLane(analysis) == 2);
+        // Transcoding runs in its own pool
+        pCore->taskManager.startTask(200003, proxy);
+        REQUIRE(KdenliveTests::taskLane(proxy) == 3);
+        REQUIRE(started->tryAcquire(1, 5000));
+        proxyRelease->release();
+        REQUIRE(waitForTasks(200003));
+
+        // Opening a clip in the Clip Monitor moves its tasks to the interactive lane
+        pCore->taskManager.setDisplayedClip(200002);
+        REQUIRE(KdenliveTests::taskLane(analysis) == 0);
+        REQUIRE(KdenliveTests::taskLane(load) == 1);
+        // It is started first when a worker is free, although the load task is older
+        release->release();
+        REQUIRE(promotedStarted->tryAcquire(1, 5000));
+        REQUIRE(KdenliveTests::taskLane(load) == 1);
+        REQUIRE_FALSE(started->tryAcquire(1, 300));
+
+        pCore->taskManager.slotCancelJobs();
+        pCore->taskManager.setDisplayedClip(-1);
+    }
+
+    SECTION("A worker is kept for the displayed clip")
+    {
+        if (workers < 2) {
+            // A single worker is shared by all lanes
+            return;
+        }
+        for (int i = 0; i < workers; i++) {
+            pCore->taskManager.startTask(300000 + i, new BlockingTask(300000 + i, AbstractTask::LOADJOB, QString(), started, release));
+            pCore->taskManager.startTask(301000 + i, new BlockingTask(301000 + i, AbstractTask::ANALYSECLIPJOB, QString(), started, release));
+        }
+        // Load and analysis tasks together never use the last worker
+        REQUIRE(started->tryAcquire(workers - 1, 5000));
+        REQUIRE_FALSE(started->tryAcquire(1, 300));
+
+        auto interactiveStarted = std::make_shared<QSemaphore>();
+        pCore->taskManager.setDisplayedClip(302000);
+        pCore->taskManager.startTask(302000, new BlockingTask(302000, AbstractTask::ANALYSECLIPJOB, QString(), interactiveStarted, release));
+        REQUIRE(interactiveStarted->tryAcquire(1, 5000));
+
+        pCore->taskManager.slotCancelJobs();
+        pCore->taskManager.setDisplayedClip(-1);
+    }
+}
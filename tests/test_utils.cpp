@@ -8,6 +8,7 @@
 #include "doc/kdenlivedoc.h"
 #include "src/assets/keyframes/model/keyframemodel.hpp"
 #include "src/renderpresets/renderpresetrepository.hpp"
+#include "src/timeline2/view/previewmanager.h"
 #include "src/utils/thumbnailcache.hpp"
 
 QString KdenliveTests::createProducer(Mlt::Profile &prof, std::string color, std::shared_ptr<ProjectItemModel> binModel, int length, bool limited)
@@ -292,3 +293,42 @@ bool KdenliveTests::effectFilterName(EffectFilter &filter, std::shared_ptr<TreeI
 {
     return filter.filterName(item);
 }
+
+int KdenliveTests::taskWorkerCount()
+{
+    return pCore->taskManager.m_workerCount;
+}
+
+int KdenliveTests::taskLane(AbstractTask *task)
+{
+    QReadLocker lk(&pCore->taskManager.m_tasksListLock);
+    for (int lane = 0; lane < TaskManager::LaneCount; ++lane) {
+        for (const auto &pending : pCore->taskManager.m_pendingTasks[lane]) {
+            if (pending.task == task) {
+                return lane;
+            }
+        }
+    }
+    auto started = pCore->taskManager.m_startedTasks.find(task);
+    return started == pCore->taskManager.m_startedTasks.end() ? -1 : started->second;
+}
+
+QList<QStringList> KdenliveTests::partitionChunks(const QList<int> &chunks, int playhead, int workers)
+{
+    return PreviewManager::partitionChunks(chunks, playhead, workers);
+}
+
+QString KdenliveTests::createFile(const QDir &root, const QString &name, const QByteArray &data, const QDateTime &modified)
+{
+    const QString path = root.absoluteFilePath(name);
+    REQUIRE(root.mkpath(QFileInfo(path).absolutePath()));
+    QFile file(path);
+    REQUIRE(file.open(QIODevice::WriteOnly));
+    REQUIRE(file.write(data) == data.size());
+    file.flush();
+    if (modified.isValid()) {
+        REQUIRE(file.setFileTime(modified, QFileDevice::FileModificationTime));
+    }
+    file.close();
+    return path;
+}
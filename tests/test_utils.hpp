@@ -7,6 +7,8 @@
 #include "abortutil.hpp"
 #include "catch.hpp"
 #include "tests_definitions.h"
+#include <QDateTime>
+#include <QDir>
 #include <QString>
 #include <iostream>
 #include <memory>
@@ -143,4 +145,10 @@ public:
     static bool checkModelConsistency(std::shared_ptr<AbstractTreeModel> model);
     static int modelSize(std::shared_ptr<AbstractTreeModel> model);
     static bool effectFilterName(EffectFilter &filter, std::shared_ptr<TreeItem> item);
+    static int taskWorkerCount();
+    /** @brief Write a file with @p data below @p root, creating the missing folders. Returns its path */
+    static QString createFile(const QDir &root, const QString &name, const QByteArray &data, const QDateTime &modified = QDateTime());
+    /** @brief The lane in which a task is queued or running, -1 if it is unknown to the task manager */
+    static int taskLane(AbstractTask *task);
+    static QList<QStringList> partitionChunks(const QList<int> &chunks, int playhead, int workers);
 };
@@ -18,6 +18,7 @@
 #include "bin/binplaylist.hpp"
 #include "definitions.h"
 #include "doc/kdenlivedoc.h"
+#include "kdenlivesettings.h"
 #include "timeline2/model/builders/meltBuilder.hpp"
 #include "timeline2/view/previewmanager.h"
 #include "xml/xml.hpp"
@@ -103,3 +104,64 @@ TEST_CASE("Timeline preview insert-remove", "[TimelinePreview]")
     REQUIRE(dir.exists() == false);
     pCore->projectManager()->closeCurrentDocument(false, false);
 }
+
+TEST_CASE("Timeline preview chunk partition", "[TimelinePreview]")
+{
+    const int chunkSize = KdenliveSettings::timelinechunks();
+    QList<int> chunks;
+    for (int i = 0; i < 10; ++i) {
+        chunks << i * chunkSize;
+    }
+
+    SECTION("Single process renders from the playhead")
+    {
+        const QList<QStringList> shares = KdenliveTests::partitionChunks(chunks, 4 * chunkSize + 1, 1);
+        REQUIRE(shares.size() == 1);
+        // Chunks after the playhead, then the block behind it, rendered forward
+        REQUIRE(shares.first() == QStringList{QStringLiteral("%1-%2").arg(4 * chunkSize).arg(9 * chunkSize), QStringLiteral("0-%1").arg(3 * chunkSize)});
+    }
+
+    SECTION("Processes get contiguous blocks of chunks")
+    {
+        const QList<QStringList> shares = KdenliveTests::partitionChunks(chunks, 0, 3);
+        REQUIRE(shares.size() == 3);
+        REQUIRE(shares.at(0) == QStringList{QStringLiteral("0-%1").arg(3 * chunkSize)});
+        REQUIRE(shares.at(1) == QStringList{QStringLiteral("%1-%2").arg(4 * chunkSize).arg(7 * chunkSize)});
+        REQUIRE(shares.at(2) == QStringList{QStringLiteral("%1-%2").arg(8 * chunkSize).arg(9 * chunkSize)});
+    }
+
+    SECTION("Blocks are dealt in turn from the playhead")
+    {
+        QList<int> longRange;
+        for (int i = 0; i < 20; ++i) {
+            longRange << i * chunkSize;
+        }
+        const QList<QList<int>> queues = PreviewManager::scheduleChunks(longRange, 0, 2);
+        REQUIRE(queues.size() == 2);
+        REQUIRE(queues.at(0).mid(0, 5) == QList<int>{0, chunkSize, 2 * chunkSize, 3 * chunkSize, 8 * chunkSize});
+        REQUIRE(queues.at(1).mid(0, 5) == QList<int>{4 * chunkSize, 5 * chunkSize, 6 * chunkSize, 7 * chunkSize, 12 * chunkSize});
+    }
+
+    SECTION("Isolated chunks are listed separately")
+    {
+        const QList<QStringList> shares = KdenliveTests::partitionChunks({0, chunkSize, 5 * chunkSize}, 0, 1);
+        REQUIRE(shares.size() == 1);
+        REQUIRE(shares.first() == QStringList{QStringLiteral("0-%1").arg(chunkSize), QString::number(5 * chunkSize)});
+    }
+
+    SECTION("Playhead moved before the remaining chunks")
+    {
+        // Chunks behind the playhead come last, in a separate block
+        const QList<QList<int>> queues = PreviewManager::scheduleChunks({0, 2 * chunkSize, 8 * chunkSize, 9 * chunkSize}, 5 * chunkSize, 2);
+        REQUIRE(queues.size() == 2);
+        REQUIRE(queues.at(0) == QList<int>{8 * chunkSize, 9 * chunkSize});
+        REQUIRE(queues.at(1) == QList<int>{0, 2 * chunkSize});
+    }
+
+    SECTION("No more processes than chunks")
+    {
+        const QList<QStringList> shares = KdenliveTests::partitionChunks({0, chunkSize}, 0, 4);
+        REQUIRE(shares.size() == 2);
+        REQUIRE(KdenliveTests::partitionChunks({}, 0, 4).isEmpty());
+    }
+}
@@ -6,10 +6,16 @@
 #include "catch.hpp"
 #include "test_utils.hpp"
 // test specific headers
+#include "undohelper.hpp"
 #include "utils/gentime.h"
 #include "utils/qstringutils.h"
+#include "utils/rowindex.hpp"
+#include "utils/ticktime.h"
 #include "utils/timecode.h"
 
+#include <map>
+#include <vector>
+
 TEST_CASE("Testing for different utils", "[Utils]")
 {
 
@@ -33,6 +39,25 @@ TEST_CASE("Testing for different utils", "[Utils]")
     }
 }
 
+TEST_CASE("Row index", "[Utils]")
+{
+    RowIndex index;
+    for (int id : {12, 3, 7, 20}) {
+        index.insert(id);
+    }
+    index.insert(7);
+    REQUIRE(index.size() == 4);
+    REQUIRE(index.row(3) == 0);
+    REQUIRE(index.row(7) == 1);
+    REQUIRE(index.row(20) == 3);
+    REQUIRE(index.row(5) == -1);
+    REQUIRE(index.at(2) == 12);
+    REQUIRE(index.at(4) == -1);
+    index.remove(7);
+    REQUIRE(index.row(12) == 1);
+    REQUIRE(index.size() == 3);
+}
+
 TEST_CASE("Testing for GenTime", "[GenTime]")
 {
     SECTION("Create from frames and fps should work")
@@ -82,6 +107,73 @@ TEST_CASE("Testing for GenTime", "[GenTime]")
     }
 }
 
+TEST_CASE("Testing for TickTime", "[GenTime]")
+{
+    const double ntsc = 30000. / 1001.;
+
+    SECTION("Frames of NTSC rates are exact")
+    {
+        REQUIRE(TickTime::fromFrames(1, ntsc).ticks() == 23543520);
+        REQUIRE(TickTime::fromFrames(1, 24000. / 1001.).ticks() == 29429400);
+        REQUIRE(TickTime::fromFrames(30000, ntsc) == TickTime::fromSeconds(1001));
+        bool exact = true;
+        for (int i = 0; i < 200000; i++) {
+            exact = exact && TickTime::fromFrames(i, ntsc).frames(ntsc) == i;
+        }
+        REQUIRE(exact);
+    }
+
+    SECTION("GenTime conversion is exact")
+    {
+        GenTime::setFps(ntsc);
+        const GenTime oneFrame(1, ntsc);
+        GenTime accumulated;
+        for (int i = 0; i < 5000; i++) {
+            accumulated += oneFrame;
+        }
+        // Both GenTime point to frame 5000, but differ in their last bits
+        REQUIRE(TickTime(accumulated) == TickTime::fromFrames(5000, ntsc));
+        REQUIRE(TickTime(GenTime(5000, ntsc)) == TickTime::fromFrames(5000, ntsc));
+        // A time between two frames is not rounded
+        REQUIRE(TickTime(GenTime(5000, ntsc) + GenTime(0.3 / ntsc)) > TickTime::fromFrames(5000, ntsc));
+        REQUIRE(TickTime(GenTime(5000, ntsc) - GenTime(0.3 / ntsc)) < TickTime::fromFrames(5000, ntsc));
+
+        const GenTime back(TickTime::fromFrames(5000, ntsc));
+        REQUIRE(back == GenTime(5000, ntsc));
+        REQUIRE(back.frames(ntsc) == 5000);
+    }
+
+    SECTION("GenTime conversion does not depend on the fps")
+    {
+        const GenTime time(5000, ntsc);
+        const GenTime offFrame = time + GenTime(0.3 / ntsc);
+        GenTime::setFps(ntsc);
+        const TickTime key(time);
+        const TickTime offFrameKey(offFrame);
+        GenTime::setFps(25.);
+        REQUIRE(TickTime(time) == key);
+        REQUIRE(TickTime(offFrame) == offFrameKey);
+    }
+
+    SECTION("Sorted containers find GenTime positions")
+    {
+        std::map<TickTime, int> map;
+        for (int i = 0; i < 1000; i++) {
+            map[TickTime(GenTime(i * 3, ntsc))] = i;
+        }
+        GenTime accumulated;
+        for (int i = 0; i < 1000; i++) {
+            REQUIRE(map.count(TickTime(accumulated)) == 1);
+            REQUIRE(map.at(TickTime(accumulated)) == i);
+            accumulated += GenTime(3, ntsc);
+        }
+        REQUIRE(map.size() == 1000);
+        auto next = map.upper_bound(TickTime(GenTime(4, ntsc)));
+        REQUIRE(next->first == TickTime::fromFrames(6, ntsc));
+    }
+    GenTime::setFps(pCore->getCurrentFps());
+}
+
 TEST_CASE("Testing for timecodes", "[Timecodes]")
 {
     SECTION("Static frames to TC: should work for positive values")
@@ -161,3 +253,155 @@ TEST_CASE("Testing for timecodes", "[Timecodes]")
         REQUIRE(res == QStringLiteral("01:02:03:05"));
     }
 }
+
+TEST_CASE("Undo operation log", "[Undo]")
+{
+    QString trace;
+    auto step = [&trace](const QString &name, bool result = true) {
+        return Fun([&trace, name, result]() {
+            trace.append(name);
+            return result;
+        });
+    };
+
+    SECTION("Undo runs backward, redo runs forward")
+    {
+        Fun undo = []() { return true; };
+        Fun redo = []() { return true; };
+        for (int i = 0; i < 3; i++) {
+            appendOperation(undo, step(QStringLiteral("u%1").arg(i)), OperationLog::Backward);
+            appendOperation(redo, step(QStringLiteral("r%1").arg(i)), OperationLog::Forward);
+        }
+        // Appends are flattened in a single log
+        REQUIRE(undo.target<OperationLog>() != nullptr);
+        REQUIRE(undo.target<OperationLog>()->size() == 4);
+        REQUIRE(undo());
+        REQUIRE(trace == QStringLiteral("u2u1u0"));
+        trace.clear();
+        REQUIRE(redo());
+        REQUIRE(trace == QStringLiteral("r0r1r2"));
+    }
+
+    SECTION("Failures")
+    {
+        Fun undo = []() { return true; };
+        appendOperation(undo, step(QStringLiteral("a")), OperationLog::Backward);
+        appendOperation(undo, step(QStringLiteral("b"), false), OperationLog::Backward);
+        // All operations run, the failure is reported
+        REQUIRE_FALSE(undo());
+        REQUIRE(trace == QStringLiteral("ba"));
+        trace.clear();
+
+        Fun operation = []() { return true; };
+        PUSH_LAMBDA(step(QStringLiteral("a"), false), operation);
+        PUSH_LAMBDA(step(QStringLiteral("b")), operation);
+        REQUIRE_FALSE(operation());
+        REQUIRE(trace == QStringLiteral("a"));
+        trace.clear();
+
+        Fun front = step(QStringLiteral("a"));
+        PUSH_FRONT_LAMBDA(step(QStringLiteral("b")), front);
+        PUSH_FRONT_LAMBDA(step(QStringLiteral("c")), front);
+        REQUIRE(front());
+        REQUIRE(trace == QStringLiteral("cba"));
+    }
+
+    SECTION("Copies are independent")
+    {
+        Fun redo = []() { return true; };
+        appendOperation(redo, step(QStringLiteral("a")), OperationLog::Forward);
+        Fun copy = redo;
+        appendOperation(redo, step(QStringLiteral("b")), OperationLog::Forward);
+        REQUIRE(copy());
+        REQUIRE(trace == QStringLiteral("a"));
+    }
+
+    SECTION("Long logs don't recurse")
+    {
+        int count = 0;
+        Fun redo = []() { return true; };
+        for (int i = 0; i < 100000; i++) {
+            Fun operation = [&count]() {
+                count++;
+                return true;
+            };
+            appendOperation(redo, operation, OperationLog::Forward);
+        }
+        REQUIRE(redo());
+        REQUIRE(count == 100000);
+    }
+}
+
+// Run with: utilstest "[benchmark]"
+TEST_CASE("Time keyed containers benchmark", "[.][benchmark]")
+{
+    // Keyframe and marker containers, as used by KeyframeModel and MarkerListModel before and after switching to TickTime keys
+    const double fps = 30000. / 1001.;
+    GenTime::setFps(fps);
+    const int count = 20000;
+    std::vector<GenTime> positions;
+    positions.reserve(count);
+    for (int i = 0; i < count; i++) {
+        positions.push_back(GenTime(i * 3, fps));
+    }
+    std::map<GenTime, int> genTimeKeyframes;
+    std::map<TickTime, int> tickKeyframes;
+    QMap<int, int> frameMarkers;
+    QMap<TickTime, int> tickMarkers;
+    for (int i = 0; i < count; i++) {
+        genTimeKeyframes[positions.at(i)] = i;
+        tickKeyframes[TickTime(positions.at(i))] = i;
+        frameMarkers.insert(i * 3, i);
+        tickMarkers.insert(TickTime(positions.at(i)), i);
+    }
+
+    BENCHMARK("Keyframes insert, GenTime keys")
+    {
+        std::map<GenTime, int> map;
+        for (int i = 0; i < count; i++) {
+            map[positions.at(i)] = i;
+        }
+        return map.size();
+    };
+    BENCHMARK("Keyframes insert, TickTime keys")
+    {
+        std::map<TickTime, int> map;
+        for (int i = 0; i < count; i++) {
+            map[TickTime(positions.at(i))] = i;
+        }
+        return map.size();
+    };
+    BENCHMARK("Keyframes lookup, GenTime keys")
+    {
+        size_t found = 0;
+        for (const GenTime &pos : positions) {
+            found += genTimeKeyframes.count(pos);
+        }
+        return found;
+    };
+    BENCHMARK("Keyframes lookup, TickTime keys")
+    {
+        size_t found = 0;
+        for (const GenTime &pos : positions) {
+            found += tickKeyframes.count(TickTime(pos));
+        }
+        return found;
+    };
+    BENCHMARK("Markers lookup, frame keys")
+    {
+        int found = 0;
+        for (const GenTime &pos : positions) {
+            found += frameMarkers.value(pos.frames(fps), -1) >= 0 ? 1 : 0;
+        }
+        return found;
+    };
+    BENCHMARK("Markers lookup, TickTime keys")
+    {
+        int found = 0;
+        for (const GenTime &pos : positions) {
+            found += tickMarkers.value(TickTime(pos), -1) >= 0 ? 1 : 0;
+        }
+        return found;
+    };
+    GenTime::setFps(pCore->getCurrentFps());
+}